@@ -0,0 +1,24 @@
+#include "benchmark.h"
+#include "test-levels.h"
+#include "world.h"
+
+BENCHMARK_CASE(avoidAtChokepoint, "avoid 500 players at a chokepoint")
+{
+    World world;
+    addChokepointCrowd(world);
+    world.players()._avoidance = true;
+
+    benchmark.run(600, [&world] () {
+        world.update(1.0f / 60.0f);
+    });
+}
+
+BENCHMARK_CASE(walkThroughChokepoint, "walk 500 players through a chokepoint without avoidance")
+{
+    World world;
+    addChokepointCrowd(world);
+
+    benchmark.run(600, [&world] () {
+        world.update(1.0f / 60.0f);
+    });
+}
@@ -0,0 +1,20 @@
+#include "benchmark.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Runs all benchmarks, or only the ones whose name contains the first argument
+int main(int argc, char* argv[])
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+
+    for (auto& benchmarkCase : Benchmark::Cases())
+    {
+        if (benchmarkCase.first.find(filter) == std::string::npos) continue;
+
+        Benchmark benchmark(benchmarkCase.first);
+        benchmarkCase.second(benchmark);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "benchmark.h"
+#include "bots.h"
+#include "test-levels.h"
+
+// Two teams of bots spread over an open level, most of them far from any enemy
+static void setUpBots(World& world, BotController& bots, int count)
+{
+    world.changeLevel(openLevel(512, 512));
+    world.players().setBots(&bots);
+
+    for (int i = 0; i < count; i++)
+    {
+        int x = world.random().range(0, 511), y = world.random().range(0, 511);
+        world.players().addPlayer(x, y, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+    }
+}
+
+static void runBots(Benchmark& benchmark, int budget)
+{
+    World world;
+    BotController bots(&world);
+    bots.scheduler().setBudget(budget);
+    setUpBots(world, bots, 2000);
+
+    benchmark.run(300, [&world] () {
+        world.update(1.0f / 30.0f);
+    });
+
+    auto& stats = bots.scheduler().total();
+    std::cout << "    " << stats.thinks << " thinks, " << stats.skipped << " skipped, "
+              << stats.late << " late, at most " << stats.maxLateness << " ticks" << std::endl;
+
+    auto& costs = bots.costs();
+    if (costs.thinks > 0)
+    {
+        std::cout << "    " << costs.perceive / costs.thinks << " us perceiving and " << costs.decide / costs.thinks
+                  << " us deciding per think, " << (costs.walks > 0 ? costs.paths / costs.walks : 0.0) << " us per path, "
+                  << costs.worstTick << " us in the worst tick" << std::endl;
+    }
+}
+
+BENCHMARK_CASE(updateTwoThousandBots, "update 2k bots")
+{
+    runBots(benchmark, 1 << 20);
+}
+
+BENCHMARK_CASE(updateTwoThousandBotsOnBudget, "update 2k bots, 64 thinks per tick")
+{
+    runBots(benchmark, BOT_TICK_BUDGET);
+}
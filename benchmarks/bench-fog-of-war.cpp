@@ -0,0 +1,47 @@
+#include "benchmark.h"
+#include "fog-of-war.h"
+#include "test-levels.h"
+#include "world.h"
+
+// Two teams of 32 walking across a level with a wall every 32 tiles, each with a gap
+static void setUpFog(World& world)
+{
+    world.changeLevel(makeLevel(256, 256, [] (const tPosition& position) {
+        return position.x % 32 == 16 && position.y % 64 > 8;
+    }));
+
+    for (int i = 0; i < 64; i++)
+    {
+        int x = world.random().range(0, 255), y = world.random().range(0, 255);
+        auto player = world.players().addPlayer(x, y, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+        world.players()._storage.setPath(player->slot(), { { world.random().range(0, 255), world.random().range(0, 255) } });
+    }
+}
+
+BENCHMARK_CASE(castAllViews, "cast the views of 64 players")
+{
+    World world;
+    setUpFog(world);
+    FogOfWar fog;
+
+    benchmark.run(200, [&world, &fog] () {
+        fog.invalidate();
+        fog.update(world.players()._storage, *world.level());
+    });
+}
+
+BENCHMARK_CASE(castMovedViews, "walk 64 players, casting who moved")
+{
+    World world;
+    setUpFog(world);
+    FogOfWar fog;
+    int casts = 0;
+
+    benchmark.run(600, [&world, &fog, &casts] () {
+        world.update(1.0f / 60.0f);
+        fog.update(world.players()._storage, *world.level());
+        casts += fog.lastCasts();
+        fog.takeDirty(Teams::CounterTerrorist);
+    });
+    std::cout << "    " << casts / 601.0f << " views cast per tick" << std::endl;
+}
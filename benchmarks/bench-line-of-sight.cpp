@@ -0,0 +1,59 @@
+#include "benchmark.h"
+#include "test-levels.h"
+#include "world.h"
+
+// Two teams of 1000 walking across a level with a wall every 32 tiles, each with a gap
+static void setUpWalls(World& world)
+{
+    world.changeLevel(makeLevel(256, 256, [] (const tPosition& position) {
+        return position.x % 32 == 16 && position.y % 64 > 8;
+    }, true));
+
+    for (int i = 0; i < 2000; i++)
+    {
+        int x = world.random().range(0, 255), y = world.random().range(0, 255);
+        auto player = world.players().addPlayer(x, y, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+        world.players()._storage.setPath(player->slot(), { { world.random().range(0, 255), world.random().range(0, 255) } });
+    }
+}
+
+static void printStats(World& world)
+{
+    auto& stats = world.players()._lineOfSight.lastUpdate();
+    std::cout << "    " << stats.moved << " moved, " << stats.pairs << " pairs, "
+              << stats.culled << " culled, " << stats.rays << " rays in the last update" << std::endl;
+}
+
+BENCHMARK_CASE(checkAllLinesOfSight, "check all lines of sight of 2k players")
+{
+    World world;
+    setUpWalls(world);
+
+    benchmark.run(50, [&world] () {
+        world.players()._lineOfSight.invalidate();
+        world.players().lineOfSight();
+    });
+    printStats(world);
+}
+
+BENCHMARK_CASE(walkWithLinesOfSight, "walk 2k players, checking who moved")
+{
+    World world;
+    setUpWalls(world);
+
+    benchmark.run(300, [&world] () {
+        world.update(1.0f / 60.0f);
+        world.players().lineOfSight();
+    });
+    printStats(world);
+}
+
+BENCHMARK_CASE(walkWithoutLinesOfSight, "walk 2k players without lines of sight")
+{
+    World world;
+    setUpWalls(world);
+
+    benchmark.run(300, [&world] () {
+        world.update(1.0f / 60.0f);
+    });
+}
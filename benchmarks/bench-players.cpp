@@ -0,0 +1,83 @@
+#include "benchmark.h"
+#include "players.h"
+#include "world.h"
+
+#include <random>
+
+static void addRandomPlayers(World& world, int count)
+{
+    std::default_random_engine generator(1);
+    std::uniform_int_distribution<int> location(0, 1023);
+
+    for (int i = 0; i < count; i++)
+    {
+        auto player = world.players().addPlayer(location(generator), location(generator),
+                                                  i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+
+        std::vector<tPosition> path;
+        for (int j = 0; j < 64; j++) path.push_back({ location(generator), location(generator) });
+        world.players()._storage.setPath(player->slot(), path);
+    }
+}
+
+BENCHMARK_CASE(updateTenThousandPlayers, "update 10k players")
+{
+    World world;
+    addRandomPlayers(world, 10000);
+
+    benchmark.run(1000, [&world] () {
+        world.update(1.0f / 60.0f);
+    });
+}
+
+BENCHMARK_CASE(moveHundredThousandPlayers, "move 100k players")
+{
+    World world;
+    addRandomPlayers(world, 100000);
+
+    benchmark.run(200, [&world] () {
+        world.update(1.0f / 60.0f);
+    });
+}
+
+BENCHMARK_CASE(updateBulletsAgainstPlayers, "update 20k bullets against 5k players")
+{
+    World world;
+    addRandomPlayers(world, 5000);
+
+    std::default_random_engine generator(2);
+    std::uniform_real_distribution<float> location(0.0f, 8192.0f), angle(0.0f, 6.28f);
+    for (int i = 0; i < 20000; i++)
+    {
+        float a = angle(generator);
+        world.players()._bullets.spawn(i % 5000, glm::vec3(location(generator), location(generator), 0.0f), glm::vec3(std::cos(a), std::sin(a), 0.0f));
+    }
+
+    // Keep the bullet count constant, bullets that hit are replaced
+    benchmark.run(200, [&world] () {
+        auto& bullets = world.players()._bullets;
+        while (bullets.size() < 20000) bullets.spawn(0, glm::vec3(4096.0f, 4096.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        world.update(1.0f / 60.0f);
+    });
+}
+
+BENCHMARK_CASE(updateTenThousandPlayersOnJobs, "update 10k players, 20k bullets on the job system")
+{
+    JobSystem jobs;
+    World world;
+    world.setJobSystem(&jobs);
+    addRandomPlayers(world, 10000);
+
+    for (int i = 0; i < 20000; i++)
+    {
+        float a = i * 0.001f;
+        world.players()._bullets.spawn(i % 10000, glm::vec3(4096.0f, 4096.0f, 0.0f), glm::vec3(std::cos(a), std::sin(a), 0.0f));
+    }
+
+    std::cout << "    " << jobs.threadCount() << " threads" << std::endl;
+    benchmark.run(200, [&world] () {
+        auto& bullets = world.players()._bullets;
+        while (bullets.size() < 20000) bullets.spawn(0, glm::vec3(4096.0f, 4096.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        world.update(1.0f / 60.0f);
+    });
+}
@@ -0,0 +1,34 @@
+#include "benchmark.h"
+#include "world.h"
+
+// Sleeps the given number of ticks over and over, never finishes
+static Script sleeper(World& world, unsigned int ticks)
+{
+    for (;;) co_await world.scripts().ticks(ticks);
+}
+
+// The world has no players, so its tick is all resuming scripts
+static void runSleepers(Benchmark& benchmark, int count, unsigned int longestSleep)
+{
+    World world;
+    for (int i = 0; i < count; i++) world.scripts().start(sleeper(world, 1 + i % longestSleep));
+
+    unsigned int resumed = world.scripts().resumed();
+    benchmark.run(1000, [&world] () {
+        world.update(1.0f / 30.0f);
+    });
+
+    auto& pool = world.scripts().pool();
+    std::cout << "    " << (world.scripts().resumed() - resumed) / 1001 << " resumed per tick, "
+              << pool.liveFrames() << " frames in " << pool.pageCount() << " pages" << std::endl;
+}
+
+BENCHMARK_CASE(resumeTenThousandScriptsEveryTick, "resume 10k scripts every tick")
+{
+    runSleepers(benchmark, 10000, 1);
+}
+
+BENCHMARK_CASE(sleepTenThousandScripts, "10k scripts sleeping up to 32 ticks")
+{
+    runSleepers(benchmark, 10000, 32);
+}
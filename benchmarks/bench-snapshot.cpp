@@ -0,0 +1,64 @@
+#include "benchmark.h"
+#include "test-levels.h"
+#include "world.h"
+#include "world-snapshot.h"
+
+#include <cmath>
+
+// A full 64 player match, with paths and bullets in the air
+static void setUpMatch(World& world)
+{
+    world.changeLevel(openLevel(128, 128));
+
+    for (int i = 0; i < 64; i++)
+    {
+        auto player = world.players().addPlayer(4 + (i % 8) * 15, 4 + (i / 8) * 15, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+
+        std::vector<tPosition> path;
+        for (int j = 0; j < 32; j++) path.push_back({ (i * 7 + j * 3) % 128, (i * 3 + j * 5) % 128 });
+        world.players()._storage.setPath(player->slot(), path);
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        float a = i * 0.1f;
+        world.players()._bullets.spawn(i % 64, glm::vec3(512.0f, 512.0f, 0.0f), glm::vec3(std::cos(a), std::sin(a), 0.0f));
+    }
+}
+
+BENCHMARK_CASE(snapshotSixtyFourPlayers, "snapshot 64 players, 256 bullets")
+{
+    World world;
+    setUpMatch(world);
+    WorldSnapshot snapshot;
+
+    benchmark.run(100000, [&] () {
+        snapshot.capture(world);
+    });
+    std::cout << "    " << snapshot.size() << " bytes" << std::endl;
+}
+
+BENCHMARK_CASE(restoreSixtyFourPlayers, "restore 64 players, 256 bullets")
+{
+    World world;
+    setUpMatch(world);
+    WorldSnapshot snapshot;
+    snapshot.capture(world);
+
+    benchmark.run(100000, [&] () {
+        snapshot.restore(world);
+    });
+}
+
+BENCHMARK_CASE(rollbackSixtyFourPlayers, "roll back and resimulate 8 ticks, 64 players")
+{
+    World world;
+    setUpMatch(world);
+    WorldSnapshot snapshot;
+    snapshot.capture(world);
+
+    benchmark.run(10000, [&] () {
+        snapshot.restore(world);
+        for (int i = 0; i < 8; i++) world.update(1.0f / 60.0f);
+    });
+}
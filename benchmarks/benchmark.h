@@ -0,0 +1,55 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal benchmark harness. Every BENCHMARK_CASE is registered before main runs,
+// bench-base.cpp runs them all and prints the average time of one iteration.
+class Benchmark
+{
+public:
+    Benchmark(const std::string& name) : _name(name) { }
+
+    void run(int iterations, std::function<void ()> iteration)
+    {
+        // One untimed iteration to warm up the caches
+        iteration();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) iteration();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double total = std::chrono::duration<double, std::micro>(end - start).count();
+        std::cout << std::left << std::setw(48) << this->_name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << (total / iterations) << " us/iteration"
+                  << " (" << iterations << " iterations)" << std::endl;
+    }
+
+    typedef void (*Case)(Benchmark&);
+
+    static std::vector<std::pair<std::string, Case> >& Cases()
+    {
+        static std::vector<std::pair<std::string, Case> > cases;
+        return cases;
+    }
+
+    struct Registration
+    {
+        Registration(const std::string& name, Case benchmark) { Benchmark::Cases().push_back(std::make_pair(name, benchmark)); }
+    };
+
+private:
+    std::string _name;
+};
+
+#define BENCHMARK_CASE(function, name) \
+    static void function(Benchmark& benchmark); \
+    static Benchmark::Registration function##Registration(name, function); \
+    static void function(Benchmark& benchmark)
+
+#endif // BENCHMARK_H
@@ -0,0 +1,197 @@
+#include "avoidance.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float epsilon = 0.00001f;
+
+static float det(const glm::vec2& a, const glm::vec2& b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+// Solves on the line: the point closest to the optimization velocity that satisfies the lines before it
+static bool linearProgram1(const AvoidanceLine* lines, int lineNo, float radius, const glm::vec2& optimization, bool directionOpt, glm::vec2& result)
+{
+    float dotProduct = glm::dot(lines[lineNo].point, lines[lineNo].direction);
+    float discriminant = dotProduct * dotProduct + radius * radius - glm::dot(lines[lineNo].point, lines[lineNo].point);
+
+    // The maximum speed circle fully invalidates this line
+    if (discriminant < 0.0f) return false;
+
+    float sqrtDiscriminant = std::sqrt(discriminant);
+    float tLeft = -dotProduct - sqrtDiscriminant;
+    float tRight = -dotProduct + sqrtDiscriminant;
+
+    for (int i = 0; i < lineNo; i++)
+    {
+        float denominator = det(lines[lineNo].direction, lines[i].direction);
+        float numerator = det(lines[i].direction, lines[lineNo].point - lines[i].point);
+
+        if (std::fabs(denominator) <= epsilon)
+        {
+            // The lines are parallel, either this one is on the wrong side or it does not limit anything
+            if (numerator < 0.0f) return false;
+            continue;
+        }
+
+        float t = numerator / denominator;
+        if (denominator >= 0.0f) tRight = std::min(tRight, t);
+        else tLeft = std::max(tLeft, t);
+
+        if (tLeft > tRight) return false;
+    }
+
+    if (directionOpt)
+    {
+        result = lines[lineNo].point + (glm::dot(optimization, lines[lineNo].direction) > 0.0f ? tRight : tLeft) * lines[lineNo].direction;
+    }
+    else
+    {
+        float t = glm::dot(lines[lineNo].direction, optimization - lines[lineNo].point);
+        result = lines[lineNo].point + std::min(std::max(t, tLeft), tRight) * lines[lineNo].direction;
+    }
+
+    return true;
+}
+
+// Returns the number of lines satisfied, lineCount when the result satisfies all of them
+static int linearProgram2(const AvoidanceLine* lines, int lineCount, float radius, const glm::vec2& optimization, bool directionOpt, glm::vec2& result)
+{
+    if (directionOpt) result = optimization * radius;
+    else if (glm::dot(optimization, optimization) > radius * radius) result = glm::normalize(optimization) * radius;
+    else result = optimization;
+
+    for (int i = 0; i < lineCount; i++)
+    {
+        if (det(lines[i].direction, lines[i].point - result) > 0.0f)
+        {
+            auto previous = result;
+            if (!linearProgram1(lines, i, radius, optimization, directionOpt, result))
+            {
+                result = previous;
+                return i;
+            }
+        }
+    }
+
+    return lineCount;
+}
+
+// The constraints cannot all be met, find the velocity that violates them the least
+static void linearProgram3(const AvoidanceLine* lines, int lineCount, int beginLine, float radius, glm::vec2& result)
+{
+    AvoidanceLine projected[AVOIDANCE_MAX_NEIGHBORS];
+    float distance = 0.0f;
+
+    for (int i = beginLine; i < lineCount; i++)
+    {
+        if (det(lines[i].direction, lines[i].point - result) <= distance) continue;
+
+        int projectedCount = 0;
+        for (int j = 0; j < i; j++)
+        {
+            AvoidanceLine line;
+            float determinant = det(lines[i].direction, lines[j].direction);
+
+            if (std::fabs(determinant) <= epsilon)
+            {
+                // Parallel lines pointing the same way do not constrain anything more
+                if (glm::dot(lines[i].direction, lines[j].direction) > 0.0f) continue;
+                line.point = 0.5f * (lines[i].point + lines[j].point);
+            }
+            else
+            {
+                line.point = lines[i].point + (det(lines[j].direction, lines[i].point - lines[j].point) / determinant) * lines[i].direction;
+            }
+
+            line.direction = glm::normalize(lines[j].direction - lines[i].direction);
+            projected[projectedCount++] = line;
+        }
+
+        auto previous = result;
+        glm::vec2 optimization(-lines[i].direction.y, lines[i].direction.x);
+        if (linearProgram2(projected, projectedCount, radius, optimization, true, result) < projectedCount)
+        {
+            // Only fails because of rounding, the result was already as good as it gets
+            result = previous;
+        }
+
+        distance = det(lines[i].direction, lines[i].point - result);
+    }
+}
+
+glm::vec2 obj_AvoidCollisions(const glm::vec2& position, const glm::vec2& velocity, const glm::vec2& preferred,
+                              const glm::vec2* neighborPositions, const glm::vec2* neighborVelocities, int neighborCount,
+                              float radius, float maxSpeed, float timeHorizon, float timeStep)
+{
+    AvoidanceLine lines[AVOIDANCE_MAX_NEIGHBORS];
+    int lineCount = std::min(neighborCount, AVOIDANCE_MAX_NEIGHBORS);
+    if (lineCount == 0) return preferred;
+
+    float invTimeHorizon = 1.0f / timeHorizon;
+    float combinedRadius = radius + radius;
+    float combinedRadiusSq = combinedRadius * combinedRadius;
+
+    for (int i = 0; i < lineCount; i++)
+    {
+        auto relativePosition = neighborPositions[i] - position;
+        auto relativeVelocity = velocity - neighborVelocities[i];
+        float distSq = glm::dot(relativePosition, relativePosition);
+
+        AvoidanceLine line;
+        glm::vec2 u;
+
+        if (distSq > combinedRadiusSq)
+        {
+            // No collision yet, the velocity obstacle is a cone cut off by a circle
+            auto w = relativeVelocity - invTimeHorizon * relativePosition;
+            float wLengthSq = glm::dot(w, w);
+            float dotProduct = glm::dot(w, relativePosition);
+
+            if (dotProduct < 0.0f && dotProduct * dotProduct > combinedRadiusSq * wLengthSq)
+            {
+                // Closest to the cut-off circle
+                float wLength = std::sqrt(wLengthSq);
+                auto unitW = w / wLength;
+                line.direction = glm::vec2(unitW.y, -unitW.x);
+                u = (combinedRadius * invTimeHorizon - wLength) * unitW;
+            }
+            else
+            {
+                // Closest to one of the legs of the cone
+                float leg = std::sqrt(distSq - combinedRadiusSq);
+                if (det(relativePosition, w) > 0.0f)
+                {
+                    line.direction = glm::vec2(relativePosition.x * leg - relativePosition.y * combinedRadius,
+                                               relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+                }
+                else
+                {
+                    line.direction = -glm::vec2(relativePosition.x * leg + relativePosition.y * combinedRadius,
+                                                -relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+                }
+                u = glm::dot(relativeVelocity, line.direction) * line.direction - relativeVelocity;
+            }
+        }
+        else
+        {
+            // Already overlapping, get apart within this time step
+            float invTimeStep = 1.0f / timeStep;
+            auto w = relativeVelocity - invTimeStep * relativePosition;
+            float wLength = glm::length(w);
+            auto unitW = wLength > epsilon ? w / wLength : glm::vec2(0.0f, 1.0f);
+            line.direction = glm::vec2(unitW.y, -unitW.x);
+            u = (combinedRadius * invTimeStep - wLength) * unitW;
+        }
+
+        line.point = velocity + 0.5f * u;
+        lines[i] = line;
+    }
+
+    glm::vec2 result;
+    int satisfied = linearProgram2(lines, lineCount, maxSpeed, preferred, false, result);
+    if (satisfied < lineCount) linearProgram3(lines, lineCount, satisfied, maxSpeed, result);
+
+    return result;
+}
@@ -0,0 +1,26 @@
+#ifndef AVOIDANCE_H
+#define AVOIDANCE_H
+
+#include <glm/glm.hpp>
+
+// Neighbours taken into account by one player, the nearest ones win
+#define AVOIDANCE_MAX_NEIGHBORS 8
+
+// Seconds ahead collisions with other players are avoided
+#define AVOIDANCE_TIME_HORIZON 1.0f
+
+typedef struct sAvoidanceLine
+{
+    glm::vec2 point;
+    glm::vec2 direction;
+} AvoidanceLine;
+
+// Optimal reciprocal collision avoidance (van den Berg et al.). Returns the velocity closest to the
+// preferred one that keeps the agent from colliding with any of its neighbours within the time
+// horizon, assuming the neighbours take half of the effort. Velocities are in units per second, the
+// time step in seconds. At most AVOIDANCE_MAX_NEIGHBORS neighbours are used, nothing is allocated.
+glm::vec2 obj_AvoidCollisions(const glm::vec2& position, const glm::vec2& velocity, const glm::vec2& preferred,
+                              const glm::vec2* neighborPositions, const glm::vec2* neighborVelocities, int neighborCount,
+                              float radius, float maxSpeed, float timeHorizon, float timeStep);
+
+#endif // AVOIDANCE_H
@@ -0,0 +1,148 @@
+#include "bot-scheduler.h"
+
+#include <algorithm>
+
+BotScheduler::BotScheduler(int budget) : _budget(std::max(budget, 1))
+{
+    this->reset();
+}
+
+BotScheduler::~BotScheduler() { }
+
+void BotScheduler::schedule(unsigned int tick, const std::vector<PlayerHandle>& bots, std::vector<PlayerHandle>& due)
+{
+    due.clear();
+    this->_overdue.clear();
+
+    for (int i = 0; i < int(bots.size()); i++)
+    {
+        if (bots[i] >= int(this->_nextTick.size())) this->add(bots[i], tick);
+        if (this->_nextTick[bots[i]] <= tick) this->_overdue.push_back(std::make_pair(tick - this->_nextTick[bots[i]], i));
+    }
+
+    // Over budget the most overdue bots go first, then the more relevant ones, the others wait for the next tick
+    if (int(this->_overdue.size()) > this->_budget)
+    {
+        std::sort(this->_overdue.begin(), this->_overdue.end(), [this, &bots] (const std::pair<unsigned int, int>& a, const std::pair<unsigned int, int>& b) {
+            if (a.first != b.first) return a.first > b.first;
+            if (this->_details[bots[a.second]] != this->_details[bots[b.second]]) return this->_details[bots[a.second]] < this->_details[bots[b.second]];
+            return a.second < b.second;
+        });
+    }
+
+    int thinks = std::min(int(this->_overdue.size()), this->_budget);
+    std::sort(this->_overdue.begin(), this->_overdue.begin() + thinks, [] (const std::pair<unsigned int, int>& a, const std::pair<unsigned int, int>& b) {
+        return a.second < b.second;
+    });
+
+    BotSchedulerStats stats = { (unsigned int)thinks, (unsigned int)(bots.size() - this->_overdue.size()), (unsigned int)(this->_overdue.size() - thinks), 0 };
+    for (int i = 0; i < thinks; i++)
+    {
+        due.push_back(bots[this->_overdue[i].second]);
+        stats.maxLateness = std::max(stats.maxLateness, this->_overdue[i].first);
+    }
+
+    this->_lastTick = stats;
+    this->_total.thinks += stats.thinks;
+    this->_total.skipped += stats.skipped;
+    this->_total.late += stats.late;
+    this->_total.maxLateness = std::max(this->_total.maxLateness, stats.maxLateness);
+}
+
+void BotScheduler::thought(PlayerHandle bot, BotDetails details, unsigned int tick)
+{
+    if (bot >= int(this->_nextTick.size())) this->add(bot, tick);
+
+    this->_details[bot] = details;
+    this->_nextTick[bot] = tick + BotScheduler::interval(details);
+}
+
+void BotScheduler::wake(PlayerHandle bot, BotDetails details, unsigned int tick)
+{
+    if (bot >= int(this->_nextTick.size())) this->add(bot, tick);
+
+    this->_details[bot] = std::min(this->_details[bot], details);
+    this->_nextTick[bot] = std::min(this->_nextTick[bot], tick);
+}
+
+void BotScheduler::defer(PlayerHandle bot, unsigned int tick)
+{
+    if (bot >= int(this->_nextTick.size())) this->add(bot, tick);
+
+    this->_nextTick[bot] = tick;
+    this->_lastTick.late++;
+    this->_total.late++;
+}
+
+BotDetails BotScheduler::details(PlayerHandle bot) const
+{
+    if (bot < 0 || bot >= int(this->_details.size())) return BotDetails::Alert;
+
+    return this->_details[bot];
+}
+
+unsigned int BotScheduler::interval(BotDetails details)
+{
+    switch (details)
+    {
+    case BotDetails::Combat: return BOT_COMBAT_INTERVAL;
+    case BotDetails::Alert: return BOT_ALERT_INTERVAL;
+    default: return BOT_IDLE_INTERVAL;
+    }
+}
+
+int BotScheduler::budget() const
+{
+    return this->_budget;
+}
+
+void BotScheduler::setBudget(int budget)
+{
+    this->_budget = std::max(budget, 1);
+}
+
+const BotSchedulerStats& BotScheduler::lastTick() const
+{
+    return this->_lastTick;
+}
+
+const BotSchedulerStats& BotScheduler::total() const
+{
+    return this->_total;
+}
+
+void BotScheduler::reset()
+{
+    this->_details.clear();
+    this->_nextTick.clear();
+
+    BotSchedulerStats empty = { 0, 0, 0, 0 };
+    this->_lastTick = this->_total = empty;
+}
+
+void BotScheduler::writeState(StateWriter& writer) const
+{
+    writer.writeArray(this->_details);
+    writer.writeArray(this->_nextTick);
+}
+
+bool BotScheduler::readState(StateReader& reader)
+{
+    if (!reader.readArray(this->_details) || !reader.readArray(this->_nextTick) || this->_details.size() != this->_nextTick.size())
+    {
+        this->reset();
+        return false;
+    }
+
+    return true;
+}
+
+// New bots start alert, spread over the ticks of that level so they do not all think at once
+void BotScheduler::add(PlayerHandle bot, unsigned int tick)
+{
+    while (int(this->_nextTick.size()) <= bot)
+    {
+        this->_details.push_back(BotDetails::Alert);
+        this->_nextTick.push_back(tick + (unsigned int)(this->_nextTick.size()) % BOT_ALERT_INTERVAL);
+    }
+}
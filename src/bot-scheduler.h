@@ -0,0 +1,87 @@
+#ifndef BOT_SCHEDULER_H
+#define BOT_SCHEDULER_H
+
+#include <vector>
+
+#include "player-storage.h"
+#include "state-buffer.h"
+
+// How much a bot matters right now, from most to least
+enum class BotDetails
+{
+    Combat,
+    Alert,
+    Idle
+};
+
+// Ticks between two thinks of a bot at every level of detail
+#define BOT_COMBAT_INTERVAL 1
+#define BOT_ALERT_INTERVAL 4
+#define BOT_IDLE_INTERVAL 16
+
+// Bots thinking in one tick at most, and how many of them may search a path
+#define BOT_TICK_BUDGET 64
+#define BOT_PATH_BUDGET 4
+
+typedef struct sBotSchedulerStats
+{
+    unsigned int thinks;        // Bots that thought
+    unsigned int skipped;       // Bots that were not due yet
+    unsigned int late;          // Bots that were due but did not fit in the budget
+    unsigned int maxLateness;   // Ticks the latest bot that thought was behind
+} BotSchedulerStats;
+
+// Decides which bots think in a tick. Every bot has a level of detail that says how often it
+// thinks, new bots are spread over the ticks by their handle. At most budget bots think in one
+// tick, the ones that are most overdue first. The budget counts bots instead of time, so a
+// match schedules the same bots on every machine.
+class BotScheduler
+{
+public:
+    BotScheduler(int budget = BOT_TICK_BUDGET);
+    virtual ~BotScheduler();
+
+    // Fills due with the bots that think in this tick, in the order they are given in
+    void schedule(unsigned int tick, const std::vector<PlayerHandle>& bots, std::vector<PlayerHandle>& due);
+
+    // The bot thought in this tick and decided how much it matters until it thinks again
+    void thought(PlayerHandle bot, BotDetails details, unsigned int tick);
+
+    // Lets the bot think as soon as the budget allows, for example when it was hit
+    void wake(PlayerHandle bot, BotDetails details, unsigned int tick);
+
+    // The bot thought in this tick but could not do all it wanted, it goes first in the next tick and counts as late
+    void defer(PlayerHandle bot, unsigned int tick);
+
+    BotDetails details(PlayerHandle bot) const;
+    static unsigned int interval(BotDetails details);
+
+    int budget() const;
+    void setBudget(int budget);
+
+    // What happened in the last scheduled tick, and in all ticks since the last reset
+    const BotSchedulerStats& lastTick() const;
+    const BotSchedulerStats& total() const;
+
+    void reset();
+
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
+private:
+    int _budget;
+
+    // Indexed by handle
+    std::vector<BotDetails> _details;
+    std::vector<unsigned int> _nextTick;
+
+    // Overdue bots when there are more than the budget, as lateness and position in the bots given
+    std::vector<std::pair<unsigned int, int> > _overdue;
+
+    BotSchedulerStats _lastTick;
+    BotSchedulerStats _total;
+
+    void add(PlayerHandle bot, unsigned int tick);
+};
+
+#endif // BOT_SCHEDULER_H
@@ -0,0 +1,406 @@
+#include "bots.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static float playerScale = LEVEL_TILE_WORLD_SIZE;
+
+static double microsecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static float clampUtility(float utility)
+{
+    return std::min(std::max(utility, 0.0f), 1.0f);
+}
+
+// Appends the victims of the hits after the cursor and moves the cursor past them.
+// Returns how many events were lost, the victims of those are not known.
+static int drainHits(const GameEventQueue& queue, GameEventCursor& cursor, std::vector<GameEvent>& events, std::vector<PlayerHandle>& victims)
+{
+    events.clear();
+    int lost = queue.drain(cursor, events);
+    for (auto& event : events)
+    {
+        if (event.type == GameEventTypes::PlayerHit) victims.push_back(event.other);
+    }
+
+    return lost;
+}
+
+void BotPerception::resize(int count)
+{
+    tPosition none = { -1, -1 };
+
+    this->_slot.resize(count);
+    this->_enemy.assign(count, -1);
+    this->_enemyDistance.assign(count, 0.0f);
+    this->_visibleEnemies.assign(count, 0);
+    this->_nearby.assign(count, 0);
+    this->_cover.assign(count, none);
+    this->_coverDistance.assign(count, -1.0f);
+    this->_health.resize(count);
+}
+
+BotController::BotController(World* world) : _world(world), _cursor(world->events().end()), _lostHits(0)
+{
+    BotCosts empty = { 0.0, 0.0, 0.0, 0.0, 0, 0 };
+    this->_costs = empty;
+}
+
+BotController::~BotController() { }
+
+void BotController::update(float diff)
+{
+    auto& players = this->_world->players();
+    auto jobs = this->_world->jobs();
+    auto tick = this->_world->tick();
+    auto start = std::chrono::steady_clock::now();
+
+    // Cooldowns are indexed by handle, so they follow the players when slots change
+    for (auto& cooldown : this->_cooldowns) cooldown -= diff;
+
+    this->_bots.clear();
+    for (auto player : players._players)
+    {
+        if (player->health() > 0.0f && player != players._selectedPlayer) this->_bots.push_back(player->handle());
+    }
+
+    // Bots that were hit since the last tick are in combat whether they saw it coming or not.
+    // When the controller fell so far behind that hits were lost, every bot might have been hit.
+    this->_lostHits += drainHits(this->_world->events(), this->_cursor, this->_events, this->_hits);
+    if (this->_lostHits > 0) this->_hits = this->_bots;
+    for (auto handle : this->_hits)
+    {
+        auto victim = players.player(handle);
+        if (victim != nullptr && victim->health() > 0.0f && victim != players._selectedPlayer) this->_scheduler.wake(handle, BotDetails::Combat, tick);
+    }
+    this->_hits.clear();
+    this->_lostHits = 0;
+    this->_scheduler.schedule(tick, this->_bots, this->_due);
+
+    // Perceiving only reads the world, so all bots do it at the same time
+    players.lineOfSight();
+    this->_perception.resize(int(this->_due.size()));
+    for (int i = 0; i < int(this->_due.size()); i++) this->_perception._slot[i] = players.player(this->_due[i])->slot();
+    obj_ParallelFor(jobs, 0, int(this->_due.size()), BOT_LOOK_GRAIN, [this] (int from, int to) {
+        for (int i = from; i < to; i++) this->perceive(i);
+    });
+    auto perceived = std::chrono::steady_clock::now();
+
+    // Every bot does what it wants to do most, the first action wins a tie
+    this->_walks.clear();
+    for (int i = 0; i < int(this->_due.size()); i++)
+    {
+        auto best = BotActions::MoveToSite;
+        float bestUtility = -1.0f;
+        for (int action = 0; action < BOT_ACTION_COUNT; action++)
+        {
+            float utility = BotController::utility(BotActions(action), this->_perception, i);
+            if (utility <= bestUtility) continue;
+
+            best = BotActions(action);
+            bestUtility = utility;
+        }
+
+        this->act(i, best);
+    }
+    auto decided = std::chrono::steady_clock::now();
+
+    // Searching paths is the expensive part, every walk gets its own job
+    auto level = this->_world->level();
+    obj_ParallelFor(jobs, 0, int(this->_walks.size()), 1, [this, level] (int from, int to) {
+        for (int i = from; i < to; i++)
+        {
+            auto& walk = this->_walks[i];
+            auto path = obj_GetAStarPath(walk.from, walk.to, [level] (const tPosition& position) {
+                return level->isWalkable(position.x, position.y);
+            });
+            for (; !path.empty(); path.pop()) walk.waypoints.push_back(path.front());
+        }
+    });
+
+    // A bot that cannot reach its tile picks another one when it thinks again
+    for (auto& walk : this->_walks)
+    {
+        if (!walk.waypoints.empty()) players.walkAlong(players._players[walk.slot], walk.waypoints);
+    }
+
+    this->_costs.perceive += std::chrono::duration<double, std::micro>(perceived - start).count();
+    this->_costs.decide += std::chrono::duration<double, std::micro>(decided - perceived).count();
+    this->_costs.paths += microsecondsSince(decided);
+    this->_costs.worstTick = std::max(this->_costs.worstTick, microsecondsSince(start));
+    this->_costs.thinks += (unsigned int)this->_due.size();
+    this->_costs.walks += (unsigned int)this->_walks.size();
+}
+
+BotScheduler& BotController::scheduler()
+{
+    return this->_scheduler;
+}
+
+const BotCosts& BotController::costs() const
+{
+    return this->_costs;
+}
+
+BotActions BotController::action(PlayerHandle bot) const
+{
+    if (bot < 0 || bot >= int(this->_actions.size())) return BotActions::MoveToSite;
+
+    return this->_actions[bot];
+}
+
+float BotController::utility(BotActions action, const BotPerception& perception, int i)
+{
+    float health = perception._health[i];
+    bool seen = perception._enemy[i] >= 0;
+    int outnumbered = std::max(perception._visibleEnemies[i] - 1, 0);
+
+    switch (action)
+    {
+    case BotActions::MoveToSite:
+        // Something to do when there is nothing to fight, slower when enemies are close
+        return seen ? 0.0f : (perception._nearby[i] ? 0.3f : 0.5f);
+
+    case BotActions::Engage:
+    {
+        if (!seen) return 0.0f;
+        float closeness = 1.0f - perception._enemyDistance[i] / BOT_VIEW_DISTANCE;
+        return clampUtility(0.4f + 0.4f * health + 0.2f * closeness - 0.1f * outnumbered);
+    }
+
+    case BotActions::Retreat:
+        if (!seen) return 0.0f;
+        return clampUtility(0.8f * (1.0f - health) + 0.1f * outnumbered - (perception._coverDistance[i] >= 0.0f ? 0.2f : 0.0f));
+
+    case BotActions::TakeCover:
+    {
+        if (!seen || perception._coverDistance[i] < 0.0f) return 0.0f;
+        float closeness = 1.0f - perception._coverDistance[i] / BOT_COVER_DISTANCE;
+        return clampUtility(0.7f * (1.0f - health) + 0.15f * std::min(outnumbered, 2) + 0.2f * closeness);
+    }
+    }
+
+    return 0.0f;
+}
+
+// Events are not part of the world state, the hits the bots did not see yet go with it
+void BotController::writeState(StateWriter& writer) const
+{
+    auto cursor = this->_cursor;
+    std::vector<GameEvent> events;
+    auto hits = this->_hits;
+    int lost = this->_lostHits + drainHits(this->_world->events(), cursor, events, hits);
+
+    writer.writeArray(this->_cooldowns);
+    writer.writeArray(this->_actions);
+    writer.writeArray(hits);
+    writer.writeVarint(lost);
+    this->_scheduler.writeState(writer);
+}
+
+bool BotController::readState(StateReader& reader)
+{
+    this->_cursor = this->_world->events().end();
+    bool valid = reader.readArray(this->_cooldowns) && reader.readArray(this->_actions) && reader.readArray(this->_hits);
+    this->_lostHits = int(reader.readVarint());
+
+    return valid && this->_scheduler.readState(reader);
+}
+
+// Finds the nearest enemy in sight, counts the ones in sight and looks for cover from the nearest.
+// Reads the players arrays and their lines of sight directly, looking at most at BOT_SIGHT_CHECKS enemies.
+void BotController::perceive(int i)
+{
+    auto& players = this->_world->players();
+    auto& storage = players._storage;
+    auto& perception = this->_perception;
+
+    int slot = perception._slot[i];
+    float x = storage._posX[slot], y = storage._posY[slot];
+    auto team = storage._team[slot];
+    tPosition from = { int(x / playerScale), int(y / playerScale) };
+    perception._health[i] = storage._health[slot];
+
+    // The enemies in view distance, nearest first
+    std::pair<float, int> enemies[BOT_SIGHT_CHECKS];
+    int count = 0;
+    float range = BOT_VIEW_DISTANCE * playerScale;
+    players._playerGrid.visit(x, y, range, [&] (int other) {
+        if (storage._team[other] == team || storage._health[other] <= 0.0f) return true;
+
+        float dx = storage._posX[other] - x, dy = storage._posY[other] - y;
+        auto enemy = std::make_pair(dx * dx + dy * dy, other);
+        if (enemy.first > range * range) return true;
+        perception._nearby[i] = 1;
+
+        if (count == BOT_SIGHT_CHECKS && !(enemy < enemies[count - 1])) return true;
+        int at = count < BOT_SIGHT_CHECKS ? count++ : count - 1;
+        for (; at > 0 && enemy < enemies[at - 1]; at--) enemies[at] = enemies[at - 1];
+        enemies[at] = enemy;
+        return true;
+    });
+
+    tPosition nearest = from;
+    for (int e = 0; e < count; e++)
+    {
+        int other = enemies[e].second;
+        tPosition to = { int(storage._posX[other] / playerScale), int(storage._posY[other] / playerScale) };
+        if (!players._lineOfSight.canSee(slot, other)) continue;
+
+        if (perception._enemy[i] < 0)
+        {
+            perception._enemy[i] = other;
+            perception._enemyDistance[i] = std::sqrt(enemies[e].first) / playerScale;
+            nearest = to;
+        }
+        perception._visibleEnemies[i]++;
+    }
+
+    if (perception._enemy[i] >= 0) this->findCover(i, from, nearest);
+}
+
+// The nearest tile next to a wall within BOT_COVER_DISTANCE that the enemy cannot see,
+// casting at most BOT_COVER_CHECKS lines of sight
+void BotController::findCover(int i, const tPosition& from, const tPosition& enemy)
+{
+    auto level = this->_world->level();
+    auto& perception = this->_perception;
+
+    int checks = 0;
+    for (int ring = 1; ring <= BOT_COVER_DISTANCE && checks < BOT_COVER_CHECKS; ring++)
+    {
+        float best = -1.0f;
+        for (int dy = -ring; dy <= ring; dy++)
+        {
+            for (int dx = -ring; dx <= ring; dx++)
+            {
+                if (std::max(std::abs(dx), std::abs(dy)) != ring) continue;
+
+                tPosition tile = { from.x + dx, from.y + dy };
+                if (!level->isWalkable(tile.x, tile.y) || level->wallDistance(tile.x, tile.y) > 1.0f) continue;
+
+                float distance = std::sqrt(float(dx * dx + dy * dy));
+                if (best >= 0.0f && distance >= best) continue;
+                if (checks++ == BOT_COVER_CHECKS) return;
+                if (level->canSee(enemy, tile)) continue;
+
+                best = distance;
+                perception._cover[i] = tile;
+                perception._coverDistance[i] = distance;
+            }
+        }
+
+        if (best >= 0.0f) return;
+    }
+}
+
+void BotController::act(int i, BotActions action)
+{
+    auto& players = this->_world->players();
+    auto& perception = this->_perception;
+    auto player = players._players[perception._slot[i]];
+    auto handle = player->handle();
+    auto tick = this->_world->tick();
+
+    while (int(this->_cooldowns.size()) <= handle) this->_cooldowns.push_back(0.0f);
+    while (int(this->_actions.size()) <= handle) this->_actions.push_back(BotActions::MoveToSite);
+    auto previous = this->_actions[handle];
+    this->_actions[handle] = action;
+
+    if (perception._enemy[i] >= 0) this->_scheduler.thought(handle, BotDetails::Combat, tick);
+    else this->_scheduler.thought(handle, perception._nearby[i] ? BotDetails::Alert : BotDetails::Idle, tick);
+
+    // Engaging and taking cover both shoot back
+    if ((action == BotActions::Engage || action == BotActions::TakeCover) && this->_cooldowns[handle] <= 0.0f)
+    {
+        players.shootAt(player, players._players[perception._enemy[i]]->pos());
+        this->_cooldowns[handle] = BOT_SHOOT_INTERVAL;
+    }
+
+    auto pos = player->pos();
+    tPosition from = { int(pos.x / playerScale), int(pos.y / playerScale) };
+    tPosition to = from;
+    int spread = 0;
+    switch (action)
+    {
+    case BotActions::Engage:
+        return;
+
+    case BotActions::TakeCover:
+        if (previous == action && player->hasPath()) return;
+        to = perception._cover[i];
+        break;
+
+    case BotActions::Retreat:
+    {
+        if (previous == action && player->hasPath()) return;
+        auto enemy = players._players[perception._enemy[i]]->pos();
+        auto away = glm::vec2(pos.x - enemy.x, pos.y - enemy.y);
+        if (glm::length(away) > 0.001f) away = glm::normalize(away) * float(BOT_RETREAT_DISTANCE);
+        to = { from.x + int(away.x), from.y + int(away.y) };
+        spread = BOT_SITE_SPREAD;
+        break;
+    }
+
+    case BotActions::MoveToSite:
+    {
+        if (player->hasPath()) return;
+
+        // The spawns of both teams are the sites, bots go from one to another and wander when the level has none
+        std::vector<tPosition> sites;
+        for (auto& spawn : this->_world->level()->_spawns)
+        {
+            if (std::abs(spawn.position.x - from.x) + std::abs(spawn.position.y - from.y) > 2 * BOT_SITE_SPREAD) sites.push_back(spawn.position);
+        }
+
+        // Half of the time a bot looks around on its way, so not every round is played the same
+        if (sites.empty() || this->_world->random().range(0, 1) == 0)
+        {
+            spread = BOT_WANDER_DISTANCE;
+        }
+        else
+        {
+            to = sites[this->_world->random().range(0, int(sites.size()) - 1)];
+            spread = BOT_SITE_SPREAD;
+        }
+        break;
+    }
+    }
+
+    // Path searches cost the most, the bots over the budget walk off a tick later
+    if (int(this->_walks.size()) >= BOT_PATH_BUDGET)
+    {
+        this->_scheduler.defer(handle, tick);
+        return;
+    }
+
+    BotWalk walk;
+    if (this->pickWalk(player->slot(), to, spread, walk)) this->_walks.push_back(walk);
+}
+
+// A walkable tile up to spread tiles around the given one
+bool BotController::pickWalk(int slot, const tPosition& to, int spread, BotWalk& walk)
+{
+    auto level = this->_world->level();
+    auto& storage = this->_world->players()._storage;
+    tPosition from = { int(storage._posX[slot] / playerScale), int(storage._posY[slot] / playerScale) };
+
+    auto& random = this->_world->random();
+    for (int attempt = 0; attempt < 8; attempt++)
+    {
+        tPosition target = to;
+        if (spread > 0) target = { to.x + random.range(-spread, spread), to.y + random.range(-spread, spread) };
+        if (!level->isWalkable(target.x, target.y)) continue;
+
+        walk.slot = slot;
+        walk.from = from;
+        walk.to = target;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,136 @@
+#ifndef BOTS_H
+#define BOTS_H
+
+#include <vector>
+
+#include "bot-scheduler.h"
+#include "world.h"
+
+// Seconds between two shots of the same bot
+#define BOT_SHOOT_INTERVAL 0.5f
+
+// Tiles a bot looks around for enemies, and walks at most to find them. Enemies
+// farther than LINE_OF_SIGHT_DISTANCE are never in sight.
+#define BOT_VIEW_DISTANCE 24
+#define BOT_WANDER_DISTANCE 32
+
+// Tiles a bot looks around for cover, walks away when retreating and spreads out around a site
+#define BOT_COVER_DISTANCE 6
+#define BOT_RETREAT_DISTANCE 10
+#define BOT_SITE_SPREAD 4
+
+// Nearest enemies one bot looks at and lines of sight it casts for cover at most.
+// They bound what perception costs per bot, no matter how crowded it gets.
+#define BOT_SIGHT_CHECKS 8
+#define BOT_COVER_CHECKS 24
+
+// Bots looking around in one job
+#define BOT_LOOK_GRAIN 64
+
+// What a bot can decide to do when it thinks
+enum class BotActions
+{
+    MoveToSite,
+    Engage,
+    Retreat,
+    TakeCover
+};
+
+#define BOT_ACTION_COUNT 4
+
+// What the bots thinking in this tick perceived, one entry per bot. Filled for all of them at once.
+class BotPerception
+{
+public:
+    void resize(int count);
+
+    std::vector<int> _slot;
+    std::vector<int> _enemy;            // Slot of the nearest visible enemy, -1 without one
+    std::vector<float> _enemyDistance;  // In tiles
+    std::vector<int> _visibleEnemies;
+    std::vector<char> _nearby;          // Any enemy in view distance, seen or not
+    std::vector<tPosition> _cover;      // Nearest tile next to a wall the nearest enemy cannot see
+    std::vector<float> _coverDistance;  // In tiles, negative without cover
+    std::vector<float> _health;
+};
+
+// A walk a bot decided on, the path is searched afterwards
+typedef struct sBotWalk
+{
+    int slot;
+    tPosition from;
+    tPosition to;
+    std::vector<tPosition> waypoints;
+} BotWalk;
+
+// Time spent thinking since the controller was created, in microseconds
+typedef struct sBotCosts
+{
+    double perceive;
+    double decide;
+    double paths;
+    double worstTick;
+    unsigned int thinks;
+    unsigned int walks;
+} BotCosts;
+
+// Scripted players, every living player except the selected one is a bot. Bots do not think
+// every tick, the scheduler picks the ones that are due: bots in combat think every tick, bots
+// with enemies nearby now and then and the others rarely.
+//
+// Thinking bots first perceive the world all at once on the job system. Then every bot scores
+// each action with a utility between 0 and 1 and does the best one, in slot order on the updating
+// thread. Orders go through the same PlayerManager calls user input does. All randomness comes
+// from the world, paths are searched on the job system afterwards.
+class BotController
+{
+public:
+    BotController(World* world);
+    virtual ~BotController();
+
+    // Gives the bots that are due their orders, call once before every tick of the world
+    // or let PlayerManager::update call it with PlayerManager::setBots
+    void update(float diff);
+
+    BotScheduler& scheduler();
+    const BotCosts& costs() const;
+
+    // The action the bot picked when it last thought
+    BotActions action(PlayerHandle bot) const;
+
+    // How much the bot at the given entry of the perception wants to do the action
+    static float utility(BotActions action, const BotPerception& perception, int i);
+
+    // Cooldowns, actions, the schedule and the bots hit since the last update, the bots themselves
+    // are players in the world state
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
+private:
+    World* _world;
+    BotScheduler _scheduler;
+    BotCosts _costs;
+
+    // Hits are read from the world events, the victims wake up in combat
+    GameEventCursor _cursor;
+    std::vector<GameEvent> _events;
+    std::vector<PlayerHandle> _hits;
+    int _lostHits;
+
+    // Indexed by handle
+    std::vector<float> _cooldowns;
+    std::vector<BotActions> _actions;
+
+    // The bots alive and the ones thinking in this tick
+    std::vector<PlayerHandle> _bots;
+    std::vector<PlayerHandle> _due;
+    BotPerception _perception;
+    std::vector<BotWalk> _walks;
+
+    void perceive(int i);
+    void findCover(int i, const tPosition& from, const tPosition& enemy);
+    void act(int i, BotActions action);
+    bool pickWalk(int slot, const tPosition& to, int spread, BotWalk& walk);
+};
+
+#endif // BOTS_H
@@ -0,0 +1,121 @@
+#include "bullet-pool.h"
+
+#include <algorithm>
+
+Bullet::Bullet() : _gunner(INVALID_PLAYER_HANDLE), _pos(0.0f), _prevPos(0.0f), _dir(0.0f), _weight(0.2f) { }
+
+Bullet::Bullet(PlayerHandle gunner, const glm::vec3& pos, const glm::vec3& dir) : _gunner(gunner), _pos(pos), _prevPos(pos), _dir(dir), _weight(0.2f) { }
+
+BulletPool::BulletPool(int capacity) : _size(0), _highWaterMark(0), _growCount(0)
+{
+    this->_bullets.resize(std::max(capacity, 1));
+}
+
+BulletPool::~BulletPool() { }
+
+Bullet* BulletPool::spawn(PlayerHandle gunner, const glm::vec3& pos, const glm::vec3& dir)
+{
+    if (this->_size == this->capacity())
+    {
+        this->_bullets.resize(this->capacity() * 2);
+        this->_growCount++;
+    }
+
+    auto bullet = &this->_bullets[this->_size++];
+    *bullet = Bullet(gunner, pos, dir);
+    this->_highWaterMark = std::max(this->_highWaterMark, this->_size);
+
+    return bullet;
+}
+
+void BulletPool::kill(int index)
+{
+    if (index < 0 || index >= this->_size) return;
+
+    this->_size--;
+    if (index != this->_size) this->_bullets[index] = this->_bullets[this->_size];
+}
+
+void BulletPool::clear()
+{
+    this->_size = 0;
+}
+
+int BulletPool::size() const
+{
+    return this->_size;
+}
+
+int BulletPool::capacity() const
+{
+    return int(this->_bullets.size());
+}
+
+void BulletPool::reserve(int capacity)
+{
+    if (capacity > this->capacity()) this->_bullets.resize(capacity);
+}
+
+int BulletPool::highWaterMark() const
+{
+    return this->_highWaterMark;
+}
+
+int BulletPool::growCount() const
+{
+    return this->_growCount;
+}
+
+void BulletPool::resetStats()
+{
+    this->_highWaterMark = this->_size;
+    this->_growCount = 0;
+}
+
+Bullet& BulletPool::operator [] (int index)
+{
+    return this->_bullets[index];
+}
+
+const Bullet& BulletPool::operator [] (int index) const
+{
+    return this->_bullets[index];
+}
+
+Bullet* BulletPool::begin()
+{
+    return this->_bullets.data();
+}
+
+Bullet* BulletPool::end()
+{
+    return this->_bullets.data() + this->_size;
+}
+
+const Bullet* BulletPool::begin() const
+{
+    return this->_bullets.data();
+}
+
+const Bullet* BulletPool::end() const
+{
+    return this->_bullets.data() + this->_size;
+}
+
+void BulletPool::writeState(StateWriter& writer) const
+{
+    writer.writeVarint(this->_size);
+    if (this->_size > 0) writer.writeBytes(this->_bullets.data(), this->_size * sizeof(Bullet));
+}
+
+bool BulletPool::readState(StateReader& reader)
+{
+    auto size = reader.readVarint();
+    if (reader.failed() || size > reader.remaining() / sizeof(Bullet)) return false;
+
+    this->reserve(int(size));
+    this->_size = int(size);
+    this->_highWaterMark = std::max(this->_highWaterMark, this->_size);
+
+    return size == 0 || reader.readBytes(this->_bullets.data(), this->_size * sizeof(Bullet));
+}
@@ -0,0 +1,68 @@
+#ifndef BULLET_POOL_H
+#define BULLET_POOL_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "player-storage.h"
+
+#define BULLET_POOL_CAPACITY 256
+
+class Bullet
+{
+public:
+    Bullet();
+    Bullet(PlayerHandle gunner, const glm::vec3& pos, const glm::vec3& dir);
+
+    PlayerHandle _gunner;
+    glm::vec3 _pos;
+    glm::vec3 _prevPos;
+    glm::vec3 _dir;
+    float _weight;
+};
+
+// Densely packed pool of live bullets. Spawning appends behind the last live
+// bullet and killing moves the last live bullet in the freed place, so both are
+// O(1) and iterating only ever touches live bullets. The storage is reserved up
+// front and only grows when more bullets are alive than it can hold.
+class BulletPool
+{
+public:
+    BulletPool(int capacity = BULLET_POOL_CAPACITY);
+    virtual ~BulletPool();
+
+    Bullet* spawn(PlayerHandle gunner, const glm::vec3& pos, const glm::vec3& dir);
+
+    // Moves the last live bullet into this index, do not advance when iterating
+    void kill(int index);
+    void clear();
+
+    int size() const;
+    int capacity() const;
+    void reserve(int capacity);
+
+    // The most bullets alive at the same time and how often the pool had to grow for them
+    int highWaterMark() const;
+    int growCount() const;
+    void resetStats();
+
+    // Only the live bullets, the capacity and stats stay what they are
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
+    Bullet& operator [] (int index);
+    const Bullet& operator [] (int index) const;
+
+    Bullet* begin();
+    Bullet* end();
+    const Bullet* begin() const;
+    const Bullet* end() const;
+
+private:
+    std::vector<Bullet> _bullets;
+    int _size;
+    int _highWaterMark;
+    int _growCount;
+};
+
+#endif // BULLET_POOL_H
@@ -0,0 +1,62 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cmath>
+
+#include "astar.h"
+#include "visibility.h"
+
+// Sweeps the segment from (fromX, fromY) to (toX, toY), in tile units, through the grid of tiles
+// and returns true when it enters a blocking tile. hit is then set to the fraction of the segment
+// where the blocking tile is entered, see obj_WalkTiles.
+template <class TIsBlocking>
+bool obj_SweepTiles(float fromX, float fromY, float toX, float toY, TIsBlocking isBlocking, float& hit)
+{
+    tPosition tile = { int(std::floor(fromX)), int(std::floor(fromY)) };
+    if (isBlocking(tile))
+    {
+        hit = 0.0f;
+        return true;
+    }
+
+    float dx = toX - fromX, dy = toY - fromY;
+    int stepX = dx > 0.0f ? 1 : -1, stepY = dy > 0.0f ? 1 : -1;
+
+    // Fraction of the segment between crossing two vertical or horizontal tile edges, and to the next one
+    float tDeltaX = dx != 0.0f ? std::fabs(1.0f / dx) : INFINITY;
+    float tDeltaY = dy != 0.0f ? std::fabs(1.0f / dy) : INFINITY;
+    float tMaxX = dx != 0.0f ? (dx > 0.0f ? (tile.x + 1 - fromX) : (fromX - tile.x)) * tDeltaX : INFINITY;
+    float tMaxY = dy != 0.0f ? (dy > 0.0f ? (tile.y + 1 - fromY) : (fromY - tile.y)) * tDeltaY : INFINITY;
+
+    return obj_WalkTiles(tile, stepX, stepY, tMaxX, tMaxY, tDeltaX, tDeltaY, 1.0f, isBlocking, hit);
+}
+
+// Returns true when the segment from (fromX, fromY) to (toX, toY) comes within the radius of the
+// center, hit is then set to the fraction of the segment where it first touches the circle
+inline bool obj_SweepCircle(float fromX, float fromY, float toX, float toY, float centerX, float centerY, float radius, float& hit)
+{
+    float dx = toX - fromX, dy = toY - fromY;
+    float fx = fromX - centerX, fy = fromY - centerY;
+
+    float c = fx * fx + fy * fy - radius * radius;
+    if (c < 0.0f)
+    {
+        hit = 0.0f;
+        return true;
+    }
+
+    float a = dx * dx + dy * dy;
+    if (a == 0.0f) return false;
+
+    float b = fx * dx + fy * dy;
+    float discriminant = b * b - a * c;
+    if (b >= 0.0f || discriminant < 0.0f) return false;
+
+    float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.0f) return false;
+
+    hit = t;
+    return true;
+}
+
+#endif // COLLISION_H
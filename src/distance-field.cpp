@@ -0,0 +1,169 @@
+#include "distance-field.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double infinity = 1e20;
+
+// One dimensional squared distance transform of the sampled function f, see
+// "Distance Transforms of Sampled Functions" by Felzenszwalb and Huttenlocher
+static void distanceTransform(const double* f, int n, double* d, int* v, double* z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -infinity;
+    z[1] = infinity;
+
+    for (int q = 1; q < n; q++)
+    {
+        double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = infinity;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (z[k + 1] < q) k++;
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+// Squared distances to the nearest wall inside the given window, walls outside the window are ignored
+static std::vector<double> squaredDistances(int left, int top, int width, int height, std::function<bool (const tPosition&)>& isWall)
+{
+    int size = std::max(width, height);
+    std::vector<double> grid(width * height);
+    std::vector<double> f(size), d(size), z(size + 1);
+    std::vector<int> v(size);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            tPosition position = { left + x, top + y };
+            grid[y * width + x] = isWall(position) ? 0.0 : infinity;
+        }
+    }
+
+    // First pass along the columns
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++) f[y] = grid[y * width + x];
+        distanceTransform(f.data(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; y++) grid[y * width + x] = d[y];
+    }
+
+    // Second pass along the rows
+    for (int y = 0; y < height; y++)
+    {
+        distanceTransform(&grid[y * width], width, d.data(), v.data(), z.data());
+        for (int x = 0; x < width; x++) grid[y * width + x] = d[x];
+    }
+
+    return grid;
+}
+
+static double withBorder(double squaredDistance, int x, int y, int width, int height)
+{
+    // The border of the level is a wall as well
+    int border = std::min(std::min(x + 1, width - x), std::min(y + 1, height - y));
+    return std::min(std::sqrt(squaredDistance), double(border));
+}
+
+static unsigned short toFieldUnits(double distance)
+{
+    return (unsigned short)std::min(distance * DISTANCE_FIELD_UNITS + 0.5, double(std::numeric_limits<unsigned short>::max()));
+}
+
+std::vector<unsigned short> obj_GetDistanceField(int width, int height, std::function<bool (const tPosition&)> isWall)
+{
+    std::vector<unsigned short> result;
+    if (width <= 0 || height <= 0) return result;
+
+    auto grid = squaredDistances(0, 0, width, height, isWall);
+
+    result.resize(width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            result[y * width + x] = toFieldUnits(withBorder(grid[y * width + x], x, y, width, height));
+        }
+    }
+
+    return result;
+}
+
+void obj_UpdateDistanceField(std::vector<unsigned short>& field, int width, int height, std::function<bool (const tPosition&)> isWall,
+                             const tPosition& from, const tPosition& to)
+{
+    if (int(field.size()) != width * height)
+    {
+        field = obj_GetDistanceField(width, height, isWall);
+        return;
+    }
+
+    // A tile can only change when its old nearest wall was in the changed rectangle, or when a new wall in the
+    // rectangle is closer than its old nearest wall. Either way its old distance is at least its distance to the
+    // rectangle, the farthest tile like that bounds what is recalculated. Next to walls that is close by, a wall
+    // changing in the middle of a wide open area does change the field far away.
+    int fromX = std::min(from.x, to.x), fromY = std::min(from.y, to.y);
+    int toX = std::max(from.x, to.x), toY = std::max(from.y, to.y);
+    int largest = *std::max_element(field.begin(), field.end()) / DISTANCE_FIELD_UNITS + 1;
+    int reach = 0;
+    for (int y = std::max(0, fromY - largest); y <= std::min(height - 1, toY + largest); y++)
+    {
+        int outsideY = std::max(fromY - y, y - toY);
+        for (int x = std::max(0, fromX - largest); x <= std::min(width - 1, toX + largest); x++)
+        {
+            int outside = std::max(outsideY, std::max(fromX - x, x - toX));
+            if (outside > reach && field[y * width + x] >= outside * DISTANCE_FIELD_UNITS) reach = outside;
+        }
+    }
+    reach++;
+
+    int left = std::max(0, fromX - reach), top = std::max(0, fromY - reach);
+    int right = std::min(width - 1, toX + reach), bottom = std::min(height - 1, toY + reach);
+
+    // Walls up to the same reach outside of the updated tiles can still be the nearest
+    int windowLeft = std::max(0, left - reach), windowTop = std::max(0, top - reach);
+    int windowRight = std::min(width - 1, right + reach), windowBottom = std::min(height - 1, bottom + reach);
+    int windowWidth = windowRight - windowLeft + 1, windowHeight = windowBottom - windowTop + 1;
+    if (windowWidth == width && windowHeight == height)
+    {
+        field = obj_GetDistanceField(width, height, isWall);
+        return;
+    }
+
+    auto grid = squaredDistances(windowLeft, windowTop, windowWidth, windowHeight, isWall);
+
+    std::vector<unsigned short> updated((right - left + 1) * (bottom - top + 1));
+    for (int y = top; y <= bottom; y++)
+    {
+        for (int x = left; x <= right; x++)
+        {
+            double distance = withBorder(grid[(y - windowTop) * windowWidth + (x - windowLeft)], x, y, width, height);
+
+            // Removed walls made this tile further away from a wall than we looked for
+            if (distance > reach)
+            {
+                field = obj_GetDistanceField(width, height, isWall);
+                return;
+            }
+            updated[(y - top) * (right - left + 1) + (x - left)] = toFieldUnits(distance);
+        }
+    }
+
+    for (int y = top; y <= bottom; y++)
+    {
+        std::copy(&updated[(y - top) * (right - left + 1)], &updated[(y - top) * (right - left + 1)] + (right - left + 1), &field[y * width + left]);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include <functional>
+#include <vector>
+
+#include "astar.h"
+
+// Distances in the field are stored in steps of 1/DISTANCE_FIELD_UNITS tile
+#define DISTANCE_FIELD_UNITS 8
+
+// Calculates the exact euclidean distance from every tile to the nearest wall tile with the two pass
+// distance transform of Felzenszwalb and Huttenlocher. Everything outside the given size counts as wall.
+std::vector<unsigned short> obj_GetDistanceField(int width, int height, std::function<bool (const tPosition&)> isWall);
+
+// Recalculates only the part of the field that can be affected by wall changes in the rectangle between
+// from and to (inclusive), the tiles at least as far from their old nearest wall as from the rectangle.
+// Recalculates the whole field when that part needs all walls, as changes in wide open areas do, or when
+// removed walls leave tiles farther from a wall than that.
+void obj_UpdateDistanceField(std::vector<unsigned short>& field, int width, int height, std::function<bool (const tPosition&)> isWall,
+                             const tPosition& from, const tPosition& to);
+
+#endif // DISTANCE_FIELD_H
@@ -0,0 +1,114 @@
+#include "file-watcher.h"
+
+#include <set>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif // __linux__
+
+static long long modificationTime(const std::string& filename)
+{
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) return 0;
+
+    return (long long)info.st_mtime;
+}
+
+FileWatcher::FileWatcher()
+    : _inotify(-1)
+{
+#ifdef __linux__
+    this->_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif // __linux__
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (this->_inotify >= 0) close(this->_inotify);
+#endif // __linux__
+}
+
+bool FileWatcher::watch(const std::string& filename)
+{
+    sWatch watch;
+    watch.filename = filename;
+    watch.descriptor = -1;
+    watch.modified = modificationTime(filename);
+
+    auto slash = filename.find_last_of("/\\");
+    watch.directory = (slash == std::string::npos ? "." : filename.substr(0, slash));
+    watch.name = (slash == std::string::npos ? filename : filename.substr(slash + 1));
+
+#ifdef __linux__
+    if (this->_inotify >= 0)
+    {
+        watch.descriptor = inotify_add_watch(this->_inotify, watch.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    }
+#endif // __linux__
+
+    this->_watches.push_back(watch);
+
+    return watch.descriptor >= 0 || watch.modified != 0;
+}
+
+void FileWatcher::clear()
+{
+#ifdef __linux__
+    // Watches on the same directory share their descriptor
+    std::set<int> descriptors;
+    for (auto& watch : this->_watches)
+    {
+        if (watch.descriptor >= 0) descriptors.insert(watch.descriptor);
+    }
+    for (auto descriptor : descriptors) inotify_rm_watch(this->_inotify, descriptor);
+#endif // __linux__
+
+    this->_watches.clear();
+}
+
+std::vector<std::string> FileWatcher::changes()
+{
+    std::vector<std::string> result;
+
+#ifdef __linux__
+    if (this->_inotify >= 0)
+    {
+        char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+        while ((length = read(this->_inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len)
+            {
+                auto event = (const struct inotify_event*)ptr;
+                if (event->len == 0) continue;
+
+                for (auto& watch : this->_watches)
+                {
+                    if (watch.descriptor != event->wd || watch.name != event->name) continue;
+
+                    bool reported = false;
+                    for (auto& filename : result) reported = reported || (filename == watch.filename);
+                    if (!reported) result.push_back(watch.filename);
+                }
+            }
+        }
+    }
+#endif // __linux__
+
+    for (auto& watch : this->_watches)
+    {
+        if (watch.descriptor >= 0) continue;
+
+        auto modified = modificationTime(watch.filename);
+        if (modified != watch.modified)
+        {
+            watch.modified = modified;
+            result.push_back(watch.filename);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,36 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#include <vector>
+
+// Reports changes to a set of files. On Linux the changes come from inotify, where editors
+// replacing a file through a rename are caught by watching the directory of the file. On
+// other platforms the modification times of the files are polled.
+class FileWatcher
+{
+public:
+    FileWatcher();
+    virtual ~FileWatcher();
+
+    bool watch(const std::string& filename);
+    void clear();
+
+    // Returns the watched files that changed since the previous call, without blocking
+    std::vector<std::string> changes();
+
+private:
+    struct sWatch
+    {
+        std::string filename;
+        std::string directory;
+        std::string name;
+        int descriptor;
+        long long modified;
+    };
+
+    std::vector<sWatch> _watches;
+    int _inotify;
+};
+
+#endif // FILE_WATCHER_H
@@ -0,0 +1,71 @@
+#include "fixed-timestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+FixedTimestep::FixedTimestep(int tickRate, int maxTicksPerFrame)
+    : _tickRate(std::max(tickRate, 1)), _maxTicksPerFrame(std::max(maxTicksPerFrame, 1)), _accumulator(0.0), _droppedTicks(0)
+{ }
+
+FixedTimestep::~FixedTimestep() { }
+
+void FixedTimestep::setTickRate(int tickRate)
+{
+    // Keep the same fraction of a tick, so alpha does not jump
+    double fraction = this->_accumulator * this->_tickRate;
+    this->_tickRate = std::max(tickRate, 1);
+    this->_accumulator = fraction / this->_tickRate;
+}
+
+int FixedTimestep::tickRate() const
+{
+    return this->_tickRate;
+}
+
+float FixedTimestep::tickLength() const
+{
+    return 1.0f / this->_tickRate;
+}
+
+void FixedTimestep::setMaxTicksPerFrame(int maxTicksPerFrame)
+{
+    this->_maxTicksPerFrame = std::max(maxTicksPerFrame, 1);
+}
+
+int FixedTimestep::maxTicksPerFrame() const
+{
+    return this->_maxTicksPerFrame;
+}
+
+int FixedTimestep::advance(float frameTime)
+{
+    double tickLength = 1.0 / this->_tickRate;
+
+    this->_accumulator += std::max(frameTime, 0.0f);
+    int ticks = int(std::floor(this->_accumulator / tickLength));
+    this->_accumulator -= ticks * tickLength;
+
+    if (ticks > this->_maxTicksPerFrame)
+    {
+        this->_droppedTicks += ticks - this->_maxTicksPerFrame;
+        ticks = this->_maxTicksPerFrame;
+    }
+
+    return ticks;
+}
+
+float FixedTimestep::alpha() const
+{
+    return float(std::min(this->_accumulator * this->_tickRate, 1.0));
+}
+
+int FixedTimestep::droppedTicks() const
+{
+    return this->_droppedTicks;
+}
+
+void FixedTimestep::reset()
+{
+    this->_accumulator = 0.0;
+    this->_droppedTicks = 0;
+}
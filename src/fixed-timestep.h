@@ -0,0 +1,40 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#define FIXED_TIMESTEP_TICK_RATE 60
+#define FIXED_TIMESTEP_MAX_TICKS_PER_FRAME 8
+
+// Turns variable frame times into a number of fixed length simulation ticks. Time that is
+// left over is carried to the next frame, alpha() tells how far the renderer is between the
+// last two ticks. When a frame would need more than the maximum number of ticks, the extra
+// time is dropped so a slow simulation cannot keep falling further behind.
+class FixedTimestep
+{
+public:
+    FixedTimestep(int tickRate = FIXED_TIMESTEP_TICK_RATE, int maxTicksPerFrame = FIXED_TIMESTEP_MAX_TICKS_PER_FRAME);
+    virtual ~FixedTimestep();
+
+    void setTickRate(int tickRate);
+    int tickRate() const;
+    float tickLength() const;
+
+    void setMaxTicksPerFrame(int maxTicksPerFrame);
+    int maxTicksPerFrame() const;
+
+    // Adds the frame time in seconds and returns the number of ticks to simulate for this frame
+    int advance(float frameTime);
+
+    // Between 0 and 1, how far the time is past the last simulated tick
+    float alpha() const;
+
+    int droppedTicks() const;
+    void reset();
+
+private:
+    int _tickRate;
+    int _maxTicksPerFrame;
+    double _accumulator;
+    int _droppedTicks;
+};
+
+#endif // FIXED_TIMESTEP_H
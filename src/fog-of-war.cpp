@@ -0,0 +1,174 @@
+#include "fog-of-war.h"
+
+#include "visibility.h"
+
+#include <algorithm>
+
+static float playerScale = LEVEL_TILE_WORLD_SIZE;
+
+static FogRect emptyRect()
+{
+    FogRect rect = { 0, 0, -1, -1 };
+    return rect;
+}
+
+FogOfWar::FogOfWar() : _level(nullptr), _width(0), _height(0), _valid(false), _cast(0), _lastCasts(0)
+{
+    for (auto& dirty : this->_dirty) dirty = emptyRect();
+}
+
+FogOfWar::~FogOfWar() { }
+
+void FogOfWar::update(const PlayerStorage& players, const Level& level)
+{
+    int count = players.size();
+    bool full = !this->_valid || &level != this->_level || level.width != this->_width || level.height != this->_height ||
+            players._handle != this->_handles || players._team != this->_teams;
+    if (full) this->reset(players, level);
+
+    this->_lastCasts = 0;
+    if (this->_width == 0) return;
+
+    int width = this->_width, height = this->_height;
+    auto isTransparent = [&level, width, height] (const tPosition& position) {
+        return position.x >= 0 && position.x < width && position.y >= 0 && position.y < height && level.isTransparent(position.x, position.y);
+    };
+
+    for (int slot = 0; slot < count; slot++)
+    {
+        bool alive = players._health[slot] > 0.0f;
+        int x = alive ? int(players._posX[slot] / playerScale) : -1;
+        int y = alive ? int(players._posY[slot] / playerScale) : -1;
+        if (!full && x == this->_tileX[slot] && y == this->_tileY[slot]) continue;
+
+        int team = int(players._team[slot]);
+        auto& view = this->_views[slot];
+        for (auto tile : view) this->cover(team, tile);
+        view.clear();
+
+        this->_tileX[slot] = x;
+        this->_tileY[slot] = y;
+        if (!alive) continue;
+
+        // Tiles on the borders of the octants come up twice, they are only counted once
+        this->_cast++;
+        tPosition origin = { x, y };
+        obj_CastShadows(origin, FOG_OF_WAR_RADIUS, isTransparent, [this, &view, team, width, height] (const tPosition& position) {
+            if (position.x < 0 || position.x >= width || position.y < 0 || position.y >= height) return;
+
+            int tile = position.y * width + position.x;
+            if (this->_castStamp[tile] == this->_cast) return;
+
+            this->_castStamp[tile] = this->_cast;
+            view.push_back(tile);
+            this->uncover(team, tile);
+        });
+        this->_lastCasts++;
+    }
+}
+
+void FogOfWar::invalidate()
+{
+    this->_valid = false;
+}
+
+int FogOfWar::width() const
+{
+    return this->_width;
+}
+
+int FogOfWar::height() const
+{
+    return this->_height;
+}
+
+const std::vector<unsigned char>& FogOfWar::mask(Teams team) const
+{
+    return this->_masks[int(team)];
+}
+
+bool FogOfWar::isVisible(Teams team, int x, int y) const
+{
+    if (this->_width == 0) return true;
+    if (x < 0 || x >= this->_width || y < 0 || y >= this->_height) return false;
+
+    return this->_masks[int(team)][y * this->_width + x] != 0;
+}
+
+FogRect FogOfWar::takeDirty(Teams team)
+{
+    auto dirty = this->_dirty[int(team)];
+    this->_dirty[int(team)] = emptyRect();
+
+    return dirty;
+}
+
+int FogOfWar::lastCasts() const
+{
+    return this->_lastCasts;
+}
+
+// Starts over with every tile in the fog and all of it dirty
+void FogOfWar::reset(const PlayerStorage& players, const Level& level)
+{
+    bool streamed = level._streamer != nullptr;
+    this->_level = &level;
+    this->_width = streamed ? 0 : level.width;
+    this->_height = streamed ? 0 : level.height;
+    this->_valid = true;
+
+    this->_handles = players._handle;
+    this->_teams = players._team;
+    this->_tileX.assign(players.size(), -1);
+    this->_tileY.assign(players.size(), -1);
+    this->_views.resize(players.size());
+    for (auto& view : this->_views) view.clear();
+
+    int tiles = this->_width * this->_height;
+    for (int team = 0; team < 3; team++)
+    {
+        this->_seen[team].assign(tiles, 0);
+        this->_masks[team].assign(tiles, 0);
+        this->_dirty[team] = emptyRect();
+        if (tiles > 0)
+        {
+            FogRect all = { 0, 0, this->_width - 1, this->_height - 1 };
+            this->_dirty[team] = all;
+        }
+    }
+    this->_castStamp.assign(tiles, 0);
+    this->_cast = 0;
+}
+
+void FogOfWar::uncover(int team, int tile)
+{
+    if (this->_seen[team][tile]++ > 0) return;
+
+    this->_masks[team][tile] = 255;
+    this->markDirty(team, tile);
+}
+
+void FogOfWar::cover(int team, int tile)
+{
+    if (--this->_seen[team][tile] > 0) return;
+
+    this->_masks[team][tile] = 0;
+    this->markDirty(team, tile);
+}
+
+void FogOfWar::markDirty(int team, int tile)
+{
+    int x = tile % this->_width, y = tile / this->_width;
+    auto& dirty = this->_dirty[team];
+    if (dirty.maxX < dirty.minX)
+    {
+        FogRect rect = { x, y, x, y };
+        dirty = rect;
+        return;
+    }
+
+    dirty.minX = std::min(dirty.minX, x);
+    dirty.minY = std::min(dirty.minY, y);
+    dirty.maxX = std::max(dirty.maxX, x);
+    dirty.maxY = std::max(dirty.maxY, y);
+}
@@ -0,0 +1,79 @@
+#ifndef FOG_OF_WAR_H
+#define FOG_OF_WAR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "level.h"
+#include "line-of-sight.h"
+#include "player-storage.h"
+
+// Tiles a player uncovers around them, as far as they can see an enemy
+#define FOG_OF_WAR_RADIUS LINE_OF_SIGHT_DISTANCE
+
+// Tiles of a mask, both corners included. Empty when maxX is smaller than minX.
+typedef struct sFogRect
+{
+    int minX, minY;
+    int maxX, maxY;
+} FogRect;
+
+// The tiles each team sees on the radar, one byte per tile. The view of a player is cast with
+// shadowcasting over the see-through tiles of the level and kept until the player enters
+// another tile or dies, so an update only casts the views of the players that moved. Every
+// team counts the players seeing each tile and keeps the rectangle of its mask that changed
+// since it was last taken, for uploading only that part.
+//
+// Streamed levels are never completely in memory and have no fog, everything is visible.
+class FogOfWar
+{
+public:
+    FogOfWar();
+    virtual ~FogOfWar();
+
+    void update(const PlayerStorage& players, const Level& level);
+
+    // Casts every view again in the next update, for example after the tiles of the level changed
+    void invalidate();
+
+    int width() const;
+    int height() const;
+
+    // 255 where a player of the team sees the tile, 0 in the fog
+    const std::vector<unsigned char>& mask(Teams team) const;
+    bool isVisible(Teams team, int x, int y) const;
+
+    // The part of the mask that changed since the last call
+    FogRect takeDirty(Teams team);
+
+    // Views cast in the last update
+    int lastCasts() const;
+
+private:
+    const Level* _level;
+    int _width, _height;
+    bool _valid;
+
+    // Who was in every slot in the last update, where and the tiles they saw
+    std::vector<PlayerHandle> _handles;
+    std::vector<Teams> _teams;
+    std::vector<int> _tileX, _tileY;
+    std::vector<std::vector<int> > _views;
+
+    // Per team, players seeing each tile, the mask and what changed in it
+    std::vector<uint16_t> _seen[3];
+    std::vector<unsigned char> _masks[3];
+    FogRect _dirty[3];
+
+    // Tiles already in the view being cast
+    std::vector<unsigned int> _castStamp;
+    unsigned int _cast;
+    int _lastCasts;
+
+    void reset(const PlayerStorage& players, const Level& level);
+    void uncover(int team, int tile);
+    void cover(int team, int tile);
+    void markDirty(int team, int tile);
+};
+
+#endif // FOG_OF_WAR_H
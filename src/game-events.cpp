@@ -0,0 +1,54 @@
+#include "game-events.h"
+
+#include <algorithm>
+
+static int roundUpToPowerOfTwo(int value)
+{
+    int result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+GameEventQueue::GameEventQueue(int capacity) : _published(0)
+{
+    this->_events.resize(roundUpToPowerOfTwo(std::max(capacity, 1)));
+}
+
+GameEventQueue::~GameEventQueue() { }
+
+void GameEventQueue::publish(GameEventTypes type, unsigned int tick, PlayerHandle player, PlayerHandle other, const glm::vec3& pos, float value)
+{
+    GameEvent event = { type, tick, player, other, pos, value };
+    this->_events[this->_published & (this->_events.size() - 1)] = event;
+    this->_published++;
+}
+
+// The events are copied in at most two runs, before and after the end of the buffer
+int GameEventQueue::drain(GameEventCursor& cursor, std::vector<GameEvent>& events) const
+{
+    GameEventCursor capacity = this->_events.size();
+    GameEventCursor oldest = this->_published > capacity ? this->_published - capacity : 0;
+    int lost = cursor < oldest ? int(oldest - cursor) : 0;
+    if (cursor < oldest) cursor = oldest;
+    if (cursor > this->_published) cursor = this->_published;
+
+    while (cursor < this->_published)
+    {
+        auto first = size_t(cursor & (capacity - 1));
+        auto count = size_t(std::min(this->_published - cursor, capacity - first));
+        events.insert(events.end(), this->_events.begin() + first, this->_events.begin() + first + count);
+        cursor += count;
+    }
+
+    return lost;
+}
+
+GameEventCursor GameEventQueue::end() const
+{
+    return this->_published;
+}
+
+int GameEventQueue::capacity() const
+{
+    return int(this->_events.size());
+}
@@ -0,0 +1,63 @@
+#ifndef GAME_EVENTS_H
+#define GAME_EVENTS_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "player-storage.h"
+
+#define GAME_EVENT_CAPACITY 4096
+
+enum class GameEventTypes
+{
+    BulletFired,
+    PlayerHit,
+    PlayerKilled,
+    PathCompleted
+};
+
+// Something that happened in a tick. The player is the gunner of shots, hits and kills and the
+// walker of paths, other is the victim of hits and kills. Hits carry the damage in value.
+typedef struct sGameEvent
+{
+    GameEventTypes type;
+    unsigned int tick;
+    PlayerHandle player;
+    PlayerHandle other;
+    glm::vec3 pos;
+    float value;
+} GameEvent;
+
+// Where a reader is in the queue, the number of events published before the next one it reads
+typedef uint64_t GameEventCursor;
+
+// Events of a world in the order they happened, in one ring buffer every reader drains on its
+// own. Publishing never waits for readers, a reader more than the capacity behind loses the
+// oldest events. Published and read on the thread updating the world.
+//
+// Events are not part of the world state. After a restore the ticks played again publish their
+// events again.
+class GameEventQueue
+{
+public:
+    // The capacity is rounded up to a power of two
+    GameEventQueue(int capacity = GAME_EVENT_CAPACITY);
+    virtual ~GameEventQueue();
+
+    void publish(GameEventTypes type, unsigned int tick, PlayerHandle player, PlayerHandle other, const glm::vec3& pos, float value = 0.0f);
+
+    // Appends the events after the cursor to events and moves the cursor past them.
+    // Returns how many events the reader lost because it fell behind.
+    int drain(GameEventCursor& cursor, std::vector<GameEvent>& events) const;
+
+    // Readers starting here get the events published from now on
+    GameEventCursor end() const;
+    int capacity() const;
+
+private:
+    std::vector<GameEvent> _events;
+    GameEventCursor _published;
+};
+
+#endif // GAME_EVENTS_H
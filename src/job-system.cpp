@@ -0,0 +1,228 @@
+#include "job-system.h"
+
+#include <algorithm>
+
+// The system and queue of the worker running on this thread, if any
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local int currentQueue = 0;
+
+JobCounter::JobCounter() : _pending(0) { }
+
+bool JobCounter::isDone() const
+{
+    return this->_pending.load() == 0;
+}
+
+JobSystem::JobSystem(int threads) : _queued(0), _running(true)
+{
+    if (threads <= 0) threads = std::max(int(std::thread::hardware_concurrency()), 1);
+
+    for (int i = 0; i < threads; i++) this->_queues.push_back(new JobQueue());
+    for (int i = 1; i < threads; i++) this->_workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_sleepMutex);
+        this->_running = false;
+    }
+    this->_wake.notify_all();
+    for (auto& worker : this->_workers) worker.join();
+
+    for (auto queue : this->_queues) delete queue;
+}
+
+int JobSystem::threadCount() const
+{
+    return int(this->_queues.size());
+}
+
+void JobSystem::run(const Job& job, JobCounter& counter)
+{
+    counter._pending++;
+
+    auto queue = this->_queues[this->queueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(std::make_pair(job, &counter));
+    }
+    this->_queued++;
+
+    // Taking the lock makes sure a worker that is about to sleep sees the new job
+    {
+        std::lock_guard<std::mutex> lock(this->_sleepMutex);
+    }
+    this->_wake.notify_one();
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    int queue = this->queueIndex();
+    while (!counter.isDone())
+    {
+        if (!this->runOne(queue)) std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int grain, const std::function<void (int, int)>& body)
+{
+    if (end <= begin) return;
+
+    grain = std::max(grain, 1);
+    if (this->_workers.empty() || end - begin <= grain)
+    {
+        body(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    for (int from = begin + grain; from < end; from += grain)
+    {
+        int to = std::min(from + grain, end);
+        this->run([&body, from, to] () { body(from, to); }, counter);
+    }
+
+    // The first range runs right here, the rest is picked up by whoever is free
+    body(begin, std::min(begin + grain, end));
+    this->wait(counter);
+}
+
+int JobSystem::queueIndex() const
+{
+    return currentSystem == this ? currentQueue : 0;
+}
+
+bool JobSystem::runOne(int queue)
+{
+    std::pair<Job, JobCounter*> job;
+    bool found = false;
+
+    // Newest job of our own queue first, it is most likely still in the cache
+    {
+        auto own = this->_queues[queue];
+        std::lock_guard<std::mutex> lock(own->mutex);
+        if (!own->jobs.empty())
+        {
+            job = std::move(own->jobs.back());
+            own->jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // Otherwise steal the oldest job of another queue, that is usually the biggest piece of work
+    for (int i = 1; !found && i < int(this->_queues.size()); i++)
+    {
+        auto other = this->_queues[(queue + i) % this->_queues.size()];
+        std::lock_guard<std::mutex> lock(other->mutex);
+        if (!other->jobs.empty())
+        {
+            job = std::move(other->jobs.front());
+            other->jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    this->_queued--;
+    job.first();
+    job.second->_pending--;
+
+    return true;
+}
+
+void JobSystem::workerLoop(int queue)
+{
+    currentSystem = this;
+    currentQueue = queue;
+
+    while (true)
+    {
+        if (this->runOne(queue)) continue;
+
+        std::unique_lock<std::mutex> lock(this->_sleepMutex);
+        this->_wake.wait(lock, [this] () { return !this->_running || this->_queued > 0; });
+        if (!this->_running) return;
+    }
+}
+
+void obj_ParallelFor(JobSystem* jobs, int begin, int end, int grain, const std::function<void (int, int)>& body)
+{
+    if (jobs != nullptr) jobs->parallelFor(begin, end, grain, body);
+    else if (end > begin) body(begin, end);
+}
+
+FrameGraph::FrameGraph() { }
+
+FrameGraph::~FrameGraph()
+{
+    for (auto pass : this->_passes) delete pass;
+}
+
+FrameGraph::Pass FrameGraph::add(const std::string& name, const Job& job, const std::vector<Pass>& dependencies)
+{
+    Pass pass = Pass(this->_passes.size());
+
+    auto framePass = new FramePass();
+    framePass->name = name;
+    framePass->job = job;
+    for (auto dependency : dependencies)
+    {
+        if (dependency < 0 || dependency >= pass) continue;
+
+        framePass->dependencies.push_back(dependency);
+        this->_passes[dependency]->successors.push_back(pass);
+    }
+    this->_passes.push_back(framePass);
+
+    return pass;
+}
+
+void FrameGraph::run(JobSystem* jobs)
+{
+    // Dependencies are always added first, so the order of adding is a valid order to run in
+    if (jobs == nullptr)
+    {
+        for (auto pass : this->_passes) pass->job();
+        return;
+    }
+
+    for (auto pass : this->_passes) pass->remaining = int(pass->dependencies.size());
+
+    JobCounter done;
+    for (Pass pass = 0; pass < int(this->_passes.size()); pass++)
+    {
+        if (this->_passes[pass]->dependencies.empty()) this->schedule(jobs, pass, done);
+    }
+    jobs->wait(done);
+}
+
+int FrameGraph::passCount() const
+{
+    return int(this->_passes.size());
+}
+
+const std::string& FrameGraph::name(Pass pass) const
+{
+    return this->_passes[pass]->name;
+}
+
+const std::vector<FrameGraph::Pass>& FrameGraph::dependencies(Pass pass) const
+{
+    return this->_passes[pass]->dependencies;
+}
+
+void FrameGraph::schedule(JobSystem* jobs, Pass pass, JobCounter& done)
+{
+    jobs->run([this, jobs, pass, &done] () {
+        auto framePass = this->_passes[pass];
+        framePass->job();
+
+        // The successors are scheduled before this job counts as done, so done cannot reach zero too early
+        for (auto successor : framePass->successors)
+        {
+            if (--this->_passes[successor]->remaining == 0) this->schedule(jobs, successor, done);
+        }
+    }, done);
+}
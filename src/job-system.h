@@ -0,0 +1,108 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::function<void ()> Job;
+
+// Counts the jobs that still have to finish, wait on it with JobSystem::wait
+class JobCounter
+{
+public:
+    JobCounter();
+
+    bool isDone() const;
+
+private:
+    std::atomic<int> _pending;
+
+    friend class JobSystem;
+};
+
+// Small work-stealing job system. Every thread has its own deque, it pushes and pops jobs
+// at the back and steals from the front of the others when its own runs empty. Threads
+// waiting for a counter run jobs in the mean time, so jobs can wait for jobs they started.
+class JobSystem
+{
+public:
+    // Zero threads uses one thread per core, the thread that waits is one of them
+    JobSystem(int threads = 0);
+    virtual ~JobSystem();
+
+    int threadCount() const;
+
+    void run(const Job& job, JobCounter& counter);
+    void wait(JobCounter& counter);
+
+    // Calls body with consecutive ranges of at most grain items and returns when all ranges are done
+    void parallelFor(int begin, int end, int grain, const std::function<void (int, int)>& body);
+
+private:
+    class JobQueue
+    {
+    public:
+        std::mutex mutex;
+        std::deque<std::pair<Job, JobCounter*> > jobs;
+    };
+
+    // Queue 0 is shared by all threads that are not workers of this system
+    std::vector<JobQueue*> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<int> _queued;
+    bool _running;
+
+    int queueIndex() const;
+    bool runOne(int queue);
+    void workerLoop(int queue);
+};
+
+// Runs on the job system when there is one and on the calling thread when there is not
+void obj_ParallelFor(JobSystem* jobs, int begin, int end, int grain, const std::function<void (int, int)>& body);
+
+// The passes of a tick and the passes each of them waits for. Passes run as soon as all
+// their dependencies are done, passes that do not depend on each other run at the same
+// time. Without a job system they run one after the other in the order they were added.
+class FrameGraph
+{
+public:
+    typedef int Pass;
+
+    FrameGraph();
+    virtual ~FrameGraph();
+
+    // Dependencies have to be added before the passes depending on them
+    Pass add(const std::string& name, const Job& job, const std::vector<Pass>& dependencies = std::vector<Pass>());
+
+    void run(JobSystem* jobs);
+
+    int passCount() const;
+    const std::string& name(Pass pass) const;
+    const std::vector<Pass>& dependencies(Pass pass) const;
+
+private:
+    class FramePass
+    {
+    public:
+        std::string name;
+        Job job;
+        std::vector<Pass> dependencies;
+        std::vector<Pass> successors;
+        std::atomic<int> remaining;
+    };
+
+    std::vector<FramePass*> _passes;
+
+    void schedule(JobSystem* jobs, Pass pass, JobCounter& done);
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,306 @@
+#include "level-streaming.h"
+
+#include "stb_image.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+// The chunk a thread read its last tile from, of the streamer opened with the given id
+typedef struct sChunkCache
+{
+    unsigned int streamer;
+    int key;
+    std::shared_ptr<const LevelChunk> chunk;
+} ChunkCache;
+
+static thread_local ChunkCache lastChunk = { 0, -1, nullptr };
+
+// Every time a streamer is opened it gets a new id, so no thread reads a chunk of a level opened before
+static std::atomic<unsigned int> nextStreamerId(1);
+
+LevelChunk::LevelChunk(int x, int y)
+    : _x(x), _y(y), _radarWidth(0), _radarHeight(0), _texture(0), _lastUsed(0)
+{ }
+
+LevelChunk::~LevelChunk() { }
+
+LevelStreamer::LevelStreamer(int maxResidentChunks)
+    : width(0), height(0), chunkSize(LEVEL_CHUNK_SIZE),
+      _maxResidentChunks(std::max(maxResidentChunks, 1)),
+      _chunksX(0), _chunksY(0), _clock(0), _id(0), _running(false)
+{ }
+
+LevelStreamer::~LevelStreamer()
+{
+    this->close();
+}
+
+bool LevelStreamer::open(const std::string& directory)
+{
+    std::ifstream info(directory + "/level.txt");
+    if (!info.is_open()) return false;
+
+    this->close();
+
+    this->_directory = directory;
+    this->spawns.clear();
+
+    std::string line;
+    while (std::getline(info, line))
+    {
+        std::stringstream ss(line);
+        std::string key;
+        ss >> key;
+        if (key == "size") ss >> this->width >> this->height;
+        else if (key == "chunk") ss >> this->chunkSize;
+        else if (key == "ct" || key == "t")
+        {
+            LevelSpawn spawn;
+            ss >> spawn.position.x >> spawn.position.y;
+            spawn.type = (key == "ct" ? LevelTileTypes::CounterTerroristSpawn : LevelTileTypes::TerroristSpawn);
+            this->spawns.push_back(spawn);
+        }
+    }
+
+    if (this->width <= 0 || this->height <= 0 || this->chunkSize <= 0) return false;
+
+    this->_chunksX = (this->width + this->chunkSize - 1) / this->chunkSize;
+    this->_chunksY = (this->height + this->chunkSize - 1) / this->chunkSize;
+
+    this->_id = nextStreamerId++;
+    this->_running = true;
+    this->_loader = std::thread(&LevelStreamer::loaderLoop, this);
+
+    return true;
+}
+
+void LevelStreamer::close()
+{
+    if (this->_loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_running = false;
+        }
+        this->_wakeLoader.notify_all();
+        this->_loader.join();
+    }
+
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_id = 0;
+    for (auto& pair : this->_resident) this->_evicted.push_back(pair.second);
+    this->_resident.clear();
+    this->_requests.clear();
+    this->_requested.clear();
+}
+
+Tile LevelStreamer::tileAt(int x, int y)
+{
+    Tile empty = { { 0, 0, 0, 0 } };
+    if (x < 0 || x >= this->width || y < 0 || y >= this->height) return empty;
+
+    int key = (y / this->chunkSize) * this->_chunksX + (x / this->chunkSize);
+
+    auto& cache = lastChunk;
+    if (cache.streamer != this->_id || cache.key != key)
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        auto found = this->_resident.find(key);
+        if (found == this->_resident.end())
+        {
+            // Fault the chunk in and wait for the loader to deliver it. Waiting pins the chunk, so
+            // loading the next one does not evict it again before this reader got to it.
+            this->_waiting[key]++;
+            this->request(key, true);
+            this->_loaded.wait(lock, [this, key] () {
+                return !this->_running || this->_resident.find(key) != this->_resident.end();
+            });
+            if (--this->_waiting[key] == 0) this->_waiting.erase(key);
+
+            found = this->_resident.find(key);
+            if (found == this->_resident.end()) return empty;
+        }
+
+        found->second->_lastUsed = ++this->_clock;
+        cache.streamer = this->_id;
+        cache.key = key;
+        cache.chunk = found->second;
+    }
+
+    auto& chunk = *cache.chunk;
+    int localX = x - chunk._x * this->chunkSize;
+    int localY = y - chunk._y * this->chunkSize;
+    if (chunk._tiles.empty()) return empty;
+
+    return chunk._tiles[localY * this->chunkSize + localX];
+}
+
+void LevelStreamer::prefetch(int fromX, int fromY, int toX, int toY)
+{
+    if (this->_chunksX == 0 || this->_chunksY == 0) return;
+
+    int fromChunkX = std::max(0, std::min(fromX, toX) / this->chunkSize);
+    int fromChunkY = std::max(0, std::min(fromY, toY) / this->chunkSize);
+    int toChunkX = std::min(this->_chunksX - 1, std::max(fromX, toX) / this->chunkSize);
+    int toChunkY = std::min(this->_chunksY - 1, std::max(fromY, toY) / this->chunkSize);
+
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    for (int y = fromChunkY; y <= toChunkY; y++)
+    {
+        for (int x = fromChunkX; x <= toChunkX; x++)
+        {
+            int key = y * this->_chunksX + x;
+            auto found = this->_resident.find(key);
+            if (found != this->_resident.end()) found->second->_lastUsed = ++this->_clock;
+            else this->request(key, false);
+        }
+    }
+}
+
+void LevelStreamer::visitResident(std::function<void (LevelChunk&)> visitor)
+{
+    // Visitors upload textures, the simulation faulting tiles in should not wait for that
+    std::vector<std::shared_ptr<LevelChunk> > chunks;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        chunks.reserve(this->_resident.size());
+        for (auto& pair : this->_resident) chunks.push_back(pair.second);
+    }
+
+    for (auto& chunk : chunks) visitor(*chunk);
+}
+
+std::vector<unsigned int> LevelStreamer::takeReleasedTextures()
+{
+    std::vector<std::shared_ptr<LevelChunk> > evicted;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        evicted.swap(this->_evicted);
+    }
+
+    // Only the visiting thread sets the textures, a chunk evicted while it was visited has its texture by now
+    std::vector<unsigned int> result;
+    for (auto& chunk : evicted)
+    {
+        if (chunk->_texture != 0) result.push_back(chunk->_texture);
+        chunk->_texture = 0;
+    }
+    return result;
+}
+
+int LevelStreamer::residentCount()
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return int(this->_resident.size());
+}
+
+int LevelStreamer::maxResidentChunks() const
+{
+    return this->_maxResidentChunks;
+}
+
+// Expects the mutex to be locked
+void LevelStreamer::request(int key, bool urgent)
+{
+    if (this->_requested.find(key) != this->_requested.end())
+    {
+        if (urgent)
+        {
+            // Move the pending request to the front so the fault is served first
+            auto found = std::find(this->_requests.begin(), this->_requests.end(), key);
+            if (found != this->_requests.end()) this->_requests.erase(found);
+            this->_requests.push_front(key);
+        }
+        return;
+    }
+
+    // Do not let prefetches pile up beyond what we could keep resident anyway
+    if (!urgent && int(this->_requests.size()) >= this->_maxResidentChunks) return;
+
+    this->_requested.insert(key);
+    if (urgent) this->_requests.push_front(key);
+    else this->_requests.push_back(key);
+    this->_wakeLoader.notify_one();
+}
+
+// Expects the mutex to be locked. Returns false when every resident chunk is waited for.
+bool LevelStreamer::evictLeastRecentlyUsed()
+{
+    auto oldest = this->_resident.end();
+    for (auto itr = this->_resident.begin(); itr != this->_resident.end(); ++itr)
+    {
+        if (this->_waiting.find(itr->first) != this->_waiting.end()) continue;
+        if (oldest == this->_resident.end() || itr->second->_lastUsed < oldest->second->_lastUsed) oldest = itr;
+    }
+
+    if (oldest == this->_resident.end()) return false;
+
+    // Textures can only be deleted on the thread owning the GL context
+    this->_evicted.push_back(oldest->second);
+    this->_resident.erase(oldest);
+    return true;
+}
+
+void LevelStreamer::loaderLoop()
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    while (this->_running)
+    {
+        this->_wakeLoader.wait(lock, [this] () { return !this->_running || !this->_requests.empty(); });
+        if (!this->_running) break;
+
+        int key = this->_requests.front();
+        this->_requests.pop_front();
+
+        lock.unlock();
+        std::shared_ptr<LevelChunk> chunk(this->loadChunk(key));
+        lock.lock();
+
+        // Chunks readers still wait for can take the resident count over the maximum for a moment
+        while (int(this->_resident.size()) >= this->_maxResidentChunks)
+        {
+            if (!this->evictLeastRecentlyUsed()) break;
+        }
+
+        chunk->_lastUsed = ++this->_clock;
+        this->_resident.insert(std::make_pair(key, chunk));
+        this->_requested.erase(key);
+        this->_loaded.notify_all();
+    }
+    this->_loaded.notify_all();
+}
+
+LevelChunk* LevelStreamer::loadChunk(int key) const
+{
+    auto chunk = new LevelChunk(key % this->_chunksX, key / this->_chunksX);
+
+    std::stringstream name;
+    name << this->_directory << "/" << chunk->_x << "_" << chunk->_y;
+
+    int w = 0, h = 0, comp = 0;
+    auto tiles = stbi_load((name.str() + "-walkable.png").c_str(), &w, &h, &comp, 4);
+    if (tiles != nullptr)
+    {
+        // Chunks on the right and bottom edge of the level can be smaller, pad them with empty tiles
+        Tile empty = { { 0, 0, 0, 0 } };
+        chunk->_tiles.resize(this->chunkSize * this->chunkSize, empty);
+        for (int y = 0; y < std::min(h, this->chunkSize); y++)
+        {
+            std::memcpy(&chunk->_tiles[y * this->chunkSize], tiles + (y * w * 4), std::min(w, this->chunkSize) * 4);
+        }
+        stbi_image_free(tiles);
+    }
+
+    auto radar = stbi_load((name.str() + ".png").c_str(), &w, &h, &comp, 4);
+    if (radar != nullptr)
+    {
+        chunk->_radar.assign(radar, radar + (w * h * 4));
+        chunk->_radarWidth = w;
+        chunk->_radarHeight = h;
+        stbi_image_free(radar);
+    }
+
+    return chunk;
+}
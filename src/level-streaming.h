@@ -0,0 +1,124 @@
+#ifndef LEVEL_STREAMING_H
+#define LEVEL_STREAMING_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "astar.h"
+
+#define LEVEL_CHUNK_SIZE 32
+#define LEVEL_MAX_RESIDENT_CHUNKS 128
+
+typedef struct sTile
+{
+    unsigned char rgba[4];
+} Tile;
+
+enum class LevelTileTypes
+{
+    NonWalkable,
+    Walkable,
+    NonWalkableButSeeThrough,
+    CounterTerroristSpawn,
+    TerroristSpawn
+};
+
+typedef struct sLevelSpawn
+{
+    tPosition position;
+    LevelTileTypes type;
+} LevelSpawn;
+
+// One square piece of a streamed level. The tile data stays resident until
+// the chunk is evicted, the radar pixels only until they are uploaded. The
+// tiles never change after loading, readers keep evicted chunks alive.
+class LevelChunk
+{
+public:
+    LevelChunk(int x, int y);
+    virtual ~LevelChunk();
+
+    int _x, _y;
+    std::vector<Tile> _tiles;
+    std::vector<unsigned char> _radar;
+    int _radarWidth;
+    int _radarHeight;
+    unsigned int _texture;
+    unsigned int _lastUsed;
+};
+
+// Streams a level that is split up in chunks on disk:
+//
+//   radars/<level>/level.txt               "size <w> <h>", "chunk <n>", "ct <x> <y>" and "t <x> <y>" lines
+//   radars/<level>/<cx>_<cy>.png           radar image of the chunk
+//   radars/<level>/<cx>_<cy>-walkable.png  walkable tiles of the chunk
+//
+// Chunks are decoded on a loader thread. Only a fixed number of chunks is
+// kept resident, the least recently used chunk is evicted to make room.
+// Every thread remembers the chunk it read its last tile from, reading more
+// tiles of that chunk takes no lock and does not count as using it.
+class LevelStreamer
+{
+public:
+    LevelStreamer(int maxResidentChunks = LEVEL_MAX_RESIDENT_CHUNKS);
+    virtual ~LevelStreamer();
+
+    int width;
+    int height;
+    int chunkSize;
+    std::vector<LevelSpawn> spawns;
+
+    bool open(const std::string& directory);
+    void close();
+
+    // Returns the tile at the given location, blocks until its chunk is loaded. Safe to call from any thread.
+    Tile tileAt(int x, int y);
+
+    // Requests all chunks overlapping the given tile rectangle without blocking
+    void prefetch(int fromX, int fromY, int toX, int toY);
+
+    // Visits the chunks resident when called, without holding the lock while visiting
+    void visitResident(std::function<void (LevelChunk&)> visitor);
+
+    // Textures of the chunks evicted since the last call, call on the thread visiting the chunks
+    std::vector<unsigned int> takeReleasedTextures();
+
+    int residentCount();
+    int maxResidentChunks() const;
+
+private:
+    std::string _directory;
+    int _maxResidentChunks;
+    int _chunksX, _chunksY;
+    unsigned int _clock;
+    unsigned int _id;
+
+    std::unordered_map<int, std::shared_ptr<LevelChunk> > _resident;
+    std::deque<int> _requests;
+    std::set<int> _requested;
+    std::vector<std::shared_ptr<LevelChunk> > _evicted;
+
+    // Readers waiting for a chunk by key, the chunk is not evicted before they read it
+    std::unordered_map<int, int> _waiting;
+
+    std::mutex _mutex;
+    std::condition_variable _loaded;
+    std::condition_variable _wakeLoader;
+    std::thread _loader;
+    bool _running;
+
+    void request(int key, bool urgent);
+    bool evictLeastRecentlyUsed();
+    void loaderLoop();
+    LevelChunk* loadChunk(int key) const;
+};
+
+#endif // LEVEL_STREAMING_H
@@ -0,0 +1,244 @@
+#include "level.h"
+#include "distance-field.h"
+
+#include "stb_image.h"
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+static float playerScale = LEVEL_TILE_WORLD_SIZE;
+
+Level::Level()
+    : _radarWidth(0), _radarHeight(0), _tiles(nullptr), _streamer(nullptr), width(256), height(256)
+{ }
+
+Level::~Level()
+{
+    delete this->_streamer;
+    if (this->_tiles != nullptr) stbi_image_free(this->_tiles);
+}
+
+LevelTileTypes Level::tile(int x, int y) const
+{
+    if (x < 0 || x >= this->width || y < 0 || y >= this->height) return LevelTileTypes::NonWalkable;
+
+    if (this->_streamer != nullptr) return Level::tileType(this->_streamer->tileAt(x, y));
+    if (this->_tiles == nullptr) return LevelTileTypes::NonWalkable;
+
+    return Level::tileType(this->_tiles[y * this->width + x]);
+}
+
+LevelTileTypes Level::tileType(const Tile& tile)
+{
+    if (tile.rgba[3] == 0) return LevelTileTypes::NonWalkable;
+    if (tile.rgba[0] == 0 && tile.rgba[1] == 255 && tile.rgba[2] == 0) return LevelTileTypes::CounterTerroristSpawn;
+    if (tile.rgba[0] == 255 && tile.rgba[1] == 0 && tile.rgba[2] == 0) return LevelTileTypes::TerroristSpawn;
+    if (tile.rgba[0] == 255 && tile.rgba[1] == 255 && tile.rgba[2] == 0) return LevelTileTypes::NonWalkableButSeeThrough;
+
+    return LevelTileTypes::Walkable;
+}
+
+float Level::wallDistance(int x, int y) const
+{
+    if (x < 0 || x >= this->width || y < 0 || y >= this->height) return 0.0f;
+    if (this->_distance.empty()) return 0.0f;
+
+    return this->_distance[y * this->width + x] / float(DISTANCE_FIELD_UNITS);
+}
+
+bool Level::hasClearance(int x, int y, float clearance) const
+{
+    return this->wallDistance(x, y) >= clearance;
+}
+
+bool Level::isWalkable(int x, int y) const
+{
+    auto type = this->tile(x, y);
+    return (type == LevelTileTypes::Walkable) ||
+            (type == LevelTileTypes::CounterTerroristSpawn) ||
+            (type == LevelTileTypes::TerroristSpawn);
+}
+
+bool Level::isTransparent(int x, int y) const
+{
+    return this->tile(x, y) != LevelTileTypes::NonWalkable;
+}
+
+bool Level::canSee(const tPosition& from, const tPosition& to) const
+{
+    // The visible set rejects some pairs without casting a ray, mostly far apart ones. On de_dust that is a
+    // third of the pairs that cannot see each other, but only one in twenty within LINE_OF_SIGHT_DISTANCE.
+    if (!this->_pvs.potentiallyVisible(from, to)) return false;
+
+    return obj_HasLineOfSight(from, to, [this] (const tPosition& position) {
+        return this->isTransparent(position.x, position.y);
+    });
+}
+
+bool Level::prepare(const std::string& level)
+{
+    this->_name = level;
+
+    std::stringstream streamed;
+    streamed << "radars/" << level;
+
+    auto streamer = new LevelStreamer();
+    if (streamer->open(streamed.str()))
+    {
+        // This level is too big to keep in memory, it is loaded chunk by chunk around the players and the camera
+        this->_streamer = streamer;
+        this->width = streamer->width;
+        this->height = streamer->height;
+        this->_spawns = streamer->spawns;
+        return true;
+    }
+    delete streamer;
+
+    std::stringstream ss;
+    ss << "radars/" << level << ".png";
+
+    int comp;
+    auto radar = stbi_load(ss.str().c_str(), &this->_radarWidth, &this->_radarHeight, &comp, 4);
+    if (radar != nullptr)
+    {
+        this->_radar.assign(radar, radar + (this->_radarWidth * this->_radarHeight * 4));
+        stbi_image_free(radar);
+    }
+    else
+    {
+        this->_radarWidth = this->_radarHeight = 0;
+    }
+
+    this->_tiles = (Tile*)stbi_load(this->walkableFilename().c_str(), &this->width, & this->height, &comp, 4);
+    if (this->_tiles == nullptr) return false;
+
+    for (int y = 0; y < this->height; y++)
+    {
+        for (int x = 0; x < this->width; x++)
+        {
+            auto t = this->tile(x, y);
+            if (t == LevelTileTypes::CounterTerroristSpawn || t == LevelTileTypes::TerroristSpawn)
+            {
+                LevelSpawn spawn = { { x, y }, t };
+                this->_spawns.push_back(spawn);
+            }
+        }
+    }
+
+    this->buildDerivedData();
+
+    return true;
+}
+
+Level* Level::copy() const
+{
+    if (this->_streamer != nullptr) return nullptr;
+
+    auto level = new Level();
+    level->_name = this->_name;
+    level->_spawns = this->_spawns;
+    level->width = this->width;
+    level->height = this->height;
+    level->_distance = this->_distance;
+    level->_pvs = this->_pvs;
+
+    // Allocated the way stb_image does, the level frees its tiles with stbi_image_free
+    if (this->_tiles != nullptr)
+    {
+        level->_tiles = (Tile*)std::malloc(this->width * this->height * sizeof(Tile));
+        std::memcpy(level->_tiles, this->_tiles, this->width * this->height * sizeof(Tile));
+    }
+
+    return level;
+}
+
+std::string Level::walkableFilename() const
+{
+    std::stringstream ss;
+    ss << "radars/" << this->_name << "-walkable.png";
+    return ss.str();
+}
+
+bool Level::reload()
+{
+    // Streamed levels are reloaded chunk by chunk when they are evicted
+    if (this->_streamer != nullptr || this->_tiles == nullptr) return false;
+
+    int width, height, comp;
+    auto tiles = (Tile*)stbi_load(this->walkableFilename().c_str(), &width, &height, &comp, 4);
+    if (tiles == nullptr) return false;
+
+    if (width != this->width || height != this->height)
+    {
+        stbi_image_free(this->_tiles);
+        this->_tiles = tiles;
+        this->width = width;
+        this->height = height;
+        this->buildDerivedData();
+        return true;
+    }
+
+    // Find the rectangle around all changed tiles
+    tPosition from = { width, height }, to = { -1, -1 };
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (std::memcmp(&tiles[y * width + x], &this->_tiles[y * width + x], sizeof(Tile)) == 0) continue;
+
+            from.x = std::min(from.x, x);
+            from.y = std::min(from.y, y);
+            to.x = std::max(to.x, x);
+            to.y = std::max(to.y, y);
+        }
+    }
+
+    stbi_image_free(this->_tiles);
+    this->_tiles = tiles;
+
+    if (to.x < 0) return false;
+
+    this->updateDerivedData(from, to);
+
+    return true;
+}
+
+// Streamed levels are never completely in memory, so they have no distance field and visible set
+void Level::buildDerivedData()
+{
+    this->_distance = obj_GetDistanceField(this->width, this->height, [this] (const tPosition& position) {
+        return !this->isWalkable(position.x, position.y);
+    });
+    this->_pvs.build(this->width, this->height, [this] (const tPosition& position) {
+        return this->isTransparent(position.x, position.y);
+    });
+}
+
+// The tile types are not stored and the paths are searched on the tiles directly, so
+// only the distance field and the visible set have to be rebuilt around the changes
+void Level::updateDerivedData(const tPosition& from, const tPosition& to)
+{
+    obj_UpdateDistanceField(this->_distance, this->width, this->height, [this] (const tPosition& position) {
+        return !this->isWalkable(position.x, position.y);
+    }, from, to);
+    this->_pvs.update([this] (const tPosition& position) {
+        return this->isTransparent(position.x, position.y);
+    }, from, to);
+}
+
+void Level::stream(const glm::vec2& viewMin, const glm::vec2& viewMax, const std::vector<glm::vec3>& focus)
+{
+    if (this->_streamer == nullptr) return;
+
+    // The view goes first, it is what the player is looking at right now
+    this->_streamer->prefetch(int(viewMin.x / playerScale), int(viewMin.y / playerScale),
+                              int(viewMax.x / playerScale), int(viewMax.y / playerScale));
+
+    int radius = this->_streamer->chunkSize / 4;
+    for (auto& pos : focus)
+    {
+        int x = int(pos.x / playerScale), y = int(pos.y / playerScale);
+        this->_streamer->prefetch(x - radius, y - radius, x + radius, y + radius);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+#include "astar.h"
+#include "level-streaming.h"
+#include "visibility.h"
+
+// Size of one tile in world units
+#define LEVEL_TILE_WORLD_SIZE 8.0f
+
+class Level
+{
+public:
+    Level();
+    virtual ~Level();
+
+    // Decoded radar image, kept until a renderer takes it
+    std::vector<unsigned char> _radar;
+    int _radarWidth;
+    int _radarHeight;
+
+    std::string _name;
+    std::vector<LevelSpawn> _spawns;
+    Tile* _tiles;
+    LevelStreamer* _streamer;
+    std::vector<unsigned short> _distance;
+    PotentiallyVisibleSet _pvs;
+    int width;
+    int height;
+
+    // Decodes the level and builds all derived data, safe to call from any thread
+    bool prepare(const std::string& level);
+
+    // Copies everything but the radar image, so many worlds can play on one decoded level.
+    // Returns nullptr for streamed levels, their tiles are never completely in memory.
+    Level* copy() const;
+
+    std::string walkableFilename() const;
+
+    // Reads the walkable tiles from disk again and updates the distance field and the visible set.
+    // The distance field is recomputed around the changed tiles where it can be, the visible set
+    // and levels of another size are built again completely. The spawns are not read again and
+    // nothing is done about the players, their paths or what the world derived from the tiles.
+    // Returns false for streamed levels, when the image cannot be read or when no tile changed.
+    bool reload();
+
+    LevelTileTypes tile(int x, int y) const;
+    static LevelTileTypes tileType(const Tile& tile);
+
+    // Distance in tiles from the center of the given tile to the center of the nearest tile a player cannot walk on
+    float wallDistance(int x, int y) const;
+    bool hasClearance(int x, int y, float clearance) const;
+
+    bool isWalkable(int x, int y) const;
+    bool isTransparent(int x, int y) const;
+    bool canSee(const tPosition& from, const tPosition& to) const;
+
+    // Loads and evicts chunks of a streamed level around the view and the given world locations
+    void stream(const glm::vec2& viewMin, const glm::vec2& viewMax, const std::vector<glm::vec3>& focus);
+
+private:
+    void buildDerivedData();
+    void updateDerivedData(const tPosition& from, const tPosition& to);
+};
+
+#endif // LEVEL_H
@@ -0,0 +1,203 @@
+#include "line-of-sight.h"
+
+#include "visibility.h"
+
+#include <algorithm>
+#include <bit>
+
+static float playerScale = LEVEL_TILE_WORLD_SIZE;
+
+// Bits of the columns in the word that belong to slots before the given slot
+static uint64_t columnsBefore(int slot, int word)
+{
+    if (word < (slot >> 6)) return ~uint64_t(0);
+    if (word > (slot >> 6)) return 0;
+
+    return (uint64_t(1) << (slot & 63)) - 1;
+}
+
+static LineOfSightStats noStats()
+{
+    LineOfSightStats stats = { 0, 0, 0, 0 };
+    return stats;
+}
+
+LineOfSightMatrix::LineOfSightMatrix() : _count(0), _wordsPerRow(0), _valid(false), _lastUpdate(noStats()) { }
+
+LineOfSightMatrix::~LineOfSightMatrix() { }
+
+void LineOfSightMatrix::update(const PlayerStorage& players, const Level& level, const SpatialGrid& grid, JobSystem* jobs)
+{
+    int count = players.size();
+    bool full = !this->_valid || count != this->_count || players._handle != this->_handles || players._team != this->_teams;
+    if (full)
+    {
+        this->reset(count);
+        this->_handles = players._handle;
+        this->_teams = players._team;
+    }
+
+    int words = this->_wordsPerRow;
+    this->_moved.clear();
+    this->_movedBits.assign(words, 0);
+    for (int slot = 0; slot < count; slot++)
+    {
+        bool alive = players._health[slot] > 0.0f;
+        int x = alive ? int(players._posX[slot] / playerScale) : -1;
+        int y = alive ? int(players._posY[slot] / playerScale) : -1;
+        if (!full && x == this->_tileX[slot] && y == this->_tileY[slot]) continue;
+
+        this->_tileX[slot] = x;
+        this->_tileY[slot] = y;
+        this->_moved.push_back(slot);
+        this->_movedBits[slot >> 6] |= uint64_t(1) << (slot & 63);
+    }
+
+    int moved = int(this->_moved.size());
+    this->_previousRows.resize(size_t(moved) * words);
+    this->_jobStats.assign(moved / LINE_OF_SIGHT_GRAIN + 1, noStats());
+    obj_ParallelFor(jobs, 0, moved, LINE_OF_SIGHT_GRAIN, [&] (int from, int to) {
+        auto& stats = this->_jobStats[from / LINE_OF_SIGHT_GRAIN];
+        for (int m = from; m < to; m++) this->checkPairs(m, players, level, grid, stats);
+    });
+
+    // Mirror the bits that changed into the rows of the other players and count who sees whom.
+    // Pairs of two moved players were checked by the one in the lower slot and are mirrored from its row.
+    for (int m = 0; m < moved; m++)
+    {
+        int slot = this->_moved[m];
+        auto row = &this->_bits[size_t(slot) * words];
+        auto previous = &this->_previousRows[size_t(m) * words];
+        auto team = int(players._team[slot]);
+
+        for (int w = 0; w < words; w++)
+        {
+            uint64_t changed = (row[w] ^ previous[w]) & ~(this->_movedBits[w] & columnsBefore(slot, w));
+            while (changed != 0)
+            {
+                int bit = std::countr_zero(changed);
+                changed &= changed - 1;
+
+                int other = w * 64 + bit;
+                bool visible = (row[w] >> bit) & 1;
+                this->set(other, slot, visible);
+                this->_seenBy[team][other] += visible ? 1 : -1;
+                this->_seenBy[int(players._team[other])][slot] += visible ? 1 : -1;
+            }
+        }
+    }
+
+    this->_lastUpdate = noStats();
+    this->_lastUpdate.moved = moved;
+    for (auto& stats : this->_jobStats)
+    {
+        this->_lastUpdate.pairs += stats.pairs;
+        this->_lastUpdate.culled += stats.culled;
+        this->_lastUpdate.rays += stats.rays;
+    }
+}
+
+void LineOfSightMatrix::invalidate()
+{
+    this->_valid = false;
+}
+
+bool LineOfSightMatrix::isValid() const
+{
+    return this->_valid;
+}
+
+bool LineOfSightMatrix::canSee(int slot, int other) const
+{
+    if (slot < 0 || slot >= this->_count || other < 0 || other >= this->_count) return false;
+
+    return (this->_bits[size_t(slot) * this->_wordsPerRow + (other >> 6)] >> (other & 63)) & 1;
+}
+
+bool LineOfSightMatrix::seenByTeam(Teams team, int slot) const
+{
+    if (slot < 0 || slot >= this->_count) return false;
+
+    return this->_seenBy[int(team)][slot] > 0;
+}
+
+int LineOfSightMatrix::size() const
+{
+    return this->_count;
+}
+
+int LineOfSightMatrix::wordsPerRow() const
+{
+    return this->_wordsPerRow;
+}
+
+const uint64_t* LineOfSightMatrix::row(int slot) const
+{
+    return &this->_bits[size_t(slot) * this->_wordsPerRow];
+}
+
+const LineOfSightStats& LineOfSightMatrix::lastUpdate() const
+{
+    return this->_lastUpdate;
+}
+
+void LineOfSightMatrix::reset(int count)
+{
+    this->_count = count;
+    this->_wordsPerRow = (count + 63) / 64;
+    this->_valid = true;
+    this->_bits.assign(size_t(count) * this->_wordsPerRow, 0);
+    this->_tileX.assign(count, -1);
+    this->_tileY.assign(count, -1);
+    for (auto& seenBy : this->_seenBy) seenBy.assign(count, 0);
+}
+
+// Fills in the row of the moved player with the pairs it checks, on any thread
+void LineOfSightMatrix::checkPairs(int moved, const PlayerStorage& players, const Level& level, const SpatialGrid& grid, LineOfSightStats& stats)
+{
+    int slot = this->_moved[moved];
+    int words = this->_wordsPerRow;
+    auto row = &this->_bits[size_t(slot) * words];
+    std::copy(row, row + words, &this->_previousRows[size_t(moved) * words]);
+
+    // Pairs with moved players in lower slots keep their bits until those players mirror them here
+    for (int w = 0; w < words; w++) row[w] &= this->_movedBits[w] & columnsBefore(slot, w);
+    if (this->_tileX[slot] < 0) return;
+
+    // Pairs only change when a player enters another tile, so the distance is between tiles as well
+    float x = players._posX[slot], y = players._posY[slot];
+    float range = (LINE_OF_SIGHT_DISTANCE + 2) * playerScale;
+    int tileX = this->_tileX[slot], tileY = this->_tileY[slot];
+    tPosition from = { tileX, tileY };
+    auto team = players._team[slot];
+
+    grid.visit(x, y, range, [&] (int other) {
+        if (players._team[other] == team || this->_tileX[other] < 0) return true;
+        if (other < slot && ((this->_movedBits[other >> 6] >> (other & 63)) & 1)) return true;
+
+        int dx = this->_tileX[other] - tileX, dy = this->_tileY[other] - tileY;
+        if (dx * dx + dy * dy > LINE_OF_SIGHT_DISTANCE * LINE_OF_SIGHT_DISTANCE) return true;
+        stats.pairs++;
+
+        tPosition to = { this->_tileX[other], this->_tileY[other] };
+        if (!level._pvs.potentiallyVisible(from, to))
+        {
+            stats.culled++;
+            return true;
+        }
+
+        stats.rays++;
+        bool visible = obj_HasLineOfSight(from, to, [&level] (const tPosition& position) {
+            return level.isTransparent(position.x, position.y);
+        });
+        if (visible) row[other >> 6] |= uint64_t(1) << (other & 63);
+        return true;
+    });
+}
+
+void LineOfSightMatrix::set(int slot, int other, bool visible)
+{
+    auto& word = this->_bits[size_t(slot) * this->_wordsPerRow + (other >> 6)];
+    if (visible) word |= uint64_t(1) << (other & 63);
+    else word &= ~(uint64_t(1) << (other & 63));
+}
@@ -0,0 +1,85 @@
+#ifndef LINE_OF_SIGHT_H
+#define LINE_OF_SIGHT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "job-system.h"
+#include "level.h"
+#include "player-storage.h"
+#include "spatial-grid.h"
+
+// Tiles players see at most, between the tiles they are on. Farther pairs are not checked.
+#define LINE_OF_SIGHT_DISTANCE 32
+
+// Moved players whose pairs are checked in one job
+#define LINE_OF_SIGHT_GRAIN 32
+
+typedef struct sLineOfSightStats
+{
+    unsigned int moved;     // Players whose pairs were checked again
+    unsigned int pairs;     // Enemy pairs within the distance
+    unsigned int culled;    // Pairs the visible set rejected without a ray
+    unsigned int rays;      // Lines of sight cast
+} LineOfSightStats;
+
+// Which players see each other, one row of bits per slot. Only enemies are checked, players of
+// one team and dead players are never visible to each other here. The matrix is kept from tick
+// to tick and only the pairs where either player entered another tile or died are checked again,
+// first against the distance, then the potentially visible set and then with a ray over the tiles.
+//
+// The rows of the moved players are filled on the job system, every pair by one of its players.
+// The other rows and the count of players of each team seeing a player are updated afterwards,
+// only where a bit changed.
+class LineOfSightMatrix
+{
+public:
+    LineOfSightMatrix();
+    virtual ~LineOfSightMatrix();
+
+    // Brings the matrix up to date, the grid has to be built over the current positions of the players
+    void update(const PlayerStorage& players, const Level& level, const SpatialGrid& grid, JobSystem* jobs);
+
+    // Checks every pair again in the next update, for example after the tiles of the level changed
+    void invalidate();
+    bool isValid() const;
+
+    bool canSee(int slot, int other) const;
+
+    // Whether any player of the team sees the player in the slot
+    bool seenByTeam(Teams team, int slot) const;
+
+    int size() const;
+    int wordsPerRow() const;
+    const uint64_t* row(int slot) const;
+
+    const LineOfSightStats& lastUpdate() const;
+
+private:
+    int _count;
+    int _wordsPerRow;
+    bool _valid;
+    std::vector<uint64_t> _bits;
+
+    // Who was in every slot in the last update and where, dead players are on no tile
+    std::vector<PlayerHandle> _handles;
+    std::vector<Teams> _teams;
+    std::vector<int> _tileX, _tileY;
+
+    // Players of each team seeing the player in the slot
+    std::vector<int> _seenBy[3];
+
+    // Players checked again in this update, their rows before and as a bit per slot
+    std::vector<int> _moved;
+    std::vector<uint64_t> _previousRows;
+    std::vector<uint64_t> _movedBits;
+    std::vector<LineOfSightStats> _jobStats;
+
+    LineOfSightStats _lastUpdate;
+
+    void reset(int count);
+    void checkPairs(int moved, const PlayerStorage& players, const Level& level, const SpatialGrid& grid, LineOfSightStats& stats);
+    void set(int slot, int other, bool visible);
+};
+
+#endif // LINE_OF_SIGHT_H
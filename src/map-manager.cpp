@@ -0,0 +1,131 @@
+#include "map-manager.h"
+#include "log.h"
+
+#include <sstream>
+
+MapManager::MapManager()
+    : _next(nullptr), _nextRenderer(nullptr), _prepared(false), _failed(false), _staged(false)
+{ }
+
+MapManager::~MapManager()
+{
+    this->cancel();
+}
+
+void MapManager::cancel()
+{
+    if (this->_preloader.joinable()) this->_preloader.join();
+
+    delete this->_nextRenderer;
+    this->_nextRenderer = nullptr;
+    delete this->_next;
+    this->_next = nullptr;
+    this->_prepared = false;
+    this->_failed = false;
+    this->_staged = false;
+}
+
+void MapManager::setRotation(const std::vector<std::string>& rotation)
+{
+    this->cancel();
+    this->_rotation.setMaps(rotation);
+}
+
+const std::vector<std::string>& MapManager::rotation() const
+{
+    return this->_rotation.maps();
+}
+
+const std::string& MapManager::currentMap() const
+{
+    return this->_rotation.current();
+}
+
+const std::string& MapManager::nextMap() const
+{
+    return this->_rotation.next();
+}
+
+LevelRenderer* MapManager::loadCurrent()
+{
+    std::vector<std::string> skipped;
+    auto level = this->_rotation.prepareCurrent(skipped);
+
+    for (auto& name : skipped)
+    {
+        std::stringstream ss;
+        ss << "Could not prepare map " << name << ", skipping it";
+        Log::Current().Warn(ss.str().c_str());
+    }
+
+    if (level == nullptr) return nullptr;
+
+    auto renderer = new LevelRenderer(level);
+    while (!renderer->stage(level->_radarHeight)) { }
+
+    return renderer;
+}
+
+void MapManager::update()
+{
+    // Stop trying when every map of the rotation failed in a row
+    if (this->_rotation.isExhausted()) return;
+
+    if (this->_next == nullptr)
+    {
+        // Every map gets its own level, even when the rotation has only one map
+        this->_next = new Level();
+        this->_prepared = false;
+        this->_failed = false;
+        this->_staged = false;
+
+        auto level = this->_next;
+        auto name = this->nextMap();
+        this->_preloader = std::thread([this, level, name] () {
+            if (level->prepare(name) && MapRotation::isPlayable(*level)) this->_prepared = true;
+            else this->_failed = true;
+        });
+        return;
+    }
+
+    if (this->_failed)
+    {
+        if (this->_preloader.joinable()) this->_preloader.join();
+
+        std::stringstream ss;
+        ss << "Could not prepare map " << this->nextMap() << ", skipping it";
+        Log::Current().Warn(ss.str().c_str());
+
+        delete this->_next;
+        this->_next = nullptr;
+        this->_failed = false;
+        this->_rotation.skipNext();
+        return;
+    }
+
+    if (!this->_prepared || this->_staged) return;
+
+    if (this->_preloader.joinable()) this->_preloader.join();
+
+    if (this->_nextRenderer == nullptr) this->_nextRenderer = new LevelRenderer(this->_next);
+    this->_staged = this->_nextRenderer->stage(MAP_STAGING_ROWS_PER_FRAME);
+}
+
+bool MapManager::isNextReady() const
+{
+    return this->_next != nullptr && this->_prepared && this->_staged;
+}
+
+LevelRenderer* MapManager::takeNext()
+{
+    if (!this->isNextReady()) return nullptr;
+
+    auto renderer = this->_nextRenderer;
+    this->_next = nullptr;
+    this->_nextRenderer = nullptr;
+    this->_prepared = false;
+    this->_staged = false;
+    this->_rotation.advance();
+
+    return renderer;
+}
@@ -0,0 +1,57 @@
+#ifndef MAP_MANAGER_H
+#define MAP_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "level.h"
+#include "map-rotation.h"
+#include "renderer.h"
+
+// Number of radar image rows uploaded per frame while staging the next map
+#define MAP_STAGING_ROWS_PER_FRAME 64
+
+// Runs a rotation of maps. While the current map is played, the next map in the
+// rotation is decoded and its derived data is built on a background thread. After
+// that its radar image is uploaded to the GPU a few rows per frame, so it can be
+// swapped in at the end of the round without a hitch. A map that cannot be prepared or
+// has no spawns for one of the teams is skipped.
+class MapManager
+{
+public:
+    MapManager();
+    virtual ~MapManager();
+
+    void setRotation(const std::vector<std::string>& rotation);
+    const std::vector<std::string>& rotation() const;
+    const std::string& currentMap() const;
+    const std::string& nextMap() const;
+
+    // Loads and stages the current map of the rotation while blocking, skipping the maps that
+    // cannot be played. Returns nullptr when none of them can. The caller takes ownership of
+    // the renderer and of its level.
+    LevelRenderer* loadCurrent();
+
+    // Call once per frame on the GL thread, it drives the preloading of the next map
+    void update();
+
+    bool isNextReady() const;
+
+    // Hands over the preloaded next map and moves the rotation forward, or returns nullptr when it is not ready yet
+    LevelRenderer* takeNext();
+
+private:
+    MapRotation _rotation;
+    Level* _next;
+    LevelRenderer* _nextRenderer;
+    std::thread _preloader;
+    std::atomic<bool> _prepared;
+    std::atomic<bool> _failed;
+    bool _staged;
+
+    void cancel();
+};
+
+#endif // MAP_MANAGER_H
@@ -0,0 +1,89 @@
+#include "map-rotation.h"
+
+static std::string noMap;
+
+MapRotation::MapRotation() : _current(0), _upcoming(0), _failures(0) { }
+
+MapRotation::~MapRotation() { }
+
+void MapRotation::setMaps(const std::vector<std::string>& maps)
+{
+    this->_maps = maps;
+    this->_current = 0;
+    this->_upcoming = maps.empty() ? 0 : 1 % int(maps.size());
+    this->_failures = 0;
+}
+
+const std::vector<std::string>& MapRotation::maps() const
+{
+    return this->_maps;
+}
+
+const std::string& MapRotation::current() const
+{
+    if (this->_maps.empty()) return noMap;
+
+    return this->_maps[this->_current];
+}
+
+const std::string& MapRotation::next() const
+{
+    if (this->_maps.empty()) return noMap;
+
+    return this->_maps[this->_upcoming];
+}
+
+Level* MapRotation::prepareCurrent(std::vector<std::string>& skipped)
+{
+    int count = int(this->_maps.size());
+    for (int tried = 0; tried < count; tried++)
+    {
+        auto level = new Level();
+        if (level->prepare(this->current()) && MapRotation::isPlayable(*level))
+        {
+            this->_upcoming = (this->_current + 1) % count;
+            this->_failures = 0;
+            return level;
+        }
+
+        delete level;
+        skipped.push_back(this->current());
+        this->_current = (this->_current + 1) % count;
+    }
+
+    return nullptr;
+}
+
+void MapRotation::skipNext()
+{
+    if (this->_maps.empty()) return;
+
+    this->_failures++;
+    this->_upcoming = (this->_upcoming + 1) % int(this->_maps.size());
+}
+
+bool MapRotation::isExhausted() const
+{
+    return this->_maps.empty() || this->_failures >= int(this->_maps.size());
+}
+
+void MapRotation::advance()
+{
+    if (this->_maps.empty()) return;
+
+    this->_failures = 0;
+    this->_current = this->_upcoming;
+    this->_upcoming = (this->_current + 1) % int(this->_maps.size());
+}
+
+bool MapRotation::isPlayable(const Level& level)
+{
+    bool counterTerrorists = false, terrorists = false;
+    for (auto& spawn : level._spawns)
+    {
+        if (spawn.type == LevelTileTypes::CounterTerroristSpawn) counterTerrorists = true;
+        else if (spawn.type == LevelTileTypes::TerroristSpawn) terrorists = true;
+    }
+
+    return counterTerrorists && terrorists;
+}
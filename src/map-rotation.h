@@ -0,0 +1,46 @@
+#ifndef MAP_ROTATION_H
+#define MAP_ROTATION_H
+
+#include <string>
+#include <vector>
+
+#include "level.h"
+
+// The maps played one after the other, without anything to render them. A map that cannot be
+// prepared or has no spawns for one of the teams is skipped.
+class MapRotation
+{
+public:
+    MapRotation();
+    virtual ~MapRotation();
+
+    void setMaps(const std::vector<std::string>& maps);
+    const std::vector<std::string>& maps() const;
+    const std::string& current() const;
+    const std::string& next() const;
+
+    // Prepares the current map, or else the first map after it that can be played, which becomes
+    // the current map. Adds the names of the maps it skipped to skipped. Returns nullptr when no
+    // map of the rotation can be played, the caller takes ownership of the level.
+    Level* prepareCurrent(std::vector<std::string>& skipped);
+
+    // The next map could not be prepared, the map after it is next
+    void skipNext();
+
+    // Every map was skipped since a map was last played, there is no use trying again
+    bool isExhausted() const;
+
+    // The next map is played now
+    void advance();
+
+    // A round on a level without spawns for both teams is over as soon as it starts
+    static bool isPlayable(const Level& level);
+
+private:
+    std::vector<std::string> _maps;
+    int _current;
+    int _upcoming;
+    int _failures;
+};
+
+#endif // MAP_ROTATION_H
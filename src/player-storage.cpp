@@ -0,0 +1,303 @@
+#include "player-storage.h"
+
+#include <utility>
+
+PathPool::PathPool() { }
+
+PathPool::~PathPool() { }
+
+PathHandle PathPool::acquire(const std::vector<tPosition>& waypoints)
+{
+    PathHandle path;
+    if (!this->_free.empty())
+    {
+        path = this->_free.back();
+        this->_free.pop_back();
+        this->_waypoints[path] = waypoints;
+        this->_cursors[path] = 0;
+    }
+    else
+    {
+        path = PathHandle(this->_waypoints.size());
+        this->_waypoints.push_back(waypoints);
+        this->_cursors.push_back(0);
+    }
+
+    return path;
+}
+
+void PathPool::release(PathHandle path)
+{
+    if (path == INVALID_PATH_HANDLE) return;
+
+    // Keep the capacity of the waypoints around for the next path using this handle
+    this->_waypoints[path].clear();
+    this->_cursors[path] = 0;
+    this->_free.push_back(path);
+}
+
+void PathPool::clear()
+{
+    this->_waypoints.clear();
+    this->_cursors.clear();
+    this->_free.clear();
+}
+
+bool PathPool::isEmpty(PathHandle path) const
+{
+    if (path == INVALID_PATH_HANDLE) return true;
+
+    return this->_cursors[path] >= int(this->_waypoints[path].size());
+}
+
+bool PathPool::next(PathHandle path, tPosition& waypoint)
+{
+    if (this->isEmpty(path)) return false;
+
+    waypoint = this->_waypoints[path][this->_cursors[path]++];
+    return true;
+}
+
+const std::vector<tPosition>& PathPool::waypoints(PathHandle path) const
+{
+    return this->_waypoints[path];
+}
+
+int PathPool::cursor(PathHandle path) const
+{
+    return this->_cursors[path];
+}
+
+int PathPool::size() const
+{
+    return int(this->_waypoints.size());
+}
+
+void PathPool::writeState(StateWriter& writer) const
+{
+    writer.writeVarint(this->_waypoints.size());
+    for (auto& waypoints : this->_waypoints) writer.writeArray(waypoints);
+    writer.writeArray(this->_cursors);
+    writer.writeArray(this->_free);
+}
+
+bool PathPool::readState(StateReader& reader)
+{
+    // Every path takes at least a byte, a corrupted count must not allocate more paths than that
+    auto count = reader.readVarint();
+    if (reader.failed() || count > reader.remaining()) return false;
+
+    this->_waypoints.resize(size_t(count));
+    for (auto& waypoints : this->_waypoints) reader.readArray(waypoints);
+    reader.readArray(this->_cursors);
+    reader.readArray(this->_free);
+
+    if (reader.failed() || this->_cursors.size() != this->_waypoints.size()) return false;
+
+    for (auto cursor : this->_cursors)
+    {
+        if (cursor < 0) return false;
+    }
+    std::vector<bool> freed(this->_waypoints.size(), false);
+    for (auto path : this->_free)
+    {
+        if (path < 0 || path >= this->size() || freed[path]) return false;
+        freed[path] = true;
+    }
+
+    return true;
+}
+
+PlayerStorage::PlayerStorage() { }
+
+PlayerStorage::~PlayerStorage() { }
+
+PlayerHandle PlayerStorage::add(float x, float y, Teams team, const std::string& name)
+{
+    PlayerHandle handle;
+    if (!this->_freeHandles.empty())
+    {
+        handle = this->_freeHandles.back();
+        this->_freeHandles.pop_back();
+    }
+    else
+    {
+        handle = PlayerHandle(this->_slots.size());
+        this->_slots.push_back(-1);
+    }
+
+    this->_slots[handle] = this->size();
+
+    this->_posX.push_back(x);
+    this->_posY.push_back(y);
+    this->_prevPosX.push_back(x);
+    this->_prevPosY.push_back(y);
+    this->_walkToX.push_back(x);
+    this->_walkToY.push_back(y);
+    this->_dirX.push_back(0.0f);
+    this->_dirY.push_back(-1.0f);
+    this->_health.push_back(1.0f);
+    this->_team.push_back(team);
+    this->_path.push_back(INVALID_PATH_HANDLE);
+    this->_name.push_back(name);
+    this->_handle.push_back(handle);
+
+    return handle;
+}
+
+template <class T>
+static void swapRemove(std::vector<T>& values, int slot)
+{
+    if (slot != int(values.size()) - 1) values[slot] = std::move(values.back());
+    values.pop_back();
+}
+
+void PlayerStorage::remove(PlayerHandle handle)
+{
+    if (!this->isValid(handle)) return;
+
+    int slot = this->_slots[handle];
+    int last = this->size() - 1;
+
+    this->_paths.release(this->_path[slot]);
+
+    swapRemove(this->_posX, slot);
+    swapRemove(this->_posY, slot);
+    swapRemove(this->_prevPosX, slot);
+    swapRemove(this->_prevPosY, slot);
+    swapRemove(this->_walkToX, slot);
+    swapRemove(this->_walkToY, slot);
+    swapRemove(this->_dirX, slot);
+    swapRemove(this->_dirY, slot);
+    swapRemove(this->_health, slot);
+    swapRemove(this->_team, slot);
+    swapRemove(this->_path, slot);
+    swapRemove(this->_name, slot);
+    swapRemove(this->_handle, slot);
+
+    if (slot != last) this->_slots[this->_handle[slot]] = slot;
+    this->_slots[handle] = -1;
+    this->_freeHandles.push_back(handle);
+}
+
+void PlayerStorage::clear()
+{
+    this->_posX.clear();
+    this->_posY.clear();
+    this->_prevPosX.clear();
+    this->_prevPosY.clear();
+    this->_walkToX.clear();
+    this->_walkToY.clear();
+    this->_dirX.clear();
+    this->_dirY.clear();
+    this->_health.clear();
+    this->_team.clear();
+    this->_path.clear();
+    this->_name.clear();
+    this->_handle.clear();
+    this->_paths.clear();
+    this->_slots.clear();
+    this->_freeHandles.clear();
+}
+
+int PlayerStorage::size() const
+{
+    return int(this->_handle.size());
+}
+
+int PlayerStorage::slot(PlayerHandle handle) const
+{
+    if (handle < 0 || handle >= int(this->_slots.size())) return -1;
+
+    return this->_slots[handle];
+}
+
+bool PlayerStorage::isValid(PlayerHandle handle) const
+{
+    return this->slot(handle) >= 0;
+}
+
+void PlayerStorage::setPath(int slot, const std::vector<tPosition>& waypoints)
+{
+    this->_paths.release(this->_path[slot]);
+    this->_path[slot] = waypoints.empty() ? INVALID_PATH_HANDLE : this->_paths.acquire(waypoints);
+}
+
+void PlayerStorage::writeState(StateWriter& writer) const
+{
+    writer.writeArray(this->_posX);
+    writer.writeArray(this->_posY);
+    writer.writeArray(this->_prevPosX);
+    writer.writeArray(this->_prevPosY);
+    writer.writeArray(this->_walkToX);
+    writer.writeArray(this->_walkToY);
+    writer.writeArray(this->_dirX);
+    writer.writeArray(this->_dirY);
+    writer.writeArray(this->_health);
+    writer.writeArray(this->_team);
+    writer.writeArray(this->_path);
+    writer.writeArray(this->_handle);
+    for (auto& name : this->_name) writer.writeString(name);
+    this->_paths.writeState(writer);
+    writer.writeArray(this->_slots);
+    writer.writeArray(this->_freeHandles);
+}
+
+bool PlayerStorage::readState(StateReader& reader)
+{
+    reader.readArray(this->_posX);
+    reader.readArray(this->_posY);
+    reader.readArray(this->_prevPosX);
+    reader.readArray(this->_prevPosY);
+    reader.readArray(this->_walkToX);
+    reader.readArray(this->_walkToY);
+    reader.readArray(this->_dirX);
+    reader.readArray(this->_dirY);
+    reader.readArray(this->_health);
+    reader.readArray(this->_team);
+    reader.readArray(this->_path);
+    reader.readArray(this->_handle);
+    this->_name.resize(this->_handle.size());
+    for (auto& name : this->_name) reader.readString(name);
+    bool valid = this->_paths.readState(reader);
+    reader.readArray(this->_slots);
+    reader.readArray(this->_freeHandles);
+
+    if (!valid || reader.failed()) return false;
+
+    // Every array has to hold exactly one value for every player
+    size_t count = this->_handle.size();
+    bool sizes = this->_posX.size() == count && this->_posY.size() == count &&
+            this->_prevPosX.size() == count && this->_prevPosY.size() == count &&
+            this->_walkToX.size() == count && this->_walkToY.size() == count &&
+            this->_dirX.size() == count && this->_dirY.size() == count &&
+            this->_health.size() == count && this->_team.size() == count && this->_path.size() == count;
+    if (!sizes) return false;
+
+    // The state may come from a replay file, every handle has to lead back to where it came from
+    std::vector<bool> walked(this->_paths.size(), false);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (this->slot(this->_handle[i]) != int(i)) return false;
+
+        auto path = this->_path[i];
+        if (path == INVALID_PATH_HANDLE) continue;
+        if (path < 0 || path >= this->_paths.size() || walked[path]) return false;
+        walked[path] = true;
+    }
+    for (size_t handle = 0; handle < this->_slots.size(); handle++)
+    {
+        int slot = this->_slots[handle];
+        if (slot != -1 && (slot < 0 || slot >= int(count) || this->_handle[slot] != PlayerHandle(handle))) return false;
+    }
+
+    // A free handle given out twice would put two players on it
+    std::vector<bool> freed(this->_slots.size(), false);
+    for (auto handle : this->_freeHandles)
+    {
+        if (handle < 0 || handle >= int(this->_slots.size()) || this->_slots[handle] != -1 || freed[handle]) return false;
+        freed[handle] = true;
+    }
+
+    return true;
+}
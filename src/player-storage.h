@@ -0,0 +1,94 @@
+#ifndef PLAYER_STORAGE_H
+#define PLAYER_STORAGE_H
+
+#include <string>
+#include <vector>
+
+#include "astar.h"
+#include "state-buffer.h"
+
+enum class Teams
+{
+    Teamless,
+    CounterTerrorist,
+    Terrorist,
+};
+
+// Handles stay the same for the lifetime of a player, slots change when other players are removed
+typedef int PlayerHandle;
+#define INVALID_PLAYER_HANDLE (-1)
+
+typedef int PathHandle;
+#define INVALID_PATH_HANDLE (-1)
+
+// Pool of paths, so players only carry a small handle to the waypoints they still have to walk
+class PathPool
+{
+public:
+    PathPool();
+    virtual ~PathPool();
+
+    PathHandle acquire(const std::vector<tPosition>& waypoints);
+    void release(PathHandle path);
+    void clear();
+
+    bool isEmpty(PathHandle path) const;
+    bool next(PathHandle path, tPosition& waypoint);
+    const std::vector<tPosition>& waypoints(PathHandle path) const;
+    int cursor(PathHandle path) const;
+
+    // Number of path handles, the free ones included
+    int size() const;
+
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
+private:
+    std::vector<std::vector<tPosition> > _waypoints;
+    std::vector<int> _cursors;
+    std::vector<PathHandle> _free;
+};
+
+// All player state as a structure of arrays, indexed by slot. The slots of the live
+// players are always packed at the front, removing a player moves the last one in
+// its place. Everything the simulation touches every tick is kept in separate arrays.
+class PlayerStorage
+{
+public:
+    PlayerStorage();
+    virtual ~PlayerStorage();
+
+    std::vector<float> _posX, _posY;
+    std::vector<float> _prevPosX, _prevPosY;
+    std::vector<float> _walkToX, _walkToY;
+    std::vector<float> _dirX, _dirY;
+    std::vector<float> _health;
+    std::vector<Teams> _team;
+    std::vector<PathHandle> _path;
+
+    // Cold data, only needed for the user interface
+    std::vector<std::string> _name;
+    std::vector<PlayerHandle> _handle;
+
+    PathPool _paths;
+
+    PlayerHandle add(float x, float y, Teams team, const std::string& name);
+    void remove(PlayerHandle handle);
+    void clear();
+
+    int size() const;
+    int slot(PlayerHandle handle) const;
+    bool isValid(PlayerHandle handle) const;
+
+    void setPath(int slot, const std::vector<tPosition>& waypoints);
+
+    // Everything, including the free handles, so players added after a restore get the same handles
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
+private:
+    std::vector<int> _slots;
+    std::vector<PlayerHandle> _freeHandles;
+};
+
+#endif // PLAYER_STORAGE_H
@@ -1,329 +1,761 @@
 #include "players.h"
-#include "log.h"
+#include "world.h"
 #include "astar.h"
+#include "avoidance.h"
+#include "bots.h"
+#include "collision.h"
+#include "simd.h"
 
-#include <glm/gtc/type_ptr.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 #include <cmath>
-#include <sstream>
-#include <random>
+#include <algorithm>
+#include <iostream>
 
-Level::Level() : _vbuffer(_shader), _tiles(nullptr), width(256), height(256) { }
+static float playerScale = LEVEL_TILE_WORLD_SIZE;
+static float playerSpeed = 50.0f;
+static float bulletSpeed = 400.0f;
 
-Level::~Level() { }
+Player::Player(PlayerManager* manager, PlayerHandle handle) : _manager(manager), _handle(handle) { }
 
-LevelTileTypes Level::tile(int x, int y) const
+PlayerHandle Player::handle() const
 {
-    if (x < 0 || x >= this->width || y < 0 || y > this->height) return LevelTileTypes::NonWalkable;
-
-    auto tile = this->_tiles[y * this->width + x];
-
-    if (tile.rgba[3] == 0) return LevelTileTypes::NonWalkable;
-    if (tile.rgba[0] == 0 && tile.rgba[1] == 255 && tile.rgba[2] == 0) return LevelTileTypes::CounterTerroristSpawn;
-    if (tile.rgba[0] == 255 && tile.rgba[1] == 0 && tile.rgba[2] == 0) return LevelTileTypes::TerroristSpawn;
-    if (tile.rgba[0] == 255 && tile.rgba[1] == 255 && tile.rgba[2] == 0) return LevelTileTypes::NonWalkableButSeeThrough;
+    return this->_handle;
+}
 
-    return LevelTileTypes::Walkable;
+int Player::slot() const
+{
+    return this->_manager->_storage.slot(this->_handle);
 }
 
-void Level::load(const std::string& level)
+const std::string& Player::name() const
 {
-    this->_shader.compileFromFile("shaders/gl3/vertex.glsl", "shaders/gl3/fragment.glsl");
+    return this->_manager->_storage._name[this->slot()];
+}
 
-    std::stringstream ss;
-    ss << "radars/" << level << ".png";
-    this->_level.setup();
-    this->_level.load(ss.str());
+Teams Player::team() const
+{
+    return this->_manager->_storage._team[this->slot()];
+}
 
-    auto x = this->_level.width();
-    auto y = this->_level.height();
-    this->_vbuffer
-            << PlayerVertex({ {    x, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } })
-            << PlayerVertex({ {    x,    y, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } })
-            << PlayerVertex({ { 0.0f,    y, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } })
-            << PlayerVertex({ { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
-    this->_vbuffer.setup();
+float Player::health() const
+{
+    return this->_manager->_storage._health[this->slot()];
+}
 
-    std::stringstream sss;
-    sss << "radars/" << level << "-walkable.png";
+glm::vec3 Player::pos() const
+{
+    auto slot = this->slot();
+    return glm::vec3(this->_manager->_storage._posX[slot], this->_manager->_storage._posY[slot], 0.0f);
+}
 
-    int comp;
-    this->_tiles = (Tile*)stbi_load(sss.str().c_str(), &this->width, & this->height, &comp, 4);
-    for (int y = 0; y < this->height; y++)
-    {
-        for (int x = 0; x < this->width; x++)
-        {
-            auto t = this->tile(x, y);
-            if (t == LevelTileTypes::CounterTerroristSpawn)
-            {
-                // Counter Terrorist spawn
-                Player::Manager().addPlayer(x, y, Teams::CounterTerrorist);
-            }
-            else if (t == LevelTileTypes::TerroristSpawn)
-            {
-                // Terrorist spawn
-                Player::Manager().addPlayer(x, y, Teams::Terrorist);
-            }
-        }
-    }
+glm::vec3 Player::pos(float alpha) const
+{
+    auto& players = this->_manager->_storage;
+    auto slot = this->slot();
+    return glm::mix(glm::vec3(players._prevPosX[slot], players._prevPosY[slot], 0.0f), glm::vec3(players._posX[slot], players._posY[slot], 0.0f), alpha);
 }
 
-void Level::render(const glm::mat4& proj, const glm::mat4& view)
+glm::vec3 Player::dir() const
 {
-    this->_shader.use();
-    this->_shader.setupMatrices(glm::value_ptr(proj),
-                                glm::value_ptr(view),
-                                glm::value_ptr(glm::mat4(1.0f))
-                                );
-    this->_level.use();
-    this->_vbuffer.render();
+    auto slot = this->slot();
+    return glm::vec3(this->_manager->_storage._dirX[slot], this->_manager->_storage._dirY[slot], 0.0f);
 }
 
-Player::Player() : _team(Teams::Teamless), _health(1.0f), _dir(0.0f, -1.0f, 0.0f) { }
+glm::vec3 Player::walkTo() const
+{
+    auto slot = this->slot();
+    return glm::vec3(this->_manager->_storage._walkToX[slot], this->_manager->_storage._walkToY[slot], 0.0f);
+}
 
-Player::~Player() { }
+bool Player::hasPath() const
+{
+    return !this->_manager->_storage._paths.isEmpty(this->_manager->_storage._path[this->slot()]);
+}
 
-Bullet::Bullet(const Player* gunner) : _deleted(false), _gunner(gunner), _pos(gunner->_pos), _dir(gunner->_dir), _weight(0.2f) { }
+PlayerManager* Player::manager() const
+{
+    return this->_manager;
+}
 
-Bullet::~Bullet() { }
+PlayerManager::PlayerManager(World* world)
+    : _world(world), _playerGrid(playerScale * 2.0f), _playerGridValid(false), _selectedPlayer(nullptr), _avoidance(false), _bots(nullptr), _tickDiff(0.0f)
+{
+    this->buildTickGraph();
+}
 
-PlayerManager& Player::Manager()
+PlayerManager::~PlayerManager()
 {
-    if (PlayerManager::_instance == nullptr) PlayerManager::_instance = new PlayerManager();
+    this->resetPlayers();
+}
 
-    return *PlayerManager::_instance;
+World* PlayerManager::world() const
+{
+    return this->_world;
 }
 
-PlayerManager* PlayerManager::_instance = nullptr;
+Level* PlayerManager::level() const
+{
+    return this->_world->level();
+}
 
-PlayerManager::PlayerManager() : _buffer(_shader), _selectedPlayer(nullptr) { }
+void PlayerManager::resetPlayers()
+{
+    this->_storage.clear();
+    this->_players.clear();
+    this->_views.clear();
+    this->_playerGridValid = false;
+    this->_lineOfSight.invalidate();
+    this->_selectedPlayer = nullptr;
 
-PlayerManager::~PlayerManager() { }
+    this->_bullets.clear();
+    this->_kills.clear();
+}
 
-void PlayerManager::resetPlayers()
+void PlayerManager::spawnPlayers()
 {
-    while (!this->_players.empty())
+    for (auto& spawn : this->level()->_spawns)
     {
-        auto player = *this->_players.begin();
-        this->_players.erase(this->_players.begin());
-        delete player;
+        this->addPlayer(spawn.position.x, spawn.position.y,
+                        spawn.type == LevelTileTypes::CounterTerroristSpawn ? Teams::CounterTerrorist : Teams::Terrorist);
     }
-    this->_selectedPlayer = nullptr;
 }
 
-static float playerScale = 8.0f;
+bool PlayerManager::isRoundOver() const
+{
+    int counterTerrorists = 0, terrorists = 0;
+    for (int i = 0; i < this->_storage.size(); i++)
+    {
+        if (this->_storage._health[i] <= 0.0f) continue;
+        if (this->_storage._team[i] == Teams::CounterTerrorist) counterTerrorists++;
+        else if (this->_storage._team[i] == Teams::Terrorist) terrorists++;
+    }
 
-void PlayerManager::setup()
+    return counterTerrorists == 0 || terrorists == 0;
+}
+
+void PlayerManager::update(float diff)
 {
-    this->_playerTexture.setup();
-    this->_playerTexture.load("player.png");
+    if (this->_bots != nullptr) this->_bots->update(diff);
 
-    this->_selectedPlayerTexture.setup();
-    this->_selectedPlayerTexture.load("selected-player.png");
+    this->_tickDiff = diff;
+    this->_tickGraph.run(this->_world->jobs());
+}
 
-    this->_deadPlayerTexture.setup();
-    this->_deadPlayerTexture.load("dead-player.png");
+void PlayerManager::setBots(BotController* bots)
+{
+    this->_bots = bots;
+}
 
-    this->_bulletTexture.setup();
-    this->_bulletTexture.load("bullet.png");
+BotController* PlayerManager::bots() const
+{
+    return this->_bots;
+}
 
-    this->_shader.compileFromFile("shaders/gl3/vertex.glsl", "shaders/gl3/fragment.glsl");
+// The arrays movement reads and writes, starting at one slot
+typedef struct sMovementArrays
+{
+    float* posX;
+    float* posY;
+    float* prevPosX;
+    float* prevPosY;
+    const float* walkToX;
+    const float* walkToY;
+    float* dirX;
+    float* dirY;
+    const float* health;
+    float* stepX;
+    float* stepY;
+} MovementArrays;
+
+#define MOVEMENT_ARRAY_COUNT 11
+
+// The step four players take towards their waypoint when nobody is in the way
+static void preferredStepLane(const MovementArrays& a, Float4 distance)
+{
+    Float4 todoX = Float4::load(a.walkToX) - Float4::load(a.posX);
+    Float4 todoY = Float4::load(a.walkToY) - Float4::load(a.posY);
+    Float4 todo = Float4::sqrt(todoX * todoX + todoY * todoY);
+    Float4 move = todo > Float4(0.001f);
 
-    this->_buffer
-            << PlayerVertex({ {  playerScale, -playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 0.0f } })
-            << PlayerVertex({ {  playerScale,  playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 1.0f } })
-            << PlayerVertex({ { -playerScale,  playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, {  0.0f, 1.0f } })
-            << PlayerVertex({ { -playerScale, -playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, {  0.0f, 0.0f } });
-    this->_buffer.setup();
+    Float4::select(move, (todoX / todo) * distance, Float4(0.0f)).store(a.stepX);
+    Float4::select(move, (todoY / todo) * distance, Float4(0.0f)).store(a.stepY);
 }
 
-void PlayerManager::update(float diff)
+// Moves four players at once by their step. Players close enough to their waypoint are put on it
+// and left facing the way they did, the returned bits tell which lanes arrived so the caller can
+// give them their next waypoint. Players within reach of it arrive too but keep their step, so a
+// crowd does not have to squeeze onto every waypoint. The math is the same as moving them one by one.
+static int moveLane(const MovementArrays& a, Float4 distance, Float4 reach)
 {
-    float speed = 50.0f;
-    float distanceInThisTick = speed * diff;
+    Float4 posX = Float4::load(a.posX), posY = Float4::load(a.posY);
+    Float4 walkToX = Float4::load(a.walkToX), walkToY = Float4::load(a.walkToY);
+    posX.store(a.prevPosX);
+    posY.store(a.prevPosY);
+
+    Float4 alive = Float4::load(a.health) > Float4(0.0f);
+    Float4 todoX = walkToX - posX, todoY = walkToY - posY;
+    Float4 todo = Float4::sqrt(todoX * todoX + todoY * todoY);
+    Float4 snap = alive & (todo < distance);
+    Float4 arrive = alive & (snap | (todo < reach));
+    Float4 move = Float4::andNot(snap, alive);
+
+    posX = Float4::select(snap, walkToX, Float4::select(move, posX + Float4::load(a.stepX), posX));
+    posY = Float4::select(snap, walkToY, Float4::select(move, posY + Float4::load(a.stepY), posY));
+    posX.store(a.posX);
+    posY.store(a.posY);
+
+    Float4 dirX = posX - walkToX, dirY = posY - walkToY;
+    Float4 length = Float4::sqrt(dirX * dirX + dirY * dirY);
+    Float4 turn = Float4::andNot(arrive, alive & (length > Float4(0.001f)));
+    Float4::select(turn, dirX / length, Float4::load(a.dirX)).store(a.dirX);
+    Float4::select(turn, dirY / length, Float4::load(a.dirY)).store(a.dirY);
+
+    return arrive.bits();
+}
 
-    for (Player* player : this->_players)
+// Calls lane(arrays, slot, count) for every group of Float4::width players, the last few
+// players go through a lane padded with dead players
+template <class TLane>
+void PlayerManager::forEachLane(int from, int to, TLane lane)
+{
+    auto& players = this->_storage;
+    std::vector<float>* arrays[MOVEMENT_ARRAY_COUNT] = {
+        &players._posX, &players._posY, &players._prevPosX, &players._prevPosY, &players._walkToX, &players._walkToY,
+        &players._dirX, &players._dirY, &players._health, &this->_stepX, &this->_stepY
+    };
+
+    int i = from;
+    for (; i + Float4::width <= to; i += Float4::width)
     {
-        if (player->_health <= 0.0f) continue;
+        MovementArrays lanes = {
+            &(*arrays[0])[i], &(*arrays[1])[i], &(*arrays[2])[i], &(*arrays[3])[i], &(*arrays[4])[i], &(*arrays[5])[i],
+            &(*arrays[6])[i], &(*arrays[7])[i], &(*arrays[8])[i], &(*arrays[9])[i], &(*arrays[10])[i]
+        };
+        lane(lanes, i, Float4::width);
+    }
 
-        auto todo = player->_walkTo - player->_pos;
-        if (glm::length(todo) < distanceInThisTick)
-        {
-            player->_pos = player->_walkTo;
-            if (!player->_path.empty())
-            {
-                auto to = player->_path.front();
-                player->_walkTo = glm::vec3(to.x * playerScale, to.y * playerScale, 0.0f);
-                player->_path.pop();
-            }
-        }
-        else if (glm::length(todo) > 0.001f)
-        {
-            player->_pos += glm::normalize(todo) * distanceInThisTick;
-        }
+    if (i < to)
+    {
+        float padded[MOVEMENT_ARRAY_COUNT][Float4::width] = { };
+        for (int array = 0; array < MOVEMENT_ARRAY_COUNT; array++) std::copy(arrays[array]->begin() + i, arrays[array]->begin() + to, padded[array]);
+
+        MovementArrays lanes = {
+            padded[0], padded[1], padded[2], padded[3], padded[4], padded[5], padded[6], padded[7], padded[8], padded[9], padded[10]
+        };
+        lane(lanes, i, to - i);
 
-        auto dir = glm::normalize(player->_pos - player->_walkTo);
-        if (glm::length(dir) > 0.001f) player->_dir = dir;
+        for (int array = 0; array < MOVEMENT_ARRAY_COUNT; array++) std::copy(padded[array], padded[array] + (to - i), arrays[array]->begin() + i);
     }
+}
 
-    float bulletSpeed = 400.0f;
-    for (auto bullet : this->_bullets)
+// Every player decides on its step from where everybody is at the start of the tick, so ranges of players can steer at the same time
+void PlayerManager::steerPlayers(int from, int to)
+{
+    Float4 distance(playerSpeed * this->_tickDiff);
+    this->forEachLane(from, to, [distance] (const MovementArrays& lanes, int, int) {
+        preferredStepLane(lanes, distance);
+    });
+}
+
+// Copies where the players are and how far they moved last tick in the order of the player grid,
+// so the neighbours of a player are read from memory next to each other
+void PlayerManager::gatherNeighbors(int from, int to)
+{
+    auto& players = this->_storage;
+    auto& items = this->_playerGrid.items();
+    for (int k = from; k < to; k++)
     {
-        if (bullet->_deleted) continue;
+        int i = items[k];
+        this->_neighborX[k] = players._posX[i];
+        this->_neighborY[k] = players._posY[i];
+        this->_neighborMoveX[k] = players._posX[i] - players._prevPosX[i];
+        this->_neighborMoveY[k] = players._posY[i] - players._prevPosY[i];
+        this->_neighborAlive[k] = players._health[i] > 0.0f;
+    }
+}
 
-        bullet->_pos += (bullet->_dir * bulletSpeed * diff * -1.0f);
-        auto type = this->_level.tile(int(bullet->_pos.x / playerScale), int(bullet->_pos.y / playerScale));
-        bullet->_deleted = (type == LevelTileTypes::NonWalkable);
+// Bends the steps of the players around their nearest neighbours, see obj_AvoidCollisions. Goes
+// through the players in the order of the player grid, every player only writes its own step.
+void PlayerManager::avoidPlayers(int from, int to)
+{
+    auto& items = this->_playerGrid.items();
+    auto level = this->level();
+    float range = AVOIDANCE_NEIGHBOR_DISTANCE;
 
-        if (!bullet->_deleted)
-        {
-            for (Player* player : this->_players)
+    for (int k = from; k < to; k++)
+    {
+        if (!this->_neighborAlive[k]) continue;
+
+        glm::vec2 position(this->_neighborX[k], this->_neighborY[k]);
+
+        // The nearest neighbours, sorted by distance
+        float distances[AVOIDANCE_MAX_NEIGHBORS];
+        int neighbors[AVOIDANCE_MAX_NEIGHBORS];
+        int count = 0;
+
+        this->_playerGrid.visitCells(position.x, position.y, range, [&] (int first, int last) {
+            for (int j = first; j < last; j++)
             {
-                if (player == bullet->_gunner) continue;
-                if (player->_health <= 0.0f) continue;
-                if (glm::length(player->_pos - bullet->_pos) < playerScale)
+                float dx = this->_neighborX[j] - position.x, dy = this->_neighborY[j] - position.y;
+                float distance = dx * dx + dy * dy;
+                if (distance > range * range || j == k || !this->_neighborAlive[j]) continue;
+                if (count == AVOIDANCE_MAX_NEIGHBORS && distance >= distances[count - 1]) continue;
+
+                int at = count < AVOIDANCE_MAX_NEIGHBORS ? count++ : count - 1;
+                for (; at > 0 && distances[at - 1] > distance; at--)
                 {
-                    player->_health -= bullet->_weight;
-                    bullet->_deleted = true;
-                    break;
+                    distances[at] = distances[at - 1];
+                    neighbors[at] = neighbors[at - 1];
                 }
+                distances[at] = distance;
+                neighbors[at] = j;
             }
+        });
+
+        if (count == 0) continue;
+
+        glm::vec2 positions[AVOIDANCE_MAX_NEIGHBORS], velocities[AVOIDANCE_MAX_NEIGHBORS];
+        for (int n = 0; n < count; n++)
+        {
+            int j = neighbors[n];
+            positions[n] = glm::vec2(this->_neighborX[j], this->_neighborY[j]);
+            velocities[n] = glm::vec2(this->_neighborMoveX[j], this->_neighborMoveY[j]) / this->_tickDiff;
+
+            // Players on exactly the same spot push each other apart, the one later in the grid to the right
+            if (distances[n] == 0.0f) positions[n].x += j > k ? 0.01f : -0.01f;
         }
+
+        int slot = items[k];
+        glm::vec2 velocity = glm::vec2(this->_neighborMoveX[k], this->_neighborMoveY[k]) / this->_tickDiff;
+        glm::vec2 preferred = glm::vec2(this->_stepX[slot], this->_stepY[slot]) / this->_tickDiff;
+
+        auto avoiding = obj_AvoidCollisions(position, velocity, preferred, positions, velocities, count,
+                                            PLAYER_AVOIDANCE_RADIUS, playerSpeed, AVOIDANCE_TIME_HORIZON, this->_tickDiff) * this->_tickDiff;
+
+        // Avoiding other players does not know about walls, never step into one
+        auto step = position + avoiding;
+        if (level != nullptr && !level->isWalkable(int(step.x / playerScale), int(step.y / playerScale))) continue;
+
+        this->_stepX[slot] = avoiding.x;
+        this->_stepY[slot] = avoiding.y;
     }
 }
 
-void PlayerManager::render(const glm::mat4 &proj, const glm::mat4 &view)
+// Players only ever write their own slot here, so ranges of players can move at the same time
+void PlayerManager::movePlayers(int from, int to)
 {
-    this->_level.render(proj, view);
+    Float4 distance(playerSpeed * this->_tickDiff);
+    Float4 reach(this->_avoidance ? PLAYER_ARRIVAL_RADIUS : 0.0f);
 
-    this->_playerTexture.use();
-    for (auto player : this->_players)
+    int arrived[PLAYER_MOVEMENT_BLOCK];
+    for (int block = from; block < to; block += PLAYER_MOVEMENT_BLOCK)
     {
-        if (player->_health <= 0.0f) continue;
+        auto& completed = this->_completedPaths[block / PLAYER_MOVEMENT_BLOCK];
+        completed.clear();
+
+        int count = 0;
+        this->forEachLane(block, std::min(block + PLAYER_MOVEMENT_BLOCK, to), [&] (const MovementArrays& lanes, int slot, int n) {
+            int bits = moveLane(lanes, distance, reach);
+            for (int lane = 0; lane < n; lane++) if (bits & (1 << lane)) arrived[count++] = slot + lane;
+        });
 
-        auto model = glm::translate(glm::mat4(1.0f), player->_pos);
-        if (glm::length(player->_dir) > 0.001f)
+        for (int k = 0; k < count; k++)
         {
-            model = glm::rotate(model, std::atan2(player->_dir.x, player->_dir.y), glm::vec3(0.0f, 0.0f, -1.0f));
+            if (this->advanceWaypoint(arrived[k])) completed.push_back(arrived[k]);
         }
-        this->_shader.setupMatrices(glm::value_ptr(proj),
-                                    glm::value_ptr(view),
-                                    glm::value_ptr(model)
-                                    );
-        this->_buffer.render();
     }
+}
+
+// Second pass over the players that reached their waypoint, few do in any tick.
+// Returns whether the player reached the end of its path, the path is released after the movement.
+bool PlayerManager::advanceWaypoint(int slot)
+{
+    auto& players = this->_storage;
 
-    this->_bulletTexture.use();
-    for (auto bullet : this->_bullets)
+    tPosition to;
+    bool completed = false;
+    if (players._paths.next(players._path[slot], to))
+    {
+        players._walkToX[slot] = to.x * playerScale;
+        players._walkToY[slot] = to.y * playerScale;
+    }
+    else
     {
-        if (bullet->_deleted) continue;
+        completed = players._path[slot] != INVALID_PATH_HANDLE;
+    }
+
+    float dirX = players._posX[slot] - players._walkToX[slot];
+    float dirY = players._posY[slot] - players._walkToY[slot];
+    float length = std::sqrt(dirX * dirX + dirY * dirY);
+    if (length > 0.001f)
+    {
+        players._dirX[slot] = dirX / length;
+        players._dirY[slot] = dirY / length;
+    }
+
+    return completed;
+}
 
-        auto model = glm::translate(glm::mat4(1.0f), bullet->_pos);
-        if (glm::length(bullet->_dir) > 0.001f)
+// The bullet is swept over the whole path it travels in this tick, so it cannot skip over
+// thin walls or players at any timestep. hitAt is the fraction of the path until the first wall.
+void PlayerManager::sweepBulletsAgainstWalls(int from, int to)
+{
+    for (int b = from; b < to; b++)
+    {
+        auto& bullet = this->_bullets[b];
+        auto& step = this->_bulletSteps[b];
+        step.to = bullet._pos + (bullet._dir * bulletSpeed * this->_tickDiff * -1.0f);
+        step.wallAt = 1.0f;
+        step.hitWall = false;
+        step.victim = -1;
+
+        // Far away from walls the distance field tells the path cannot reach one, only close to walls the
+        // tiles along the path are walked. Subtract the distance between the tile centers and their furthest corners.
+        float length = bulletSpeed * this->_tickDiff;
+        float safe = (this->level()->wallDistance(int(bullet._pos.x / playerScale), int(bullet._pos.y / playerScale)) - 1.5f) * playerScale;
+        if (length > safe)
         {
-            model = glm::rotate(model, std::atan2(bullet->_dir.x, bullet->_dir.y), glm::vec3(0.0f, 0.0f, -1.0f));
+            step.hitWall = obj_SweepTiles(bullet._pos.x / playerScale, bullet._pos.y / playerScale, step.to.x / playerScale, step.to.y / playerScale, [this] (const tPosition& position) {
+                return this->level()->tile(position.x, position.y) == LevelTileTypes::NonWalkable;
+            }, step.wallAt);
         }
-        this->_shader.setupMatrices(glm::value_ptr(proj),
-                                    glm::value_ptr(view),
-                                    glm::value_ptr(model)
-                                    );
-        this->_buffer.render();
     }
+}
+
+void PlayerManager::sweepBulletsAgainstPlayers(int from, int to)
+{
+    for (int b = from; b < to; b++) this->findVictim(b);
+}
 
-    if (this->_selectedPlayer != nullptr && this->_selectedPlayer->_health > 0.0f)
+// Only the players in the cells around the path can be hit, the first living one along the path before the wall is
+void PlayerManager::findVictim(int b)
+{
+    auto& players = this->_storage;
+    auto& bullet = this->_bullets[b];
+    auto& step = this->_bulletSteps[b];
+
+    auto from = bullet._pos;
+    float hitAt = step.wallAt;
+    float centerX = (from.x + step.to.x) * 0.5f, centerY = (from.y + step.to.y) * 0.5f;
+    float radius = bulletSpeed * this->_tickDiff * 0.5f + playerScale;
+
+    step.victim = -1;
+    this->_playerGrid.visit(centerX, centerY, radius, [&] (int i) {
+        if (players._handle[i] == bullet._gunner) return true;
+        if (players._health[i] <= 0.0f) return true;
+
+        float t;
+        if (obj_SweepCircle(from.x, from.y, step.to.x, step.to.y, players._posX[i], players._posY[i], playerScale, t) && t <= hitAt)
+        {
+            hitAt = t;
+            step.victim = i;
+        }
+        return true;
+    });
+}
+
+// Hits are applied in bullet order on one thread, which keeps the outcome the same for any number of threads
+void PlayerManager::applyBullets()
+{
+    auto& players = this->_storage;
+    auto& events = this->_world->events();
+    auto tick = this->_world->tick();
+    for (int b = 0; b < this->_bullets.size(); b++)
     {
-        this->_selectedPlayerTexture.use();
-        this->_shader.setupMatrices(glm::value_ptr(proj),
-                                    glm::value_ptr(view),
-                                    glm::value_ptr(glm::translate(glm::mat4(1.0f), this->_selectedPlayer->_pos))
-                                    );
-        this->_buffer.render();
+        auto& bullet = this->_bullets[b];
+        auto& step = this->_bulletSteps[b];
+
+        // The victim was killed by an earlier bullet in this tick, the bullet flies on to whoever is behind
+        if (step.victim >= 0 && players._health[step.victim] <= 0.0f) this->findVictim(b);
+
+        if (step.victim >= 0)
+        {
+            int victim = step.victim;
+            glm::vec3 pos(players._posX[victim], players._posY[victim], 0.0f);
+            players._health[victim] -= bullet._weight;
+            events.publish(GameEventTypes::PlayerHit, tick, bullet._gunner, players._handle[victim], pos, bullet._weight);
+            if (players._health[victim] <= 0.0f)
+            {
+                PlayerKill kill = { bullet._gunner, players._handle[victim], pos };
+                this->_kills.push_back(kill);
+                events.publish(GameEventTypes::PlayerKilled, tick, bullet._gunner, players._handle[victim], pos);
+            }
+        }
+
+        bullet._prevPos = bullet._pos;
+        bullet._pos = step.to;
     }
 
-    this->_deadPlayerTexture.use();
-    for (auto player : this->_players)
+    // Killing from the back only ever moves bullets that stay alive
+    for (int b = this->_bullets.size() - 1; b >= 0; b--)
     {
-        if (player->_health > 0.0f) continue;
-
-        this->_shader.setupMatrices(glm::value_ptr(proj),
-                                    glm::value_ptr(view),
-                                    glm::value_ptr(glm::translate(glm::mat4(1.0f), player->_pos))
-                                    );
-        this->_buffer.render();
+        if (this->_bulletSteps[b].victim >= 0 || this->_bulletSteps[b].hitWall) this->_bullets.kill(b);
     }
 }
 
+void PlayerManager::buildTickGraph()
+{
+    // Steering looks at the players where they are before anybody moves
+    auto steering = this->_tickGraph.add("steering", [this] () {
+        int count = this->_storage.size();
+        this->_stepX.resize(count);
+        this->_stepY.resize(count);
+        obj_ParallelFor(this->_world->jobs(), 0, count, PLAYER_MOVEMENT_GRAIN, [this] (int from, int to) {
+            this->steerPlayers(from, to);
+        });
+
+        if (!this->_avoidance || count < 2 || this->_tickDiff <= 0.0f) return;
+
+        this->playerGrid();
+        this->_neighborX.resize(count);
+        this->_neighborY.resize(count);
+        this->_neighborMoveX.resize(count);
+        this->_neighborMoveY.resize(count);
+        this->_neighborAlive.resize(count);
+        obj_ParallelFor(this->_world->jobs(), 0, count, PLAYER_MOVEMENT_GRAIN, [this] (int from, int to) {
+            this->gatherNeighbors(from, to);
+        });
+        obj_ParallelFor(this->_world->jobs(), 0, count, PLAYER_AVOIDANCE_GRAIN, [this] (int from, int to) {
+            this->avoidPlayers(from, to);
+        });
+    });
+
+    auto movement = this->_tickGraph.add("movement", [this] () {
+        int count = this->_storage.size();
+        this->_completedPaths.resize((count + PLAYER_MOVEMENT_BLOCK - 1) / PLAYER_MOVEMENT_BLOCK);
+        obj_ParallelFor(this->_world->jobs(), 0, count, PLAYER_MOVEMENT_GRAIN, [this] (int from, int to) {
+            this->movePlayers(from, to);
+        });
+        this->_playerGridValid = false;
+
+        auto& players = this->_storage;
+        for (auto& completed : this->_completedPaths)
+        {
+            for (auto slot : completed)
+            {
+                players.setPath(slot, std::vector<tPosition>());
+                glm::vec3 pos(players._posX[slot], players._posY[slot], 0.0f);
+                this->_world->events().publish(GameEventTypes::PathCompleted, this->_world->tick(), players._handle[slot], INVALID_PLAYER_HANDLE, pos);
+            }
+        }
+    }, { steering });
+
+    // Walls do not move, bullets are swept against them while the players move
+    auto walls = this->_tickGraph.add("bullets-walls", [this] () {
+        this->_bulletSteps.resize(this->_bullets.size());
+        obj_ParallelFor(this->_world->jobs(), 0, this->_bullets.size(), BULLET_SWEEP_GRAIN, [this] (int from, int to) {
+            this->sweepBulletsAgainstWalls(from, to);
+        });
+    });
+
+    // Only bullets need the grid during the tick, otherwise it is built when somebody asks for it
+    auto grid = this->_tickGraph.add("player-grid", [this] () {
+        if (this->_bullets.size() > 0) this->playerGrid();
+    }, { movement });
+
+    auto hits = this->_tickGraph.add("bullets-players", [this] () {
+        obj_ParallelFor(this->_world->jobs(), 0, this->_bullets.size(), BULLET_SWEEP_GRAIN, [this] (int from, int to) {
+            this->sweepBulletsAgainstPlayers(from, to);
+        });
+    }, { walls, grid });
+
+    this->_tickGraph.add("bullets-apply", [this] () {
+        this->applyBullets();
+    }, { hits });
+}
+
 Player* PlayerManager::addPlayer(int x, int y, Teams team)
 {
-    static std::default_random_engine generator;
-    static std::uniform_int_distribution<int> distribution(0, PLAYER_NAME_COUNT);
+    auto pos = PlayerManager::levelToWorldLocation(x, y);
+    auto handle = this->_storage.add(pos.x, pos.y, team, playerNames[this->_world->random().range(0, PLAYER_NAME_COUNT - 1)]);
 
-    auto player = new Player();
+    // Handles are reused after a player is removed, and so is their view
+    while (int(this->_views.size()) <= handle) this->_views.push_back(Player(this, PlayerHandle(this->_views.size())));
 
-    player->_name = playerNames[distribution(generator)];
-    player->_pos = player->_walkTo = PlayerManager::levelToWorldLocation(x, y);
-    player->_team = team;
+    auto player = &this->_views[handle];
+    this->_players.push_back(player);
+    this->_playerGridValid = false;
 
-    this->_players.insert(player);
     return player;
 }
 
+void PlayerManager::removePlayer(Player* player)
+{
+    if (player == nullptr || !this->_storage.isValid(player->handle())) return;
+
+    if (this->_selectedPlayer == player) this->_selectedPlayer = nullptr;
+
+    // Mirror the swap with the last slot the storage does
+    int slot = player->slot();
+    this->_players[slot] = this->_players.back();
+    this->_players.pop_back();
+    this->_storage.remove(player->handle());
+    this->_playerGridValid = false;
+}
+
+Player* PlayerManager::player(PlayerHandle handle)
+{
+    if (!this->_storage.isValid(handle)) return nullptr;
+
+    return &this->_views[handle];
+}
+
 void PlayerManager::selectPlayer(Player* player)
 {
     this->_selectedPlayer = player;
 }
 
-void PlayerManager::clickAt(int x, int y)
+std::vector<Player*> PlayerManager::playersInRadius(const glm::vec3& pos, float radius)
+{
+    std::vector<Player*> result;
+    for (auto slot : this->playerGrid().query(this->_storage._posX, this->_storage._posY, pos.x, pos.y, radius))
+    {
+        result.push_back(this->_players[slot]);
+    }
+
+    return result;
+}
+
+void PlayerManager::writeState(StateWriter& writer) const
+{
+    this->_storage.writeState(writer);
+    this->_bullets.writeState(writer);
+    writer.writeArray(this->_kills);
+    writer.writeSigned(this->_selectedPlayer != nullptr ? this->_selectedPlayer->handle() : INVALID_PLAYER_HANDLE);
+    writer.writeVarint(this->_avoidance ? 1 : 0);
+    if (this->_bots != nullptr) this->_bots->writeState(writer);
+}
+
+bool PlayerManager::readState(StateReader& reader)
 {
-    std::set<Player*> selection;
+    bool valid = this->_storage.readState(reader) && this->_bullets.readState(reader) && reader.readArray(this->_kills);
+    auto selected = PlayerHandle(reader.readSigned());
+    bool avoidance = reader.readVarint() != 0;
+    if (valid && this->_bots != nullptr) valid = this->_bots->readState(reader);
+    if (!valid || reader.failed())
+    {
+        this->resetPlayers();
+        return false;
+    }
 
-    for (Player* player : this->_players)
+    // Views are only ever added, so pointers held by the user interface keep pointing at the same handle
+    this->_players.clear();
+    for (auto handle : this->_storage._handle)
     {
-        if (glm::length(player->_pos - glm::vec3(x, y, 0)) < playerScale) selection.insert(player);
+        // Checked by the storage already, a handle outside the slots would grow the views without bound
+        if (!this->_storage.isValid(handle))
+        {
+            this->resetPlayers();
+            return false;
+        }
+        while (int(this->_views.size()) <= handle) this->_views.push_back(Player(this, PlayerHandle(this->_views.size())));
+        this->_players.push_back(&this->_views[handle]);
     }
 
+    this->_selectedPlayer = this->player(selected);
+    this->_avoidance = avoidance;
+    this->_playerGridValid = false;
+    this->_lineOfSight.invalidate();
+
+    return true;
+}
+
+const SpatialGrid& PlayerManager::playerGrid()
+{
+    if (!this->_playerGridValid)
+    {
+        this->_playerGrid.build(this->_storage._posX, this->_storage._posY);
+        this->_playerGridValid = true;
+    }
+
+    return this->_playerGrid;
+}
+
+const LineOfSightMatrix& PlayerManager::lineOfSight()
+{
+    auto level = this->level();
+    if (level != nullptr) this->_lineOfSight.update(this->_storage, *level, this->playerGrid(), this->_world->jobs());
+
+    return this->_lineOfSight;
+}
+
+void PlayerManager::clickAt(int x, int y)
+{
+    auto selection = this->playersInRadius(glm::vec3(x, y, 0.0f), playerScale);
+
     if (selection.size() > 0)
     {
-        auto found = selection.find(this->_selectedPlayer);
+        auto found = std::find(selection.begin(), selection.end(), this->_selectedPlayer);
 
         this->_selectedPlayer = *(found != selection.end() && ++found != selection.end() ? found : selection.begin());
-        std::cout << this->_selectedPlayer->_name << std::endl;
+        std::cout << this->_selectedPlayer->name() << std::endl;
     }
     else if (this->_selectedPlayer != nullptr)
     {
-        auto target = this->_level.tile(x / playerScale, y / playerScale);
+        auto target = this->level()->tile(x / playerScale, y / playerScale);
         if (target == LevelTileTypes::Walkable)
         {
             tPosition to = { int(x / playerScale), int(y / playerScale) };
-            tPosition from = { int(this->_selectedPlayer->_pos.x / playerScale), int(this->_selectedPlayer->_pos.y / playerScale) };
-            this->_selectedPlayer->_path = obj_GetAStarPath(from, to, [this] (const tPosition& position) {
-                auto type = this->_level.tile(position.x, position.y);
-                return (type == LevelTileTypes::Walkable) ||
-                        (type == LevelTileTypes::CounterTerroristSpawn) ||
-                        (type == LevelTileTypes::TerroristSpawn);
-            });
+            this->walkTo(this->_selectedPlayer, to);
         }
     }
 }
 
+void PlayerManager::walkTo(Player* player, const tPosition& to)
+{
+    if (player == nullptr) return;
+
+    auto& players = this->_storage;
+    int slot = player->slot();
+    tPosition from = { int(players._posX[slot] / playerScale), int(players._posY[slot] / playerScale) };
+    auto path = obj_GetAStarPath(from, to, [this] (const tPosition& position) {
+        return this->level()->isWalkable(position.x, position.y);
+    });
+
+    std::vector<tPosition> waypoints;
+    for (; !path.empty(); path.pop()) waypoints.push_back(path.front());
+    players.setPath(slot, waypoints);
+}
+
+void PlayerManager::walkAlong(Player* player, const std::vector<tPosition>& waypoints)
+{
+    if (player == nullptr) return;
+
+    this->_storage.setPath(player->slot(), waypoints);
+}
+
 void PlayerManager::shoot()
 {
     if (this->_selectedPlayer != nullptr)
     {
-        for (auto bullet : this->_bullets)
-        {
-            if (bullet->_deleted)
-            {
-                bullet->_deleted = false;
-                bullet->_dir = this->_selectedPlayer->_dir;
-                bullet->_pos = this->_selectedPlayer->_pos;
-                return;
-            }
-        }
+        this->_bullets.spawn(this->_selectedPlayer->handle(), this->_selectedPlayer->pos(), this->_selectedPlayer->dir());
+        this->_world->events().publish(GameEventTypes::BulletFired, this->_world->tick(), this->_selectedPlayer->handle(), INVALID_PLAYER_HANDLE, this->_selectedPlayer->pos());
+    }
+}
 
-        // When we reach this point in code, no available bullet is found, and we are making a new one
-        this->_bullets.insert(new Bullet(this->_selectedPlayer));
+void PlayerManager::shootAt(Player* gunner, const glm::vec3& target)
+{
+    if (gunner == nullptr || gunner->health() <= 0.0f) return;
+
+    // Bullets fly against the direction a player faces
+    auto dir = gunner->pos() - target;
+    float length = std::sqrt(dir.x * dir.x + dir.y * dir.y);
+    if (length < 0.001f) return;
+
+    int slot = gunner->slot();
+    this->_storage._dirX[slot] = dir.x / length;
+    this->_storage._dirY[slot] = dir.y / length;
+    this->_bullets.spawn(gunner->handle(), gunner->pos(), gunner->dir());
+    this->_world->events().publish(GameEventTypes::BulletFired, this->_world->tick(), gunner->handle(), INVALID_PLAYER_HANDLE, gunner->pos());
+}
+
+void PlayerManager::streamLevel(const glm::vec2& viewMin, const glm::vec2& viewMax)
+{
+    std::vector<glm::vec3> focus;
+    for (int i = 0; i < this->_storage.size(); i++)
+    {
+        if (this->_storage._health[i] > 0.0f) focus.push_back(glm::vec3(this->_storage._posX[i], this->_storage._posY[i], 0.0f));
     }
+    this->level()->stream(viewMin, viewMax, focus);
 }
 
 glm::vec3 PlayerManager::levelToWorldLocation(int x, int y)
@@ -2,129 +2,182 @@
 #define PLAYERS_H
 
 #include <glm/glm.hpp>
-#include <set>
-#include <queue>
+#include <deque>
+#include <vector>
 
 #include "astar.h"
-#include "stb_image.h"
-#include <gl.utilities.textures.h>
-#include <gl.utilities.vertexbuffers.h>
+#include "level.h"
+#include "player-storage.h"
+#include "bullet-pool.h"
+#include "job-system.h"
+#include "line-of-sight.h"
+#include "spatial-grid.h"
 
 #define PLAYER_NAME_COUNT 32
 
-typedef Vertex<glm::vec3, glm::vec3, glm::vec2> PlayerVertex;
-typedef Shader<glm::vec3, glm::vec3, glm::vec2> PlayerShader;
-typedef VertexBuffer<glm::vec3, glm::vec3, glm::vec2> PlayerVertexBuffer;
-
-typedef struct sTile
-{
-    unsigned char rgba[4];
-} Tile;
-
-enum class LevelTileTypes
-{
-    NonWalkable,
-    Walkable,
-    NonWalkableButSeeThrough,
-    CounterTerroristSpawn,
-    TerroristSpawn
-};
-
-class Level
+// Thin view on a player in the PlayerManager, the player state itself lives in its PlayerStorage
+class Player
 {
 public:
-    Level();
-    virtual ~Level();
+    Player(class PlayerManager* manager, PlayerHandle handle);
 
-    Texture _level;
-    PlayerShader _shader;
-    PlayerVertexBuffer _vbuffer;
+    PlayerHandle handle() const;
+    int slot() const;
 
-    Tile* _tiles;
-    int width;
-    int height;
+    const std::string& name() const;
+    Teams team() const;
+    float health() const;
+    glm::vec3 pos() const;
 
-    void load(const std::string& level);
-    LevelTileTypes tile(int x, int y) const;
+    // Where the player is drawn, alpha of the way from the previous tick to the current one
+    glm::vec3 pos(float alpha) const;
+    glm::vec3 dir() const;
+    glm::vec3 walkTo() const;
+    bool hasPath() const;
 
-    void render(const glm::mat4& proj, const glm::mat4& view);
-};
+    class PlayerManager* manager() const;
 
-enum class Teams
-{
-    Teamless,
-    CounterTerrorist,
-    Terrorist,
+private:
+    class PlayerManager* _manager;
+    PlayerHandle _handle;
 };
 
-class Player
-{
-public:
-    Player();
-    virtual ~Player();
+// Players moved and bullets swept by one job of the tick
+#define PLAYER_MOVEMENT_GRAIN 1024
+#define PLAYER_AVOIDANCE_GRAIN 256
+#define BULLET_SWEEP_GRAIN 256
 
-    Teams _team;
-    std::string _name;
-    float _health;
+// Players moved before the ones that reached their waypoint are given the next one
+#define PLAYER_MOVEMENT_BLOCK 256
 
-    glm::vec3 _dir;
-    glm::vec3 _pos;
-    glm::vec3 _walkTo;
-    std::queue<tPosition> _path;
+// Players keep this far apart and look around this far for others to avoid
+#define PLAYER_AVOIDANCE_RADIUS (LEVEL_TILE_WORLD_SIZE * 0.45f)
+#define AVOIDANCE_NEIGHBOR_DISTANCE (LEVEL_TILE_WORLD_SIZE * 3.0f)
 
-public:
-    static class PlayerManager& Manager();
-};
+// Avoiding players push each other off their waypoints, in a crowd they take the next one this close to it
+#define PLAYER_ARRIVAL_RADIUS (LEVEL_TILE_WORLD_SIZE * 2.0f)
 
-class Bullet
+// Where a bullet ends up in this tick and what it hits on the way
+typedef struct sBulletStep
 {
-public:
-    Bullet(const Player* gunner);
-    virtual ~Bullet();
-
-    const Player* _gunner;
-    bool _deleted;
-    glm::vec3 _pos;
-    glm::vec3 _dir;
-    float _weight;
-};
+    glm::vec3 to;
+    float wallAt;
+    bool hitWall;
+    int victim;
+} BulletStep;
 
-class PlayerManager
+typedef struct sPlayerKill
 {
-    Texture _playerTexture;
-    Texture _selectedPlayerTexture;
-    Texture _deadPlayerTexture;
-    Texture _bulletTexture;
-    PlayerShader _shader;
-    PlayerVertexBuffer _buffer;
+    PlayerHandle killer;
+    PlayerHandle victim;
+    glm::vec3 pos;
+} PlayerKill;
 
+// The players and bullets of one World and the rules they play by, rendering lives in the PlayerRenderer
+class PlayerManager
+{
     static std::string playerNames[PLAYER_NAME_COUNT];
 
-    friend class Player;
-    static PlayerManager* _instance;
+    class World* _world;
 public:
-    PlayerManager();
+    PlayerManager(class World* world);
     virtual ~PlayerManager();
 
+    class World* world() const;
+    Level* level() const;
+
     void resetPlayers();
-    void setup();
+    void spawnPlayers();
+    bool isRoundOver() const;
+
+    // Advances the simulation one tick of the given length. Lets the bots think first, then runs
+    // the passes of the tick graph, on the job system of the world when it has one.
     void update(float diff);
-    void render(const glm::mat4& proj, const glm::mat4& view);
+
+    // Plays the players that are not selected with the bots, their state is part of the players state.
+    // The bots are not owned, nullptr leaves every player to commands.
+    void setBots(class BotController* bots);
+    class BotController* bots() const;
 
     Player* addPlayer(int x, int y, Teams team);
+    void removePlayer(Player* player);
+    Player* player(PlayerHandle handle);
     void selectPlayer(Player* player);
 
+    // Players within the radius around the world location, in slot order
+    std::vector<Player*> playersInRadius(const glm::vec3& pos, float radius);
+    const SpatialGrid& playerGrid();
+
+    // Which enemies see each other where the players are now, only the pairs of players that
+    // moved since it was last asked for are checked again. Call it outside of parallel work.
+    const LineOfSightMatrix& lineOfSight();
+
+    // Selects the player at the world location, or walks the selected player there
     void clickAt(int x, int y);
     void shoot();
 
+    // Orders for one player, given by the user through the calls above and by bots directly.
+    // walkTo searches the path right away, walkAlong takes one searched elsewhere.
+    void walkTo(Player* player, const tPosition& to);
+    void walkAlong(Player* player, const std::vector<tPosition>& waypoints);
+
+    // Turns the gunner towards the target and fires a bullet at it
+    void shootAt(Player* gunner, const glm::vec3& target);
+    void streamLevel(const glm::vec2& viewMin, const glm::vec2& viewMax);
+
+    // Players, paths, bullets, kills and the selection. Views stay valid across a restore.
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
     static glm::vec3 levelToWorldLocation(int x, int y);
     static glm::vec3 worldToLevelLocation(int x, int y);
 
-    std::set<Player*> _players;
-    Player* _selectedPlayer;
-    std::set<Bullet*> _bullets;
+    PlayerStorage _storage;
+
+    // Views on the players, _players is in slot order and _views is indexed by handle
+    std::vector<Player*> _players;
+    std::deque<Player> _views;
 
-    Level _level;
+    // Rebuilt when players moved, were added or removed
+    SpatialGrid _playerGrid;
+    bool _playerGridValid;
+    LineOfSightMatrix _lineOfSight;
+    Player* _selectedPlayer;
+    BulletPool _bullets;
+
+    // Every kill since the players were reset, in the order they happened
+    std::vector<PlayerKill> _kills;
+
+    // Players steer around each other instead of walking through each other. Off unless asked for,
+    // finding the neighbours makes the update of many players spread over a level twenty times slower.
+    bool _avoidance;
+
+    // Movement and bullets as passes with their dependencies
+    FrameGraph _tickGraph;
+
+private:
+    class BotController* _bots;
+    float _tickDiff;
+    std::vector<float> _stepX, _stepY;
+    std::vector<float> _neighborX, _neighborY, _neighborMoveX, _neighborMoveY;
+    std::vector<char> _neighborAlive;
+    std::vector<BulletStep> _bulletSteps;
+
+    // Players that finished their path in this tick, one list per movement block so the blocks can move at the same time
+    std::vector<std::vector<int> > _completedPaths;
+
+    void buildTickGraph();
+    template <class TLane>
+    void forEachLane(int from, int to, TLane lane);
+    void steerPlayers(int from, int to);
+    void gatherNeighbors(int from, int to);
+    void avoidPlayers(int from, int to);
+    void movePlayers(int from, int to);
+    bool advanceWaypoint(int slot);
+    void sweepBulletsAgainstWalls(int from, int to);
+    void sweepBulletsAgainstPlayers(int from, int to);
+    void findVictim(int bullet);
+    void applyBullets();
 };
 
 #endif // PLAYERS_H
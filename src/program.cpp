@@ -5,8 +5,14 @@
 #include "input.h"
 #include "ui/ui.h"
 #include "log.h"
+#include "bots.h"
 #include "players.h"
+#include "world.h"
+#include "replay.h"
+#include "renderer.h"
 #include "font-icons.h"
+#include "file-watcher.h"
+#include "map-manager.h"
 
 #include "nanovg.h"
 #ifdef _WIN32
@@ -21,6 +27,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
 
 #include "stb_image.h"
 #include <gl.utilities.textures.h>
@@ -47,13 +54,33 @@ public:
     void handleInput();
 
     virtual bool SetUp();
+    virtual void Update(float tickLength);
     virtual void Render();
     virtual void CleanUp();
     virtual void OnResize(int width, int height);
 
     void moveCameraTo(Player* player);
+    void reloadChangedLevel();
+    void rotateMapAtRoundEnd();
+    void createPlayerButtons();
+    void handleEvents();
+    void changeLevel(LevelRenderer* map);
+    void execute(const Command& command);
 
     NVGcontext* vg;
+    FileWatcher _levelWatcher;
+    JobSystem _jobs;
+    World _world;
+    BotController _bots;
+    ReplayRecorder _recorder;
+    MapManager _maps;
+    LevelRenderer* _levelRenderer;
+    PlayerRenderer _playerRenderer;
+    FogOfWar _fog;
+    FogRenderer _fogRenderer;
+    std::vector<PlayerButton*> _playerButtons;
+    GameEventCursor _eventCursor;
+    std::vector<GameEvent> _events;
 
     glm::mat4 _proj, _view;
     glm::vec3 _pos;
@@ -68,10 +95,16 @@ public:
 static auto lastUIUpdateTime = 0.0f;
 
 Program::Program(int width, int height)
-    : SDLProgram(width, height), vg(nullptr), _target(nullptr),
+    : SDLProgram(width, height), vg(nullptr), _bots(&_world), _levelRenderer(nullptr), _eventCursor(0), _target(nullptr),
       _currentInputState(InputStates::Idle),
       _motionHandle(0), _startPanningHandle(0), _shootHandle(0)
-{ }
+{
+    this->_world.setJobSystem(&this->_jobs);
+    this->_world.players().setBots(&this->_bots);
+
+    // A match has few enough players to steer them around each other
+    this->_world.players()._avoidance = true;
+}
 
 bool Program::SetUp()
 {
@@ -107,6 +140,15 @@ bool Program::SetUp()
         return false;
     }
 
+    // "--tick-rate <n>" lowers or raises the simulation rate, rendering is not affected
+    // "--record <file>" records a replay of the first round
+    std::string replayFilename;
+    for (size_t i = 0; i + 1 < this->args.size(); i++)
+    {
+        if (this->args[i] == "--tick-rate") this->timestep.setTickRate(std::atoi(this->args[i + 1].c_str()));
+        else if (this->args[i] == "--record") replayFilename = this->args[i + 1];
+    }
+
     this->_motionHandle = this->input()->getAnalogActionHandle("motion");
     this->_startPanningHandle = this->input()->getDigitalActionHandle("start_panning");
     this->_shootHandle = this->input()->getDigitalActionHandle("shoot");
@@ -116,8 +158,23 @@ bool Program::SetUp()
 
     UI::Manager().init(this->input(), this->vg);
 
-    Player::Manager().setup();
-    Player::Manager()._level.load("de_dust");
+    this->_playerRenderer.setup();
+    this->_fogRenderer.setup();
+
+    this->_maps.setRotation({ "de_dust" });
+    auto map = this->_maps.loadCurrent();
+    if (map == nullptr)
+    {
+        Log::Current().Error("None of the maps in the rotation can be played.\n");
+        return false;
+    }
+    this->changeLevel(map);
+    this->_levelWatcher.watch(this->_world.level()->walkableFilename());
+
+    if (!replayFilename.empty() && !this->_recorder.start(replayFilename, this->_world, this->timestep.tickLength()))
+    {
+        Log::Current().Error("Could not start recording the replay.\n");
+    }
 
     float buttonSize = this->height / 5.0f;
 
@@ -140,39 +197,136 @@ bool Program::SetUp()
     tPanel->setColor(glm::vec4(91.0f, 107.0f, 123.0f, 155.0f));
     UI::Manager().addToGroup(GameModes::Play, tPanel);
 
+    this->createPlayerButtons();
+
+    UI::Manager().changeGameMode(GameModes::Play);
+
+    return true;
+}
+
+void Program::createPlayerButtons()
+{
+    for (auto playerButton : this->_playerButtons)
+    {
+        UI::Manager().removeFromGroup(GameModes::Play, playerButton);
+        delete playerButton;
+    }
+    this->_playerButtons.clear();
+
+    // The buttons show the players as they are now, events from before do not concern them
+    this->_eventCursor = this->_world.events().end();
+
+    float buttonSize = this->height / 5.0f;
+
     int tindex = 0, ctindex = 0;
-    for (auto player : Player::Manager()._players)
+    for (auto player : this->_world.players()._players)
     {
-        auto playerButton = new PlayerButton(player->_name, player);
+        auto playerButton = new PlayerButton(player->name(), player);
         playerButton->setSize(glm::vec2(buttonSize));
-        playerButton->setText(player->_name);
-        playerButton->setIcon(player->_team == Teams::CounterTerrorist ? eFontAwesomeIcons::FA_SHIELD : eFontAwesomeIcons::FA_BOMB);
+        playerButton->setText(player->name());
+        playerButton->setIcon(player->team() == Teams::CounterTerrorist ? eFontAwesomeIcons::FA_SHIELD : eFontAwesomeIcons::FA_BOMB);
         playerButton->setTextAlignment(eAlignments::Bottom);
         playerButton->onClick([this] (const Button* button) {
             this->moveCameraTo(((PlayerButton*)button)->player());
         });
         UI::Manager().addToGroup(GameModes::Play, playerButton);
-        if (player->_team == Teams::Terrorist)
+        this->_playerButtons.push_back(playerButton);
+        if (player->team() == Teams::Terrorist)
         {
             playerButton->setPosition(glm::vec2((buttonSize / 3.0f), (buttonSize / 3.0f) + (tindex * buttonSize)));
             tindex++;
         }
-        else if (player->_team == Teams::CounterTerrorist)
+        else if (player->team() == Teams::CounterTerrorist)
         {
             playerButton->setPosition(glm::vec2(width - (buttonSize / 3.0f), (buttonSize / 3.0f) + (ctindex * buttonSize)));
             ctindex++;
         }
     }
+}
+
+void Program::moveCameraTo(Player* player)
+{
+    this->execute({ CommandTypes::SelectPlayer, player->handle(), 0 });
+    this->_target = player;// = glm::vec3((this->width / 2) - player->pos().x, (this->height / 2) - player->pos().y, 0.0f);
+}
+
+void Program::reloadChangedLevel()
+{
+    if (this->_levelWatcher.changes().empty()) return;
+
+    auto start = this->elapsed();
+    if (this->_world.level()->reload())
+    {
+        this->_world.players()._lineOfSight.invalidate();
+        this->_fog.invalidate();
+
+        std::stringstream ss;
+        ss << "Reloaded " << this->_world.level()->walkableFilename() << " in " << int((this->elapsed() - start) * 1000.0f) << "ms";
+        Log::Current().Info(ss.str().c_str());
+    }
+}
+
+// The old renderer goes first, it needs the old level to release its textures
+void Program::changeLevel(LevelRenderer* map)
+{
+    // A replay covers a single level
+    if (this->_recorder.isRecording())
+    {
+        this->_recorder.stop(this->_world);
+        Log::Current().Info("Stopped recording the replay at the end of the round");
+    }
+
+    delete this->_levelRenderer;
+    this->_levelRenderer = map;
+    this->_world.changeLevel(map != nullptr ? map->level() : nullptr);
+    this->_fog.invalidate();
+}
+
+// Everything the user does to the world goes through here, so it ends up in the replay
+void Program::execute(const Command& command)
+{
+    this->_recorder.record(this->_world, command);
+    this->_world.execute(command);
+}
+
+void Program::rotateMapAtRoundEnd()
+{
+    this->_maps.update();
+
+    if (!this->_world.players().isRoundOver() || !this->_maps.isNextReady()) return;
 
+    // The next map is completely loaded and staged, swapping it in is only a matter of respawning the players
+    this->changeLevel(this->_maps.takeNext());
+    this->_target = nullptr;
+
+    this->_levelWatcher.clear();
+    this->_levelWatcher.watch(this->_world.level()->walkableFilename());
+
+    this->createPlayerButtons();
     UI::Manager().changeGameMode(GameModes::Play);
+}
 
-    return true;
+void Program::Update(float tickLength)
+{
+    this->_world.update(tickLength);
+    this->_recorder.update(this->_world);
+    this->handleEvents();
 }
 
-void Program::moveCameraTo(Player* player)
+void Program::handleEvents()
 {
-    Player::Manager().selectPlayer(player);
-    this->_target = player;// = glm::vec3((this->width / 2) - player->_pos.x, (this->height / 2) - player->_pos.y, 0.0f);
+    this->_events.clear();
+    this->_world.events().drain(this->_eventCursor, this->_events);
+
+    for (auto& event : this->_events)
+    {
+        if (event.type != GameEventTypes::PlayerKilled) continue;
+
+        for (auto playerButton : this->_playerButtons)
+        {
+            if (playerButton->player()->handle() == event.other) playerButton->showKilled();
+        }
+    }
 }
 
 void Program::Render()
@@ -182,7 +336,9 @@ void Program::Render()
 
     if (this->_target != nullptr)
     {
-        auto targetPos = glm::vec3((this->width / 2) - this->_target->_pos.x, (this->height / 2) - this->_target->_pos.y, 0.0f);
+        // Follow the player where it is drawn, not where the last tick left it
+        auto followed = this->_target->pos(this->timestep.alpha());
+        auto targetPos = glm::vec3((this->width / 2) - followed.x, (this->height / 2) - followed.y, 0.0f);
         const float cameraSpeed = 5.0f;
         auto pos = glm::vec3(this->_view[3].x, this->_view[3].y, this->_view[3].z);
         auto todo = targetPos - pos;
@@ -206,15 +362,27 @@ void Program::Render()
         UI::Manager().clickedControls().pop();
     }
     this->handleInput();
+    this->reloadChangedLevel();
+    this->rotateMapAtRoundEnd();
 
-    Player::Manager().update(diff);
+    // The visible part of the level in world coordinates, used to stream in big levels
+    auto viewPan = glm::vec2(this->_view[3].x, this->_view[3].y);
+    this->_world.players().streamLevel(-viewPan, glm::vec2(float(this->width), float(this->height)) - viewPan);
 
     glDisable(GL_DEPTH_TEST);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    Player::Manager().render(this->_proj, this->_view);
+    // The radar shows what the team of the selected player sees, without a selection it shows everything
+    auto& players = this->_world.players();
+    auto team = players._selectedPlayer != nullptr ? players._selectedPlayer->team() : Teams::Teamless;
+    this->_fog.update(players._storage, *this->_world.level());
+
+    if (this->_levelRenderer != nullptr) this->_levelRenderer->render(this->_proj, this->_view);
+    this->_fogRenderer.render(this->_fog, team, this->_proj, this->_view);
+    this->_playerRenderer.render(players, this->_proj, this->_view, this->timestep.alpha(),
+                                 team != Teams::Teamless ? &this->_fog : nullptr, team);
 
     UI::Manager().render(this->width, this->height, screenScale);
 }
@@ -232,7 +400,7 @@ void Program::handleInput()
     if (!hasShot && this->input()->getDigitalActionData(this->_shootHandle).state)
     {
         hasShot = true;
-        Player::Manager().shoot();
+        this->execute({ CommandTypes::Shoot, 0, 0 });
     }
     else if (hasShot && !this->input()->getDigitalActionData(this->_shootHandle).state)
     {
@@ -266,7 +434,7 @@ void Program::handleInput()
                 click.x -= viewPan.x;
                 click.y -= viewPan.y;
 
-                Player::Manager().clickAt(click.x, click.y);
+                this->execute({ CommandTypes::ClickAt, int(click.x), int(click.y) });
             }
             this->_currentInputState = InputStates::Idle;
         }
@@ -309,7 +477,12 @@ void Program::OnResize(int width, int height)
 }
 
 void Program::CleanUp()
-{ }
+{
+    this->_recorder.stop(this->_world);
+
+    delete this->_levelRenderer;
+    this->_levelRenderer = nullptr;
+}
 
 int main(int argc, char* argv[])
 {
@@ -0,0 +1,331 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "bots.h"
+#include "replay.h"
+#include "world.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Kills are counted in square bins of this many tiles
+static const int killBinTiles = 8;
+
+// Round durations are counted in buckets of this many seconds
+static const int durationBucketSeconds = 10;
+
+class SimOptions
+{
+public:
+    SimOptions() : map("de_dust"), output("radar-sim.txt"), matches(100), threads(0), seed(1), tickRate(30), maxSeconds(300), from(0) { }
+
+    std::string map;
+    std::string output;
+    std::string replay;
+    int matches;
+    int threads;
+    unsigned int seed;
+    int tickRate;
+    int maxSeconds;
+    unsigned int from;
+
+    bool parse(const std::vector<std::string>& args)
+    {
+        for (size_t i = 0; i + 1 < args.size(); i += 2)
+        {
+            if (args[i] == "--map") this->map = args[i + 1];
+            else if (args[i] == "--out") this->output = args[i + 1];
+            else if (args[i] == "--replay") this->replay = args[i + 1];
+            else if (args[i] == "--from") this->from = (unsigned int)std::strtoul(args[i + 1].c_str(), nullptr, 10);
+            else if (args[i] == "--matches") this->matches = std::atoi(args[i + 1].c_str());
+            else if (args[i] == "--threads") this->threads = std::atoi(args[i + 1].c_str());
+            else if (args[i] == "--seed") this->seed = (unsigned int)std::strtoul(args[i + 1].c_str(), nullptr, 10);
+            else if (args[i] == "--tick-rate") this->tickRate = std::atoi(args[i + 1].c_str());
+            else if (args[i] == "--max-seconds") this->maxSeconds = std::atoi(args[i + 1].c_str());
+            else return false;
+        }
+
+        return args.size() % 2 == 0 && this->matches > 0 && this->tickRate > 0 && this->maxSeconds > 0;
+    }
+};
+
+// Results of a number of matches, every thread collects its own and they are merged at the end
+class SimResults
+{
+public:
+    SimResults(int binsX, int binsY)
+        : counterTerroristWins(0), terroristWins(0), draws(0), shots(0), hits(0), lostEvents(0), binsX(binsX), binsY(binsY), kills(binsX * binsY, 0)
+    {
+        BotSchedulerStats empty = { 0, 0, 0, 0 };
+        this->bots = empty;
+
+        BotCosts noCosts = { 0.0, 0.0, 0.0, 0.0, 0, 0 };
+        this->costs = noCosts;
+    }
+
+    int counterTerroristWins;
+    int terroristWins;
+    int draws;
+    std::vector<float> durations;
+    unsigned int shots;
+    unsigned int hits;
+    unsigned int lostEvents;    // Shots, hits and kills the counts above are missing
+    int binsX, binsY;
+    std::vector<unsigned int> kills;
+    BotSchedulerStats bots;
+    BotCosts costs;
+
+    void merge(const SimResults& other)
+    {
+        this->mergeBots(other.bots);
+        this->mergeCosts(other.costs);
+        this->counterTerroristWins += other.counterTerroristWins;
+        this->terroristWins += other.terroristWins;
+        this->draws += other.draws;
+        this->shots += other.shots;
+        this->hits += other.hits;
+        this->lostEvents += other.lostEvents;
+        this->durations.insert(this->durations.end(), other.durations.begin(), other.durations.end());
+        for (size_t i = 0; i < this->kills.size(); i++) this->kills[i] += other.kills[i];
+    }
+
+    void mergeBots(const BotSchedulerStats& other)
+    {
+        this->bots.thinks += other.thinks;
+        this->bots.skipped += other.skipped;
+        this->bots.late += other.late;
+        this->bots.maxLateness = std::max(this->bots.maxLateness, other.maxLateness);
+    }
+
+    void mergeCosts(const BotCosts& other)
+    {
+        this->costs.perceive += other.perceive;
+        this->costs.decide += other.decide;
+        this->costs.paths += other.paths;
+        this->costs.worstTick = std::max(this->costs.worstTick, other.worstTick);
+        this->costs.thinks += other.thinks;
+        this->costs.walks += other.walks;
+    }
+};
+
+// Counts shots and hits and bins kills as they happen
+static void countEvents(const std::vector<GameEvent>& events, SimResults& results)
+{
+    for (auto& event : events)
+    {
+        if (event.type == GameEventTypes::BulletFired) results.shots++;
+        else if (event.type == GameEventTypes::PlayerHit) results.hits++;
+        else if (event.type == GameEventTypes::PlayerKilled)
+        {
+            int x = int(event.pos.x / LEVEL_TILE_WORLD_SIZE) / killBinTiles;
+            int y = int(event.pos.y / LEVEL_TILE_WORLD_SIZE) / killBinTiles;
+            if (x < 0 || x >= results.binsX || y < 0 || y >= results.binsY) continue;
+            results.kills[y * results.binsX + x]++;
+        }
+    }
+}
+
+static void runMatch(const Level& level, const SimOptions& options, unsigned int seed, SimResults& results)
+{
+    World world(seed);
+    world.changeLevel(level.copy());
+    BotController bots(&world);
+    world.players().setBots(&bots);
+    world.players()._avoidance = true;
+
+    float tickLength = 1.0f / options.tickRate;
+    unsigned int maxTicks = (unsigned int)(options.maxSeconds * options.tickRate);
+    auto cursor = world.events().end();
+    std::vector<GameEvent> events;
+    while (world.tick() < maxTicks && !world.players().isRoundOver())
+    {
+        world.update(tickLength);
+
+        events.clear();
+        results.lostEvents += world.events().drain(cursor, events);
+        countEvents(events, results);
+    }
+
+    auto& storage = world.players()._storage;
+    int counterTerrorists = 0, terrorists = 0;
+    for (int i = 0; i < storage.size(); i++)
+    {
+        if (storage._health[i] <= 0.0f) continue;
+        if (storage._team[i] == Teams::CounterTerrorist) counterTerrorists++;
+        else if (storage._team[i] == Teams::Terrorist) terrorists++;
+    }
+
+    if (counterTerrorists > 0 && terrorists == 0) results.counterTerroristWins++;
+    else if (terrorists > 0 && counterTerrorists == 0) results.terroristWins++;
+    else results.draws++;
+
+    results.durations.push_back(world.tick() * tickLength);
+    results.mergeBots(bots.scheduler().total());
+    results.mergeCosts(bots.costs());
+}
+
+static bool writeResults(const SimResults& results, const SimOptions& options)
+{
+    std::ofstream out(options.output);
+    if (!out.is_open()) return false;
+
+    float total = 0.0f, shortest = 0.0f, longest = 0.0f;
+    int buckets = options.maxSeconds / durationBucketSeconds + 1;
+    std::vector<int> histogram(buckets, 0);
+    for (size_t i = 0; i < results.durations.size(); i++)
+    {
+        float duration = results.durations[i];
+        total += duration;
+        shortest = i == 0 ? duration : std::min(shortest, duration);
+        longest = std::max(longest, duration);
+        histogram[std::min(int(duration) / durationBucketSeconds, buckets - 1)]++;
+    }
+    int matches = int(results.durations.size());
+
+    out << "radar-sim 1" << std::endl;
+    out << "map " << options.map << std::endl;
+    out << "matches " << matches << " seed " << options.seed << " tick-rate " << options.tickRate << std::endl;
+    out << "wins ct " << results.counterTerroristWins << " t " << results.terroristWins << " draw " << results.draws << std::endl;
+    out << "win-rate ct " << float(results.counterTerroristWins) / matches << " t " << float(results.terroristWins) / matches << std::endl;
+    out << "duration mean " << (total / matches) << " min " << shortest << " max " << longest << std::endl;
+
+    out << "duration-histogram " << durationBucketSeconds;
+    for (auto count : histogram) out << " " << count;
+    out << std::endl;
+
+    out << "shots " << results.shots << " hits " << results.hits << " lost-events " << results.lostEvents << std::endl;
+    out << "bot-updates thinks " << results.bots.thinks << " skipped " << results.bots.skipped
+        << " late " << results.bots.late << " max-lateness " << results.bots.maxLateness << std::endl;
+
+    // Times depend on the machine, unlike everything else in the file
+    auto thinks = std::max(results.costs.thinks, 1u), walks = std::max(results.costs.walks, 1u);
+    out << "bot-cost-us perceive " << results.costs.perceive / thinks << " decide " << results.costs.decide / thinks
+        << " path " << results.costs.paths / walks << " worst-tick " << results.costs.worstTick << std::endl;
+
+    out << "kills " << killBinTiles << " " << results.binsX << " " << results.binsY << std::endl;
+    for (int y = 0; y < results.binsY; y++)
+    {
+        for (int x = 0; x < results.binsX; x++) out << (x > 0 ? " " : "") << results.kills[y * results.binsX + x];
+        out << std::endl;
+    }
+
+    return true;
+}
+
+// Re-simulates a recorded replay as fast as possible, from the given tick to the end
+static int playReplay(const SimOptions& options)
+{
+    ReplayPlayer replay;
+    if (!replay.open(options.replay))
+    {
+        std::cerr << "Unable to open replay " << options.replay << std::endl;
+        return 1;
+    }
+
+    auto level = new Level();
+    if (!level->prepare(replay.levelName()))
+    {
+        std::cerr << "Unable to load map " << replay.levelName() << std::endl;
+        delete level;
+        return 1;
+    }
+
+    World world(replay.seed());
+    world.changeLevel(level);
+    BotController bots(&world);
+    world.players().setBots(&bots);
+
+    auto start = std::chrono::steady_clock::now();
+    if (!replay.seek(world, options.from))
+    {
+        std::cerr << "Unable to seek to tick " << options.from << std::endl;
+        return 1;
+    }
+    auto seeked = std::chrono::steady_clock::now();
+
+    unsigned int ticks = 0;
+    while (replay.step(world)) ticks++;
+
+    double seekSeconds = std::chrono::duration<double>(seeked - start).count();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - seeked).count();
+
+    std::cout << "Seeked to tick " << options.from << " in " << (seekSeconds * 1000.0) << "ms, played "
+              << ticks << " ticks in " << seconds << "s, " << (ticks * replay.tickLength() / seconds) << "x real time" << std::endl;
+    std::cout << "Tick " << world.tick() << " state " << std::hex << world.stateHash() << std::dec << std::endl;
+
+    return 0;
+}
+
+// Runs many headless matches between bots on all cores, to balance maps
+//
+//   radar-sim [--map de_dust] [--matches 100] [--threads 0] [--seed 1] [--tick-rate 30] [--max-seconds 300] [--out radar-sim.txt]
+//
+// Every match gets its own world seeded with seed + match number, so a run can be reproduced.
+// With "--replay <file> [--from <tick>]" it plays back a replay instead, to reproduce bugs.
+int main(int argc, char* argv[])
+{
+    SimOptions options;
+    if (!options.parse(std::vector<std::string>(argv + 1, argv + argc)))
+    {
+        std::cerr << "usage: radar-sim [--map <name>] [--matches <n>] [--threads <n>] [--seed <n>] [--tick-rate <n>] [--max-seconds <n>] [--out <file>]" << std::endl;
+        std::cerr << "       radar-sim --replay <file> [--from <tick>]" << std::endl;
+        return 1;
+    }
+
+    if (!options.replay.empty()) return playReplay(options);
+
+    // Decoding the level and building its derived data is done once, every match plays on a copy
+    Level level;
+    if (!level.prepare(options.map) || level._streamer != nullptr)
+    {
+        std::cerr << "Unable to load map " << options.map << ", streamed maps are not supported" << std::endl;
+        return 1;
+    }
+    std::vector<unsigned char>().swap(level._radar);
+
+    int threads = options.threads > 0 ? options.threads : std::max(int(std::thread::hardware_concurrency()), 1);
+    int binsX = (level.width + killBinTiles - 1) / killBinTiles, binsY = (level.height + killBinTiles - 1) / killBinTiles;
+
+    SimResults results(binsX, binsY);
+    std::mutex resultsMutex;
+    std::atomic<int> nextMatch(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&] () {
+            SimResults own(binsX, binsY);
+            for (int match = nextMatch++; match < options.matches; match = nextMatch++)
+            {
+                runMatch(level, options, options.seed + match, own);
+            }
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            results.merge(own);
+        }));
+    }
+    for (auto& worker : workers) worker.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!writeResults(results, options))
+    {
+        std::cerr << "Unable to write " << options.output << std::endl;
+        return 1;
+    }
+
+    std::cout << options.matches << " matches on " << threads << " threads in " << seconds << "s, "
+              << (options.matches / seconds) << " matches per second" << std::endl;
+
+    return 0;
+}
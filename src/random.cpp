@@ -0,0 +1,59 @@
+#include "random.h"
+
+static const uint64_t multiplier = 6364136223846793005ULL;
+static const uint64_t increment = 1442695040888963407ULL;
+
+Random::Random(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+void Random::seed(uint64_t seed)
+{
+    this->_state = 0;
+    this->next();
+    this->_state += seed;
+    this->next();
+}
+
+uint32_t Random::next()
+{
+    uint64_t old = this->_state;
+    this->_state = old * multiplier + increment;
+
+    uint32_t xorshifted = uint32_t(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = uint32_t(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+}
+
+int Random::range(int min, int max)
+{
+    if (max <= min) return min;
+
+    // Reject the few numbers at the bottom that would make the lower values more likely
+    uint32_t bound = uint32_t(max - min) + 1u;
+    if (bound == 0) return int(this->next());
+
+    uint32_t threshold = (0u - bound) % bound;
+    for (;;)
+    {
+        uint32_t r = this->next();
+        if (r >= threshold) return min + int(r % bound);
+    }
+}
+
+float Random::unit()
+{
+    // 24 bits fit exactly in the mantissa of a float
+    return float(this->next() >> 8) * (1.0f / 16777216.0f);
+}
+
+uint64_t Random::state() const
+{
+    return this->_state;
+}
+
+void Random::setState(uint64_t state)
+{
+    this->_state = state;
+}
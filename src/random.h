@@ -0,0 +1,30 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Small PCG32 generator. Unlike std::default_random_engine and the std distributions, the
+// numbers it gives for a seed are the same with every compiler and standard library.
+class Random
+{
+public:
+    Random(uint64_t seed = 1);
+
+    void seed(uint64_t seed);
+
+    uint32_t next();
+
+    // Uniform in [min, max], both inclusive
+    int range(int min, int max);
+
+    // Uniform in [0, 1)
+    float unit();
+
+    uint64_t state() const;
+    void setState(uint64_t state);
+
+private:
+    uint64_t _state;
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,313 @@
+#include "renderer.h"
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <algorithm>
+
+static float playerScale = LEVEL_TILE_WORLD_SIZE;
+
+// Maximum number of streamed chunk textures uploaded in a single frame
+static const int maxChunkUploadsPerFrame = 4;
+
+// How dark the tiles in the fog of war are
+static const unsigned char fogAlpha = 160;
+
+LevelRenderer::LevelRenderer(Level* level)
+    : _level(level), _vbuffer(_shader), _chunkBuffer(_shader), _texture(0), _stagedRows(0), _setup(false)
+{ }
+
+// Expects the level to still be alive, to find the textures of its streamed chunks
+LevelRenderer::~LevelRenderer()
+{
+    if (this->_texture != 0) glDeleteTextures(1, &this->_texture);
+
+    if (this->_level->_streamer != nullptr)
+    {
+        auto textures = this->_level->_streamer->takeReleasedTextures();
+        this->_level->_streamer->visitResident([&textures] (LevelChunk& chunk) {
+            if (chunk._texture != 0) textures.push_back(chunk._texture);
+            chunk._texture = 0;
+        });
+        if (!textures.empty()) glDeleteTextures(GLsizei(textures.size()), textures.data());
+    }
+}
+
+Level* LevelRenderer::level() const
+{
+    return this->_level;
+}
+
+bool LevelRenderer::stage(int maxRows)
+{
+    if (!this->_setup)
+    {
+        this->_shader.compileFromFile("shaders/gl3/vertex.glsl", "shaders/gl3/fragment.glsl");
+
+        if (this->_level->_streamer != nullptr)
+        {
+            this->_chunkBuffer
+                    << PlayerVertex({ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } })
+                    << PlayerVertex({ { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } })
+                    << PlayerVertex({ { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } })
+                    << PlayerVertex({ { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
+            this->_chunkBuffer.setup();
+        }
+        else
+        {
+            float x = float(this->_level->_radarWidth);
+            float y = float(this->_level->_radarHeight);
+            this->_vbuffer
+                    << PlayerVertex({ {    x, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } })
+                    << PlayerVertex({ {    x,    y, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } })
+                    << PlayerVertex({ { 0.0f,    y, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } })
+                    << PlayerVertex({ { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
+            this->_vbuffer.setup();
+
+            if (!this->_level->_radar.empty())
+            {
+                glGenTextures(1, &this->_texture);
+                glBindTexture(GL_TEXTURE_2D, this->_texture);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->_level->_radarWidth, this->_level->_radarHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+        this->_setup = true;
+    }
+
+    if (this->_stagedRows < this->_level->_radarHeight && !this->_level->_radar.empty())
+    {
+        int rows = std::min(std::max(maxRows, 1), this->_level->_radarHeight - this->_stagedRows);
+        glBindTexture(GL_TEXTURE_2D, this->_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, this->_stagedRows, this->_level->_radarWidth, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+                        &this->_level->_radar[this->_stagedRows * this->_level->_radarWidth * 4]);
+        this->_stagedRows += rows;
+    }
+
+    if (this->_stagedRows < this->_level->_radarHeight && !this->_level->_radar.empty()) return false;
+
+    // Everything is on the GPU, the pixels are not needed anymore
+    std::vector<unsigned char>().swap(this->_level->_radar);
+
+    return true;
+}
+
+void LevelRenderer::render(const glm::mat4& proj, const glm::mat4& view)
+{
+    this->_shader.use();
+
+    if (this->_level->_streamer != nullptr)
+    {
+        auto released = this->_level->_streamer->takeReleasedTextures();
+        if (!released.empty()) glDeleteTextures(GLsizei(released.size()), released.data());
+
+        int uploads = 0;
+        float chunkWorldSize = this->_level->_streamer->chunkSize * playerScale;
+        this->_level->_streamer->visitResident([this, &proj, &view, &uploads, chunkWorldSize] (LevelChunk& chunk) {
+            if (chunk._texture == 0 && !chunk._radar.empty() && uploads < maxChunkUploadsPerFrame)
+            {
+                glGenTextures(1, &chunk._texture);
+                glBindTexture(GL_TEXTURE_2D, chunk._texture);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, chunk._radarWidth, chunk._radarHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, chunk._radar.data());
+                std::vector<unsigned char>().swap(chunk._radar);
+                uploads++;
+            }
+            if (chunk._texture == 0) return;
+
+            auto model = glm::translate(glm::mat4(1.0f), glm::vec3(chunk._x * chunkWorldSize, chunk._y * chunkWorldSize, 0.0f));
+            model = glm::scale(model, glm::vec3(float(chunk._radarWidth), float(chunk._radarHeight), 1.0f));
+            this->_shader.setupMatrices(glm::value_ptr(proj),
+                                        glm::value_ptr(view),
+                                        glm::value_ptr(model)
+                                        );
+            glBindTexture(GL_TEXTURE_2D, chunk._texture);
+            this->_chunkBuffer.render();
+        });
+        return;
+    }
+
+    this->_shader.setupMatrices(glm::value_ptr(proj),
+                                glm::value_ptr(view),
+                                glm::value_ptr(glm::mat4(1.0f))
+                                );
+    glBindTexture(GL_TEXTURE_2D, this->_texture);
+    this->_vbuffer.render();
+}
+
+FogRenderer::FogRenderer() : _buffer(_shader), _texture(0), _width(0), _height(0), _team(Teams::Teamless) { }
+
+FogRenderer::~FogRenderer()
+{
+    if (this->_texture != 0) glDeleteTextures(1, &this->_texture);
+}
+
+void FogRenderer::setup()
+{
+    this->_shader.compileFromFile("shaders/gl3/vertex.glsl", "shaders/gl3/fragment.glsl");
+
+    this->_buffer
+            << PlayerVertex({ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } })
+            << PlayerVertex({ { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } })
+            << PlayerVertex({ { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } })
+            << PlayerVertex({ { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f } });
+    this->_buffer.setup();
+}
+
+void FogRenderer::render(FogOfWar& fog, Teams team, const glm::mat4& proj, const glm::mat4& view)
+{
+    if (team == Teams::Teamless || fog.width() == 0) return;
+
+    // Another level or team needs all of the texture, otherwise only what changed
+    auto dirty = fog.takeDirty(team);
+    if (this->_texture == 0 || fog.width() != this->_width || fog.height() != this->_height || team != this->_team)
+    {
+        if (this->_texture == 0) glGenTextures(1, &this->_texture);
+        this->_width = fog.width();
+        this->_height = fog.height();
+        this->_team = team;
+
+        glBindTexture(GL_TEXTURE_2D, this->_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->_width, this->_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        FogRect all = { 0, 0, this->_width - 1, this->_height - 1 };
+        dirty = all;
+    }
+    if (dirty.maxX >= dirty.minX) this->upload(fog, dirty);
+
+    this->_shader.use();
+    auto model = glm::scale(glm::mat4(1.0f), glm::vec3(this->_width * playerScale, this->_height * playerScale, 1.0f));
+    this->_shader.setupMatrices(glm::value_ptr(proj),
+                                glm::value_ptr(view),
+                                glm::value_ptr(model)
+                                );
+    glBindTexture(GL_TEXTURE_2D, this->_texture);
+    this->_buffer.render();
+}
+
+// Black texels, see-through where the team sees the tile
+void FogRenderer::upload(const FogOfWar& fog, const FogRect& rect)
+{
+    auto& mask = fog.mask(this->_team);
+    int width = rect.maxX - rect.minX + 1, height = rect.maxY - rect.minY + 1;
+    this->_pixels.assign(width * height * 4, 0);
+    for (int y = 0; y < height; y++)
+    {
+        auto row = &mask[(rect.minY + y) * this->_width + rect.minX];
+        for (int x = 0; x < width; x++)
+        {
+            if (row[x] == 0) this->_pixels[(y * width + x) * 4 + 3] = fogAlpha;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, this->_texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, rect.minX, rect.minY, width, height, GL_RGBA, GL_UNSIGNED_BYTE, this->_pixels.data());
+}
+
+PlayerRenderer::PlayerRenderer() : _buffer(_shader) { }
+
+PlayerRenderer::~PlayerRenderer() { }
+
+void PlayerRenderer::setup()
+{
+    this->_playerTexture.setup();
+    this->_playerTexture.load("player.png");
+
+    this->_selectedPlayerTexture.setup();
+    this->_selectedPlayerTexture.load("selected-player.png");
+
+    this->_deadPlayerTexture.setup();
+    this->_deadPlayerTexture.load("dead-player.png");
+
+    this->_bulletTexture.setup();
+    this->_bulletTexture.load("bullet.png");
+
+    this->_shader.compileFromFile("shaders/gl3/vertex.glsl", "shaders/gl3/fragment.glsl");
+
+    this->_buffer
+            << PlayerVertex({ {  playerScale, -playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 0.0f } })
+            << PlayerVertex({ {  playerScale,  playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, { -1.0f, 1.0f } })
+            << PlayerVertex({ { -playerScale,  playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, {  0.0f, 1.0f } })
+            << PlayerVertex({ { -playerScale, -playerScale, 0.0f }, { 0.0f, 1.0f, 0.0f }, {  0.0f, 0.0f } });
+    this->_buffer.setup();
+}
+
+void PlayerRenderer::render(const PlayerManager& manager, const glm::mat4& proj, const glm::mat4& view, float alpha,
+                            const FogOfWar* fog, Teams team)
+{
+    auto& players = manager._storage;
+    auto inFog = [fog, team] (float x, float y) {
+        return fog != nullptr && !fog->isVisible(team, int(x / playerScale), int(y / playerScale));
+    };
+
+    this->_playerTexture.use();
+    for (int i = 0; i < players.size(); i++)
+    {
+        if (players._health[i] <= 0.0f) continue;
+        if (players._team[i] != team && inFog(players._posX[i], players._posY[i])) continue;
+
+        auto pos = glm::mix(glm::vec3(players._prevPosX[i], players._prevPosY[i], 0.0f), glm::vec3(players._posX[i], players._posY[i], 0.0f), alpha);
+        auto model = glm::translate(glm::mat4(1.0f), pos);
+        if (players._dirX[i] * players._dirX[i] + players._dirY[i] * players._dirY[i] > 0.000001f)
+        {
+            model = glm::rotate(model, std::atan2(players._dirX[i], players._dirY[i]), glm::vec3(0.0f, 0.0f, -1.0f));
+        }
+        this->_shader.setupMatrices(glm::value_ptr(proj),
+                                    glm::value_ptr(view),
+                                    glm::value_ptr(model)
+                                    );
+        this->_buffer.render();
+    }
+
+    this->_bulletTexture.use();
+    for (auto& bullet : manager._bullets)
+    {
+        if (inFog(bullet._pos.x, bullet._pos.y)) continue;
+
+        auto model = glm::translate(glm::mat4(1.0f), glm::mix(bullet._prevPos, bullet._pos, alpha));
+        if (glm::length(bullet._dir) > 0.001f)
+        {
+            model = glm::rotate(model, std::atan2(bullet._dir.x, bullet._dir.y), glm::vec3(0.0f, 0.0f, -1.0f));
+        }
+        this->_shader.setupMatrices(glm::value_ptr(proj),
+                                    glm::value_ptr(view),
+                                    glm::value_ptr(model)
+                                    );
+        this->_buffer.render();
+    }
+
+    if (manager._selectedPlayer != nullptr && manager._selectedPlayer->health() > 0.0f)
+    {
+        auto pos = manager._selectedPlayer->pos(alpha);
+
+        this->_selectedPlayerTexture.use();
+        this->_shader.setupMatrices(glm::value_ptr(proj),
+                                    glm::value_ptr(view),
+                                    glm::value_ptr(glm::translate(glm::mat4(1.0f), pos))
+                                    );
+        this->_buffer.render();
+    }
+
+    this->_deadPlayerTexture.use();
+    for (int i = 0; i < players.size(); i++)
+    {
+        if (players._health[i] > 0.0f) continue;
+        if (players._team[i] != team && inFog(players._posX[i], players._posY[i])) continue;
+
+        this->_shader.setupMatrices(glm::value_ptr(proj),
+                                    glm::value_ptr(view),
+                                    glm::value_ptr(glm::translate(glm::mat4(1.0f), glm::vec3(players._posX[i], players._posY[i], 0.0f)))
+                                    );
+        this->_buffer.render();
+    }
+}
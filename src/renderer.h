@@ -0,0 +1,88 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <glm/glm.hpp>
+
+#include "fog-of-war.h"
+#include "level.h"
+#include "players.h"
+#include <gl.utilities.textures.h>
+#include <gl.utilities.vertexbuffers.h>
+
+typedef Vertex<glm::vec3, glm::vec3, glm::vec2> PlayerVertex;
+typedef Shader<glm::vec3, glm::vec3, glm::vec2> PlayerShader;
+typedef VertexBuffer<glm::vec3, glm::vec3, glm::vec2> PlayerVertexBuffer;
+
+// GPU side of a level, it does not own the level. The radar image is uploaded a
+// few rows at a time, the chunks of a streamed level while they become resident.
+class LevelRenderer
+{
+public:
+    LevelRenderer(Level* level);
+    virtual ~LevelRenderer();
+
+    Level* level() const;
+
+    // Uploads at most the given number of rows of the radar image, returns true when the level is ready to render
+    bool stage(int maxRows);
+
+    void render(const glm::mat4& proj, const glm::mat4& view);
+
+private:
+    Level* _level;
+    PlayerShader _shader;
+    PlayerVertexBuffer _vbuffer;
+    PlayerVertexBuffer _chunkBuffer;
+    unsigned int _texture;
+    int _stagedRows;
+    bool _setup;
+};
+
+// GPU side of the fog of war of one team, a texture with a texel per tile laid over the level.
+// Only the rectangle of tiles that changed since the last frame is uploaded.
+class FogRenderer
+{
+public:
+    FogRenderer();
+    virtual ~FogRenderer();
+
+    void setup();
+
+    // Teamless sees everything and draws no fog
+    void render(FogOfWar& fog, Teams team, const glm::mat4& proj, const glm::mat4& view);
+
+private:
+    PlayerShader _shader;
+    PlayerVertexBuffer _buffer;
+    unsigned int _texture;
+    int _width, _height;
+    Teams _team;
+    std::vector<unsigned char> _pixels;
+
+    void upload(const FogOfWar& fog, const FogRect& rect);
+};
+
+// Draws the players and bullets of a PlayerManager, it only reads the game state
+class PlayerRenderer
+{
+public:
+    PlayerRenderer();
+    virtual ~PlayerRenderer();
+
+    void setup();
+
+    // Renders between the previous and the current tick, alpha 0 is the previous tick and 1 the current one.
+    // With a fog of war, players of other teams and bullets the team does not see are skipped.
+    void render(const PlayerManager& manager, const glm::mat4& proj, const glm::mat4& view, float alpha = 1.0f,
+                const FogOfWar* fog = nullptr, Teams team = Teams::Teamless);
+
+private:
+    Texture _playerTexture;
+    Texture _selectedPlayerTexture;
+    Texture _deadPlayerTexture;
+    Texture _bulletTexture;
+    PlayerShader _shader;
+    PlayerVertexBuffer _buffer;
+};
+
+#endif // RENDERER_H
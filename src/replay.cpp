@@ -0,0 +1,246 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <iterator>
+
+static const char replayMagic[4] = { 'R', 'S', 'R', 'P' };
+static const int keyframeKind = 3;
+
+ReplayRecorder::ReplayRecorder(int keyframeInterval)
+    : _keyframeInterval(std::max(keyframeInterval, 1)), _lastRecordTick(0), _lastKeyframeTick(0), _bytesWritten(0)
+{ }
+
+ReplayRecorder::~ReplayRecorder()
+{
+    if (this->_file.is_open()) this->_file.close();
+}
+
+bool ReplayRecorder::start(const std::string& filename, const World& world, float tickLength)
+{
+    if (this->_file.is_open()) this->_file.close();
+
+    this->_file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!this->_file.is_open()) return false;
+
+    this->_bytesWritten = 0;
+    this->_lastRecordTick = world.tick();
+
+    StateWriter writer(this->_buffer);
+    writer.writeBytes(replayMagic, sizeof(replayMagic));
+    writer.writeVarint(REPLAY_VERSION);
+    writer.writeVarint(world.seed());
+    writer.writeString(world.level()->_name);
+    writer.writeRaw(tickLength);
+    writer.writeVarint(this->_keyframeInterval);
+    writer.writeVarint(world.tick());
+    this->flush();
+
+    this->writeKeyframe(world);
+
+    return true;
+}
+
+void ReplayRecorder::record(const World& world, const Command& command)
+{
+    if (!this->_file.is_open()) return;
+
+    StateWriter writer(this->_buffer);
+    this->beginRecord(writer, world.tick(), int(command.type));
+    if (command.type == CommandTypes::SelectPlayer) writer.writeSigned(command.x);
+    else if (command.type == CommandTypes::ClickAt)
+    {
+        writer.writeSigned(command.x);
+        writer.writeSigned(command.y);
+    }
+    this->flush();
+}
+
+void ReplayRecorder::update(const World& world)
+{
+    if (!this->_file.is_open()) return;
+
+    if (world.tick() >= this->_lastKeyframeTick + this->_keyframeInterval) this->writeKeyframe(world);
+}
+
+void ReplayRecorder::stop(const World& world)
+{
+    if (!this->_file.is_open()) return;
+
+    StateWriter writer(this->_buffer);
+    this->beginRecord(writer, std::max(world.tick(), this->_lastRecordTick), keyframeKind);
+    writer.writeVarint(0);
+    this->flush();
+
+    this->_file.close();
+}
+
+bool ReplayRecorder::isRecording() const
+{
+    return this->_file.is_open();
+}
+
+size_t ReplayRecorder::bytesWritten() const
+{
+    return this->_bytesWritten;
+}
+
+void ReplayRecorder::beginRecord(StateWriter& writer, unsigned int tick, int kind)
+{
+    writer.writeVarint((uint64_t(tick - this->_lastRecordTick) << 2) | uint64_t(kind));
+    this->_lastRecordTick = tick;
+}
+
+void ReplayRecorder::writeKeyframe(const World& world)
+{
+    this->_keyframe.capture(world);
+
+    StateWriter writer(this->_buffer);
+    this->beginRecord(writer, world.tick(), keyframeKind);
+    writer.writeVarint(this->_keyframe.size());
+    writer.writeBytes(this->_keyframe.data().data(), this->_keyframe.size());
+    this->flush();
+
+    this->_lastKeyframeTick = world.tick();
+}
+
+void ReplayRecorder::flush()
+{
+    this->_file.write(reinterpret_cast<const char*>(this->_buffer.data()), this->_buffer.size());
+    this->_bytesWritten += this->_buffer.size();
+    this->_buffer.clear();
+}
+
+ReplayPlayer::ReplayPlayer() : _seed(0), _tickLength(0.0f), _lastTick(0) { }
+
+ReplayPlayer::~ReplayPlayer() { }
+
+bool ReplayPlayer::open(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return this->load(data);
+}
+
+bool ReplayPlayer::load(const std::vector<unsigned char>& data)
+{
+    this->_data = data;
+    this->_commands.clear();
+    this->_keyframes.clear();
+
+    StateReader reader(this->_data.data(), this->_data.size());
+
+    char magic[4];
+    if (!reader.readBytes(magic, sizeof(magic)) || !std::equal(magic, magic + 4, replayMagic)) return false;
+    if (reader.readVarint() != REPLAY_VERSION) return false;
+
+    this->_seed = (unsigned int)reader.readVarint();
+    this->_levelName = reader.readString();
+    this->_tickLength = reader.readRaw<float>();
+    reader.readVarint();
+    auto tick = (unsigned int)reader.readVarint();
+    if (reader.failed()) return false;
+
+    // A replay that was not stopped, because the game crashed, still plays up to its last record
+    while (!reader.isAtEnd())
+    {
+        auto header = reader.readVarint();
+        tick += (unsigned int)(header >> 2);
+        int kind = int(header & 3);
+
+        if (kind == keyframeKind)
+        {
+            auto size = reader.readVarint();
+            if (reader.failed() || size == 0) break;
+
+            ReplayKeyframe keyframe = { tick, reader.position(), size_t(size) };
+            if (!reader.skip(keyframe.size)) break;
+
+            this->_keyframes.push_back(keyframe);
+        }
+        else
+        {
+            ReplayCommand command = { tick, { CommandTypes(kind), 0, 0 } };
+            if (command.command.type == CommandTypes::SelectPlayer) command.command.x = int(reader.readSigned());
+            else if (command.command.type == CommandTypes::ClickAt)
+            {
+                command.command.x = int(reader.readSigned());
+                command.command.y = int(reader.readSigned());
+            }
+            if (reader.failed()) break;
+
+            this->_commands.push_back(command);
+        }
+    }
+    this->_lastTick = tick;
+
+    return !this->_keyframes.empty();
+}
+
+unsigned int ReplayPlayer::seed() const
+{
+    return this->_seed;
+}
+
+const std::string& ReplayPlayer::levelName() const
+{
+    return this->_levelName;
+}
+
+float ReplayPlayer::tickLength() const
+{
+    return this->_tickLength;
+}
+
+unsigned int ReplayPlayer::firstTick() const
+{
+    return this->_keyframes.empty() ? 0 : this->_keyframes.front().tick;
+}
+
+unsigned int ReplayPlayer::lastTick() const
+{
+    return this->_lastTick;
+}
+
+const std::vector<ReplayCommand>& ReplayPlayer::commands() const
+{
+    return this->_commands;
+}
+
+const std::vector<ReplayKeyframe>& ReplayPlayer::keyframes() const
+{
+    return this->_keyframes;
+}
+
+bool ReplayPlayer::seek(World& world, unsigned int tick)
+{
+    if (this->_keyframes.empty()) return false;
+
+    tick = std::min(std::max(tick, this->firstTick()), this->_lastTick);
+
+    auto keyframe = std::upper_bound(this->_keyframes.begin(), this->_keyframes.end(), tick, [] (unsigned int tick, const ReplayKeyframe& keyframe) {
+        return tick < keyframe.tick;
+    }) - 1;
+
+    StateReader reader(this->_data.data() + keyframe->offset, keyframe->size);
+    if (!world.readState(reader)) return false;
+
+    while (world.tick() < tick) this->step(world);
+
+    return true;
+}
+
+bool ReplayPlayer::step(World& world)
+{
+    if (world.tick() >= this->_lastTick) return false;
+
+    auto command = std::lower_bound(this->_commands.begin(), this->_commands.end(), world.tick(), [] (const ReplayCommand& command, unsigned int tick) {
+        return command.tick < tick;
+    });
+    for (; command != this->_commands.end() && command->tick == world.tick(); ++command) world.execute(command->command);
+
+    world.update(this->_tickLength);
+
+    return true;
+}
@@ -0,0 +1,112 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "state-buffer.h"
+#include "world.h"
+#include "world-snapshot.h"
+
+#define REPLAY_VERSION 3
+
+// Ticks between two keyframes, seeking never simulates more than this many ticks
+#define REPLAY_KEYFRAME_INTERVAL 300
+
+// A replay is the seed and level of a world, followed by the commands it executed and the tick
+// they executed at. Because the simulation is deterministic that is enough to play it back. The
+// full world state is stored every few seconds as a keyframe, so playback can start anywhere.
+//
+//   "RSRP" version seed level tick-length keyframe-interval start-tick
+//   records, each starting with (ticks since the previous record << 2) | kind
+//     kind 0-2  a command of that type, SelectPlayer with a handle, ClickAt with x and y
+//     kind 3    a keyframe, its size followed by World::writeState, size 0 ends the replay
+//
+// All integers are varints and signed ones are zigzag encoded, the tick length is a raw float.
+// Since version 2 the players that are not selected are bots, playback needs bots on the world too.
+// Since version 3 the keyframes tell whether the players avoid each other.
+class ReplayRecorder
+{
+public:
+    ReplayRecorder(int keyframeInterval = REPLAY_KEYFRAME_INTERVAL);
+    virtual ~ReplayRecorder();
+
+    // Starts a new file with a keyframe of the world as it is now
+    bool start(const std::string& filename, const World& world, float tickLength);
+
+    // Call right before the world executes the command
+    void record(const World& world, const Command& command);
+
+    // Call after every tick of the world, writes the keyframes
+    void update(const World& world);
+
+    void stop(const World& world);
+
+    bool isRecording() const;
+    size_t bytesWritten() const;
+
+private:
+    std::ofstream _file;
+    std::vector<unsigned char> _buffer;
+    WorldSnapshot _keyframe;
+    int _keyframeInterval;
+    unsigned int _lastRecordTick;
+    unsigned int _lastKeyframeTick;
+    size_t _bytesWritten;
+
+    void beginRecord(StateWriter& writer, unsigned int tick, int kind);
+    void writeKeyframe(const World& world);
+    void flush();
+};
+
+typedef struct sReplayCommand
+{
+    unsigned int tick;
+    Command command;
+} ReplayCommand;
+
+typedef struct sReplayKeyframe
+{
+    unsigned int tick;
+    size_t offset;
+    size_t size;
+} ReplayKeyframe;
+
+// Plays a replay back on a world, as fast as the world can be updated
+class ReplayPlayer
+{
+public:
+    ReplayPlayer();
+    virtual ~ReplayPlayer();
+
+    bool open(const std::string& filename);
+    bool load(const std::vector<unsigned char>& data);
+
+    unsigned int seed() const;
+    const std::string& levelName() const;
+    float tickLength() const;
+    unsigned int firstTick() const;
+    unsigned int lastTick() const;
+
+    const std::vector<ReplayCommand>& commands() const;
+    const std::vector<ReplayKeyframe>& keyframes() const;
+
+    // Restores the last keyframe before the tick and simulates the rest of the way,
+    // the world has to be on the level of the replay
+    bool seek(World& world, unsigned int tick);
+
+    // Executes the commands of the current tick and advances the world one tick, false at the end
+    bool step(World& world);
+
+private:
+    std::vector<unsigned char> _data;
+    unsigned int _seed;
+    std::string _levelName;
+    float _tickLength;
+    unsigned int _lastTick;
+    std::vector<ReplayCommand> _commands;
+    std::vector<ReplayKeyframe> _keyframes;
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,369 @@
+#include "scripts.h"
+
+#include "world.h"
+
+#include <algorithm>
+#include <exception>
+#include <new>
+
+// Every frame starts with the pool it came from, nullptr for frames from the heap
+static const size_t frameHeader = alignof(std::max_align_t);
+
+ScriptFramePool::ScriptFramePool() : _liveFrames(0)
+{
+    for (int i = 0; i < SCRIPT_FRAME_SIZE_CLASSES; i++) this->_free[i] = nullptr;
+}
+
+ScriptFramePool::~ScriptFramePool()
+{
+    for (auto page : this->_pages) ::operator delete(page);
+}
+
+void* ScriptFramePool::allocate(size_t size)
+{
+    int sizeClass = ScriptFramePool::sizeClass(size);
+    if (sizeClass < 0) return ::operator new(size);
+
+    if (this->_free[sizeClass] == nullptr)
+    {
+        size_t blockSize = size_t(SCRIPT_FRAME_MIN_SIZE) << sizeClass;
+        auto page = static_cast<char*>(::operator new(blockSize * SCRIPT_FRAMES_PER_PAGE));
+        this->_pages.push_back(page);
+
+        for (int i = SCRIPT_FRAMES_PER_PAGE - 1; i >= 0; i--)
+        {
+            auto block = page + i * blockSize;
+            *reinterpret_cast<void**>(block) = this->_free[sizeClass];
+            this->_free[sizeClass] = block;
+        }
+    }
+
+    auto block = this->_free[sizeClass];
+    this->_free[sizeClass] = *static_cast<void**>(block);
+    this->_liveFrames++;
+
+    return block;
+}
+
+void ScriptFramePool::release(void* frame, size_t size)
+{
+    int sizeClass = ScriptFramePool::sizeClass(size);
+    if (sizeClass < 0)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    *static_cast<void**>(frame) = this->_free[sizeClass];
+    this->_free[sizeClass] = frame;
+    this->_liveFrames--;
+}
+
+int ScriptFramePool::liveFrames() const
+{
+    return this->_liveFrames;
+}
+
+int ScriptFramePool::pageCount() const
+{
+    return int(this->_pages.size());
+}
+
+int ScriptFramePool::sizeClass(size_t size)
+{
+    for (int i = 0; i < SCRIPT_FRAME_SIZE_CLASSES; i++)
+    {
+        if (size <= (size_t(SCRIPT_FRAME_MIN_SIZE) << i)) return i;
+    }
+
+    return -1;
+}
+
+Script::promise_type::promise_type() : _task(-1), _sequence(0) { }
+
+Script Script::promise_type::get_return_object()
+{
+    return Script(Script::Handle::from_promise(*this));
+}
+
+std::suspend_always Script::promise_type::initial_suspend() noexcept
+{
+    return std::suspend_always();
+}
+
+std::suspend_always Script::promise_type::final_suspend() noexcept
+{
+    return std::suspend_always();
+}
+
+void Script::promise_type::return_void() { }
+
+// The simulation does not use exceptions, a script throwing one is a bug
+void Script::promise_type::unhandled_exception()
+{
+    std::terminate();
+}
+
+void* Script::promise_type::operator new(size_t size)
+{
+    auto block = static_cast<char*>(::operator new(size + frameHeader));
+    *reinterpret_cast<ScriptFramePool**>(block) = nullptr;
+
+    return block + frameHeader;
+}
+
+void Script::promise_type::operator delete(void* frame, size_t size)
+{
+    auto block = static_cast<char*>(frame) - frameHeader;
+    auto pool = *reinterpret_cast<ScriptFramePool**>(block);
+    if (pool != nullptr) pool->release(block, size + frameHeader);
+    else ::operator delete(block);
+}
+
+void* Script::promise_type::allocateFrame(size_t size, World* world)
+{
+    auto pool = &world->scripts().pool();
+    auto block = static_cast<char*>(pool->allocate(size + frameHeader));
+    *reinterpret_cast<ScriptFramePool**>(block) = pool;
+
+    return block + frameHeader;
+}
+
+Script::Script(Handle handle) : _handle(handle) { }
+
+Script::Script(Script&& other) : _handle(other._handle)
+{
+    other._handle = nullptr;
+}
+
+// Scripts that were never started are destroyed with their return object
+Script::~Script()
+{
+    if (this->_handle) this->_handle.destroy();
+}
+
+ScriptWait::ScriptWait(ScriptScheduler* scheduler, Kinds kind, unsigned int tick, double time, int value)
+    : _scheduler(scheduler), _kind(kind), _tick(tick), _time(time), _value(value)
+{ }
+
+bool ScriptWait::await_ready() const
+{
+    switch (this->_kind)
+    {
+    case Kinds::Ticks: return this->_tick <= this->_scheduler->_world->tick();
+    case Kinds::Seconds: return this->_time <= this->_scheduler->_time + SCRIPT_TIME_EPSILON;
+    case Kinds::Arrival: return this->_scheduler->hasArrived(this->_value);
+    default: return false;
+    }
+}
+
+void ScriptWait::await_suspend(Script::Handle handle)
+{
+    this->_scheduler->wait(handle, this->_kind, this->_tick, this->_time, this->_value);
+}
+
+void ScriptWait::await_resume() const { }
+
+ScriptScheduler::ScriptScheduler(World* world)
+    : _world(world), _time(0.0), _sequence(0), _resumed(0), _wheelTick(0)
+{ }
+
+ScriptScheduler::~ScriptScheduler()
+{
+    this->clear();
+}
+
+void ScriptScheduler::start(Script&& script)
+{
+    auto handle = script._handle;
+    if (!handle) return;
+    script._handle = nullptr;
+
+    handle.promise()._task = int(this->_tasks.size());
+    handle.promise()._sequence = this->_sequence++;
+    this->_tasks.push_back(handle);
+    this->_ready.push_back(handle);
+}
+
+void ScriptScheduler::update(float diff)
+{
+    auto tick = this->_world->tick();
+
+    this->_running.swap(this->_ready);
+
+    // The wheel only works for ticks one after the other, after a restore the waits go in the queue
+    if (tick != this->_wheelTick)
+    {
+        for (auto& slot : this->_tickWheel)
+        {
+            for (auto& wait : slot) this->_tickWaits.push_back(wait);
+            slot.clear();
+        }
+        std::make_heap(this->_tickWaits.begin(), this->_tickWaits.end(), ScriptScheduler::wakesLater);
+    }
+    this->_wheelTick = tick + 1;
+
+    auto& slot = this->_tickWheel[tick % SCRIPT_TICK_WHEEL_SIZE];
+    for (auto& wait : slot) this->_running.push_back(wait.handle);
+    slot.clear();
+
+    while (!this->_tickWaits.empty() && this->_tickWaits.front().tick <= tick)
+    {
+        std::pop_heap(this->_tickWaits.begin(), this->_tickWaits.end(), ScriptScheduler::wakesLater);
+        this->_running.push_back(this->_tickWaits.back().handle);
+        this->_tickWaits.pop_back();
+    }
+    while (!this->_timeWaits.empty() && this->_timeWaits.front().time <= this->_time + SCRIPT_TIME_EPSILON)
+    {
+        std::pop_heap(this->_timeWaits.begin(), this->_timeWaits.end(), ScriptScheduler::wakesLater);
+        this->_running.push_back(this->_timeWaits.back().handle);
+        this->_timeWaits.pop_back();
+    }
+
+    int waiting = 0;
+    for (auto& arrival : this->_arrivals)
+    {
+        if (this->hasArrived(arrival.first)) this->_running.push_back(arrival.second);
+        else this->_arrivals[waiting++] = arrival;
+    }
+    this->_arrivals.resize(waiting);
+
+    // Usually only one kind of wait is due and the scripts are in order already
+    auto slept = [] (const Script::Handle& a, const Script::Handle& b) {
+        return a.promise()._sequence < b.promise()._sequence;
+    };
+    if (!std::is_sorted(this->_running.begin(), this->_running.end(), slept))
+    {
+        std::sort(this->_running.begin(), this->_running.end(), slept);
+    }
+
+    // Scripts woken by the scripts running now wait for the next update
+    for (auto handle : this->_running) this->resume(handle);
+    this->_running.clear();
+
+    this->_time += diff;
+}
+
+void ScriptScheduler::clear()
+{
+    for (auto handle : this->_tasks) handle.destroy();
+
+    this->_tasks.clear();
+    for (auto& slot : this->_tickWheel) slot.clear();
+    this->_tickWaits.clear();
+    this->_timeWaits.clear();
+    this->_arrivals.clear();
+    this->_events.clear();
+    this->_ready.clear();
+    this->_running.clear();
+}
+
+ScriptWait ScriptScheduler::nextTick()
+{
+    return this->ticks(1);
+}
+
+ScriptWait ScriptScheduler::ticks(unsigned int count)
+{
+    return ScriptWait(this, ScriptWait::Kinds::Ticks, this->_world->tick() + count, 0.0, 0);
+}
+
+ScriptWait ScriptScheduler::seconds(float seconds)
+{
+    return ScriptWait(this, ScriptWait::Kinds::Seconds, 0, this->_time + seconds, 0);
+}
+
+ScriptWait ScriptScheduler::arrival(PlayerHandle player)
+{
+    return ScriptWait(this, ScriptWait::Kinds::Arrival, 0, 0.0, player);
+}
+
+ScriptWait ScriptScheduler::event(int event)
+{
+    return ScriptWait(this, ScriptWait::Kinds::Event, 0, 0.0, event);
+}
+
+void ScriptScheduler::fire(int event)
+{
+    auto found = this->_events.find(event);
+    if (found == this->_events.end()) return;
+
+    this->_ready.insert(this->_ready.end(), found->second.begin(), found->second.end());
+    this->_events.erase(found);
+}
+
+int ScriptScheduler::count() const
+{
+    return int(this->_tasks.size());
+}
+
+unsigned int ScriptScheduler::resumed() const
+{
+    return this->_resumed;
+}
+
+ScriptFramePool& ScriptScheduler::pool()
+{
+    return this->_pool;
+}
+
+void ScriptScheduler::wait(Script::Handle handle, ScriptWait::Kinds kind, unsigned int tick, double time, int value)
+{
+    handle.promise()._sequence = this->_sequence++;
+
+    switch (kind)
+    {
+    case ScriptWait::Kinds::Ticks:
+    case ScriptWait::Kinds::Seconds:
+    {
+        TimedWait wait = { tick, time, handle.promise()._sequence, handle };
+        if (kind == ScriptWait::Kinds::Ticks && tick - this->_world->tick() < SCRIPT_TICK_WHEEL_SIZE)
+        {
+            this->_tickWheel[tick % SCRIPT_TICK_WHEEL_SIZE].push_back(wait);
+            break;
+        }
+
+        auto& waits = (kind == ScriptWait::Kinds::Ticks ? this->_tickWaits : this->_timeWaits);
+        waits.push_back(wait);
+        std::push_heap(waits.begin(), waits.end(), ScriptScheduler::wakesLater);
+        break;
+    }
+    case ScriptWait::Kinds::Arrival:
+        this->_arrivals.push_back(std::make_pair(value, handle));
+        break;
+    case ScriptWait::Kinds::Event:
+        this->_events[value].push_back(handle);
+        break;
+    }
+}
+
+bool ScriptScheduler::wakesLater(const TimedWait& a, const TimedWait& b)
+{
+    if (a.tick != b.tick) return a.tick > b.tick;
+    if (a.time != b.time) return a.time > b.time;
+    return a.sequence > b.sequence;
+}
+
+// Dead or removed players do not walk anywhere anymore, scripts waiting for them go on
+bool ScriptScheduler::hasArrived(PlayerHandle player)
+{
+    auto found = this->_world->players().player(player);
+    return found == nullptr || found->health() <= 0.0f || !found->hasPath();
+}
+
+void ScriptScheduler::resume(Script::Handle handle)
+{
+    this->_resumed++;
+    handle.resume();
+    if (handle.done()) this->finish(handle);
+}
+
+void ScriptScheduler::finish(Script::Handle handle)
+{
+    int task = handle.promise()._task;
+    this->_tasks[task] = this->_tasks.back();
+    this->_tasks[task].promise()._task = task;
+    this->_tasks.pop_back();
+
+    handle.destroy();
+}
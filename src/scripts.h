@@ -0,0 +1,192 @@
+#ifndef SCRIPTS_H
+#define SCRIPTS_H
+
+#include <coroutine>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "player-storage.h"
+
+// Frames of scripts come in size classes from 128 bytes up to 4 KiB, bigger ones come from the heap
+#define SCRIPT_FRAME_MIN_SIZE 128
+#define SCRIPT_FRAME_SIZE_CLASSES 6
+#define SCRIPT_FRAMES_PER_PAGE 64
+
+// Scripts sleeping fewer ticks than this go in the slot of the tick they wake up in, the others in a queue
+#define SCRIPT_TICK_WHEEL_SIZE 64
+
+// Scripts waiting for seconds wake up this much early, so tick lengths adding up to the time do not miss it
+#define SCRIPT_TIME_EPSILON 1e-6
+
+// Coroutine frames of the scripts of one world, in pages of equally sized blocks. Freed
+// blocks go on the free list of their size class, so once the pool is warm starting and
+// finishing scripts does not touch the heap. Only used by the thread updating the world.
+class ScriptFramePool
+{
+public:
+    ScriptFramePool();
+    virtual ~ScriptFramePool();
+
+    void* allocate(size_t size);
+    void release(void* frame, size_t size);
+
+    // Blocks handed out and pages allocated for them, frames from the heap are not counted
+    int liveFrames() const;
+    int pageCount() const;
+
+private:
+    void* _free[SCRIPT_FRAME_SIZE_CLASSES];
+    std::vector<char*> _pages;
+    int _liveFrames;
+
+    static int sizeClass(size_t size);
+};
+
+// A behaviour written as a coroutine returning Script. It does nothing until it is started on
+// the ScriptScheduler of a world, then runs on the updating thread until it co_awaits ticks,
+// seconds, a player arriving at the end of its path or an event. Scripts taking the World as
+// their first parameter get their frame from the pool of that world.
+class Script
+{
+public:
+    class promise_type
+    {
+    public:
+        promise_type();
+
+        Script get_return_object();
+        std::suspend_always initial_suspend() noexcept;
+        std::suspend_always final_suspend() noexcept;
+        void return_void();
+        void unhandled_exception();
+
+        template <class... Args>
+        static void* operator new(size_t size, class World& world, Args&...)
+        {
+            return promise_type::allocateFrame(size, &world);
+        }
+
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size);
+
+        // Index in the tasks of the scheduler and when the script last went to sleep
+        int _task;
+        unsigned int _sequence;
+
+    private:
+        static void* allocateFrame(size_t size, class World* world);
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Script(Handle handle);
+    Script(Script&& other);
+    virtual ~Script();
+
+private:
+    Handle _handle;
+
+    friend class ScriptScheduler;
+};
+
+// Suspends the script and hands it to the scheduler, which resumes it when what it waits for happened
+class ScriptWait
+{
+public:
+    enum class Kinds
+    {
+        Ticks,
+        Seconds,
+        Arrival,
+        Event
+    };
+
+    ScriptWait(class ScriptScheduler* scheduler, Kinds kind, unsigned int tick, double time, int value);
+
+    bool await_ready() const;
+    void await_suspend(Script::Handle handle);
+    void await_resume() const;
+
+private:
+    class ScriptScheduler* _scheduler;
+    Kinds _kind;
+    unsigned int _tick;
+    double _time;
+    int _value;
+};
+
+// Runs the scripts of one world. Scripts waiting a few ticks sit in a wheel with a slot per tick,
+// the ones waiting longer or for seconds in queues ordered by when they wake up, so a tick only
+// touches the scripts that are due. Scripts waiting for a player
+// are checked once per tick and scripts waiting for an event when it fires. Scripts woken in the
+// same tick resume in the order they went to sleep, which keeps the world deterministic.
+//
+// Script frames cannot be written to the world state. Snapshots and replays restore the players,
+// the scripts running on them have to be started again.
+class ScriptScheduler
+{
+public:
+    ScriptScheduler(class World* world);
+    virtual ~ScriptScheduler();
+
+    // Takes the script over, it runs up to its first co_await in the next update
+    void start(Script&& script);
+
+    // Resumes the scripts that are due, called by the world at the start of every tick
+    void update(float diff);
+
+    // Destroys all scripts wherever they are waiting
+    void clear();
+
+    // Awaitables for scripts of this world
+    ScriptWait nextTick();
+    ScriptWait ticks(unsigned int count);
+    ScriptWait seconds(float seconds);
+    ScriptWait arrival(PlayerHandle player);
+    ScriptWait event(int event);
+
+    // Wakes every script waiting for the event, they resume in the next update
+    void fire(int event);
+
+    int count() const;
+    unsigned int resumed() const;
+    ScriptFramePool& pool();
+
+private:
+    class World* _world;
+    ScriptFramePool _pool;
+    double _time;
+    unsigned int _sequence;
+    unsigned int _resumed;
+
+    // Every script that was started and did not finish yet, the promise knows its index
+    std::vector<Script::Handle> _tasks;
+
+    typedef struct sTimedWait
+    {
+        unsigned int tick;
+        double time;
+        unsigned int sequence;
+        Script::Handle handle;
+    } TimedWait;
+
+    std::vector<TimedWait> _tickWheel[SCRIPT_TICK_WHEEL_SIZE];
+    unsigned int _wheelTick;
+    std::vector<TimedWait> _tickWaits;
+    std::vector<TimedWait> _timeWaits;
+    std::vector<std::pair<PlayerHandle, Script::Handle> > _arrivals;
+    std::unordered_map<int, std::vector<Script::Handle> > _events;
+    std::vector<Script::Handle> _ready;
+    std::vector<Script::Handle> _running;
+
+    static bool wakesLater(const TimedWait& a, const TimedWait& b);
+    void wait(Script::Handle handle, ScriptWait::Kinds kind, unsigned int tick, double time, int value);
+    bool hasArrived(PlayerHandle player);
+    void resume(Script::Handle handle);
+    void finish(Script::Handle handle);
+
+    friend class ScriptWait;
+};
+
+#endif // SCRIPTS_H
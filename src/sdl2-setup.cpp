@@ -63,6 +63,7 @@ int SDLProgram::Run(int argc, char* argv[])
 //        SDL_ShowCursor(SDL_FALSE);
 
         SDL_Event event;
+        auto lastFrameTime = this->elapsed();
         while (this->keepRunning)
         {
             while (SDL_PollEvent(&event))
@@ -89,6 +90,12 @@ int SDLProgram::Run(int argc, char* argv[])
             }
             SDL_PumpEvents();
 
+            // The simulation runs at a fixed tick rate, independent of how fast we render
+            auto frameTime = this->elapsed();
+            int ticks = this->timestep.advance(frameTime - lastFrameTime);
+            lastFrameTime = frameTime;
+            for (int i = 0; i < ticks; i++) this->Update(this->timestep.tickLength());
+
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
             this->Render();
@@ -105,6 +112,9 @@ int SDLProgram::Run(int argc, char* argv[])
     return 0;
 }
 
+void SDLProgram::Update(float tickLength)
+{ }
+
 const IInput* SDLProgram::input() const
 {
     return &this->_input;
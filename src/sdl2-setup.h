@@ -6,6 +6,7 @@
 #endif
 #include <SDL.h>
 #include "input.h"
+#include "fixed-timestep.h"
 
 #include <string>
 #include <vector>
@@ -20,6 +21,9 @@ public:
 
 protected:
     virtual bool SetUp() = 0;
+
+    // Called timestep.tickRate() times per second with the length of one tick, before Render
+    virtual void Update(float tickLength);
     virtual void Render() = 0;
     virtual void CleanUp() = 0;
     virtual void OnResize(int width, int height) = 0;
@@ -31,6 +35,7 @@ protected:
     std::string title;
     std::vector<std::string> args;
     bool keepRunning;
+    FixedTimestep timestep;
 
 private:
     SDL_Window* _window;
@@ -0,0 +1,92 @@
+#include "spatial-grid.h"
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : _cellSize(cellSize), _activeCellSize(cellSize), _originX(0.0f), _originY(0.0f), _columns(0), _rows(0)
+{ }
+
+SpatialGrid::~SpatialGrid() { }
+
+void SpatialGrid::build(const std::vector<float>& x, const std::vector<float>& y)
+{
+    this->clear();
+
+    int count = int(std::min(x.size(), y.size()));
+    if (count == 0) return;
+
+    float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (int i = 1; i < count; i++)
+    {
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+    }
+
+    // The grid only spans the points, when they are spread out too far the cells grow instead of the grid
+    this->_originX = minX;
+    this->_originY = minY;
+    double maxCells = std::min(SPATIAL_GRID_MAX_CELLS, std::max(count * SPATIAL_GRID_CELLS_PER_POINT, SPATIAL_GRID_MIN_CELLS));
+    while (double((maxX - minX) / this->_activeCellSize + 1.0f) * double((maxY - minY) / this->_activeCellSize + 1.0f) > maxCells)
+    {
+        this->_activeCellSize *= 2.0f;
+    }
+    this->_columns = this->cellX(maxX) + 1;
+    this->_rows = this->cellY(maxY) + 1;
+
+    // Counting sort on the cell of every point, the buffers keep their capacity between builds
+    this->_cells.resize(count);
+    this->_cellStart.assign(this->_columns * this->_rows + 1, 0);
+    for (int i = 0; i < count; i++)
+    {
+        this->_cells[i] = this->cellY(y[i]) * this->_columns + this->cellX(x[i]);
+        this->_cellStart[this->_cells[i] + 1]++;
+    }
+    for (int c = 0; c < this->_columns * this->_rows; c++) this->_cellStart[c + 1] += this->_cellStart[c];
+
+    // Filling from the end of every cell leaves the start of cell c in entry c + 1
+    this->_items.resize(count);
+    for (int i = count - 1; i >= 0; i--) this->_items[--this->_cellStart[this->_cells[i] + 1]] = i;
+    for (int c = 0; c < this->_columns * this->_rows; c++) this->_cellStart[c] = this->_cellStart[c + 1];
+    this->_cellStart[this->_columns * this->_rows] = count;
+}
+
+void SpatialGrid::clear()
+{
+    this->_activeCellSize = this->_cellSize;
+    this->_columns = this->_rows = 0;
+    this->_cellStart.clear();
+    this->_items.clear();
+}
+
+float SpatialGrid::cellSize() const
+{
+    return this->_activeCellSize;
+}
+
+int SpatialGrid::cellCount() const
+{
+    return this->_columns * this->_rows;
+}
+
+int SpatialGrid::size() const
+{
+    return int(this->_items.size());
+}
+
+const std::vector<int>& SpatialGrid::items() const
+{
+    return this->_items;
+}
+
+std::vector<int> SpatialGrid::query(const std::vector<float>& x, const std::vector<float>& y, float px, float py, float radius) const
+{
+    std::vector<int> result;
+    this->visit(px, py, radius, [&] (int i) {
+        float dx = x[i] - px, dy = y[i] - py;
+        if (dx * dx + dy * dy < radius * radius) result.push_back(i);
+        return true;
+    });
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
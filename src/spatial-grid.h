@@ -0,0 +1,87 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#define SPATIAL_GRID_MAX_CELLS (1 << 20)
+
+// Sparse points do not need a cell each, building the grid costs as much as it has cells
+#define SPATIAL_GRID_CELLS_PER_POINT 4
+#define SPATIAL_GRID_MIN_CELLS 1024
+
+// Uniform grid over a set of points, rebuilt from scratch with a counting sort. The points
+// of one cell are stored next to each other, so a query only touches the cells overlapping
+// its radius. Queries return candidates, the caller still tests the exact distance.
+class SpatialGrid
+{
+public:
+    SpatialGrid(float cellSize);
+    virtual ~SpatialGrid();
+
+    void build(const std::vector<float>& x, const std::vector<float>& y);
+    void clear();
+
+    float cellSize() const;
+    int cellCount() const;
+    int size() const;
+
+    // Calls visitor(index) for every point in the cells overlapping the circle, stops when it returns false
+    template <class TVisitor>
+    void visit(float x, float y, float radius, TVisitor visitor) const
+    {
+        if (this->_items.empty()) return;
+
+        int fromX = std::max(0, this->cellX(x - radius)), toX = std::min(this->_columns - 1, this->cellX(x + radius));
+        int fromY = std::max(0, this->cellY(y - radius)), toY = std::min(this->_rows - 1, this->cellY(y + radius));
+
+        for (int cy = fromY; cy <= toY; cy++)
+        {
+            for (int cx = fromX; cx <= toX; cx++)
+            {
+                int cell = cy * this->_columns + cx;
+                for (int i = this->_cellStart[cell]; i < this->_cellStart[cell + 1]; i++)
+                {
+                    if (!visitor(this->_items[i])) return;
+                }
+            }
+        }
+    }
+
+    // Calls visitor(first, last) with the range of items() of every row of cells overlapping the circle
+    template <class TVisitor>
+    void visitCells(float x, float y, float radius, TVisitor visitor) const
+    {
+        if (this->_items.empty()) return;
+
+        int fromX = std::max(0, this->cellX(x - radius)), toX = std::min(this->_columns - 1, this->cellX(x + radius));
+        int fromY = std::max(0, this->cellY(y - radius)), toY = std::min(this->_rows - 1, this->cellY(y + radius));
+
+        for (int cy = fromY; cy <= toY; cy++)
+        {
+            int row = cy * this->_columns;
+            if (this->_cellStart[row + fromX] < this->_cellStart[row + toX + 1]) visitor(this->_cellStart[row + fromX], this->_cellStart[row + toX + 1]);
+        }
+    }
+
+    // The indices of the points ordered by cell, the points of one cell are next to each other
+    const std::vector<int>& items() const;
+
+    // Indices of all points within the radius, in ascending order
+    std::vector<int> query(const std::vector<float>& x, const std::vector<float>& y, float px, float py, float radius) const;
+
+private:
+    float _cellSize;
+    float _activeCellSize;
+    float _originX, _originY;
+    int _columns, _rows;
+    std::vector<int> _cellStart;
+    std::vector<int> _items;
+    std::vector<int> _cells;
+
+    int cellX(float x) const { return int(std::floor((x - this->_originX) / this->_activeCellSize)); }
+    int cellY(float y) const { return int(std::floor((y - this->_originY) / this->_activeCellSize)); }
+};
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,130 @@
+#include "state-buffer.h"
+
+StateWriter::StateWriter(std::vector<unsigned char>& data) : _data(data) { }
+
+void StateWriter::writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        this->_data.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    this->_data.push_back((unsigned char)value);
+}
+
+void StateWriter::writeSigned(int64_t value)
+{
+    this->writeVarint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+void StateWriter::writeBytes(const void* data, size_t size)
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    this->_data.insert(this->_data.end(), bytes, bytes + size);
+}
+
+void StateWriter::writeString(const std::string& value)
+{
+    this->writeVarint(value.size());
+    this->writeBytes(value.data(), value.size());
+}
+
+std::vector<unsigned char>& StateWriter::data()
+{
+    return this->_data;
+}
+
+StateReader::StateReader(const unsigned char* data, size_t size)
+    : _data(data), _size(size), _pos(0), _failed(false)
+{ }
+
+uint64_t StateReader::readVarint()
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (this->_pos >= this->_size)
+        {
+            this->fail();
+            return 0;
+        }
+
+        auto byte = this->_data[this->_pos++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+
+    this->fail();
+    return 0;
+}
+
+int64_t StateReader::readSigned()
+{
+    auto value = this->readVarint();
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+bool StateReader::readBytes(void* data, size_t size)
+{
+    if (this->_failed || size > this->_size - this->_pos) return this->fail();
+
+    std::memcpy(data, this->_data + this->_pos, size);
+    this->_pos += size;
+    return true;
+}
+
+std::string StateReader::readString()
+{
+    std::string value;
+    this->readString(value);
+    return value;
+}
+
+// Assigns in place, so restoring into the same strings again does not allocate
+bool StateReader::readString(std::string& value)
+{
+    auto size = this->readVarint();
+    if (this->_failed || size > this->_size - this->_pos)
+    {
+        value.clear();
+        return this->fail();
+    }
+
+    value.assign(reinterpret_cast<const char*>(this->_data + this->_pos), size_t(size));
+    this->_pos += size_t(size);
+    return true;
+}
+
+bool StateReader::skip(size_t size)
+{
+    if (this->_failed || size > this->_size - this->_pos) return this->fail();
+
+    this->_pos += size;
+    return true;
+}
+
+size_t StateReader::position() const
+{
+    return this->_pos;
+}
+
+size_t StateReader::remaining() const
+{
+    return this->_size - this->_pos;
+}
+
+bool StateReader::isAtEnd() const
+{
+    return this->_pos >= this->_size;
+}
+
+bool StateReader::failed() const
+{
+    return this->_failed;
+}
+
+bool StateReader::fail()
+{
+    this->_failed = true;
+    return false;
+}
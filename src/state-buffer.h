@@ -0,0 +1,88 @@
+#ifndef STATE_BUFFER_H
+#define STATE_BUFFER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Appends binary data to a byte buffer. Integers are written as LEB128 varints, signed
+// ones zigzag encoded first, so small numbers take a single byte. Everything else is
+// copied as is, the buffers are only read back on machines with the same byte order.
+class StateWriter
+{
+public:
+    StateWriter(std::vector<unsigned char>& data);
+
+    void writeVarint(uint64_t value);
+    void writeSigned(int64_t value);
+    void writeBytes(const void* data, size_t size);
+    void writeString(const std::string& value);
+
+    template <class T>
+    void writeRaw(const T& value)
+    {
+        this->writeBytes(&value, sizeof(T));
+    }
+
+    // Element count followed by the raw elements, only for plain data
+    template <class T>
+    void writeArray(const std::vector<T>& values)
+    {
+        this->writeVarint(values.size());
+        if (!values.empty()) this->writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    std::vector<unsigned char>& data();
+
+private:
+    std::vector<unsigned char>& _data;
+};
+
+// Reads what a StateWriter wrote. Reading past the end does not crash, it
+// returns zeroes and marks the reader as failed.
+class StateReader
+{
+public:
+    StateReader(const unsigned char* data, size_t size);
+
+    uint64_t readVarint();
+    int64_t readSigned();
+    bool readBytes(void* data, size_t size);
+    std::string readString();
+    bool readString(std::string& value);
+    bool skip(size_t size);
+
+    template <class T>
+    T readRaw()
+    {
+        T value;
+        if (!this->readBytes(&value, sizeof(T))) std::memset(&value, 0, sizeof(T));
+        return value;
+    }
+
+    template <class T>
+    bool readArray(std::vector<T>& values)
+    {
+        auto count = this->readVarint();
+        if (this->_failed || count > this->remaining() / sizeof(T)) return this->fail();
+
+        values.resize(size_t(count));
+        return count == 0 || this->readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    size_t position() const;
+    size_t remaining() const;
+    bool isAtEnd() const;
+    bool failed() const;
+
+private:
+    const unsigned char* _data;
+    size_t _size;
+    size_t _pos;
+    bool _failed;
+
+    bool fail();
+};
+
+#endif // STATE_BUFFER_H
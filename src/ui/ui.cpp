@@ -439,13 +439,14 @@ class Player* PlayerButton::player()
     return this->_player;
 }
 
+void PlayerButton::showKilled()
+{
+    this->setIcon(eFontAwesomeIcons::FA_CLOSE);
+    this->setColor(glm::vec4(255, 0, 0, 255));
+}
+
 void PlayerButton::render(NVGcontext* vg, float scale)
 {
-    if (this->player()->_health <= 0.0f && this->icon() != eFontAwesomeIcons::FA_CLOSE)
-    {
-        this->setIcon(eFontAwesomeIcons::FA_CLOSE);
-        this->setColor(glm::vec4(255, 0, 0, 255));
-    }
     Button::render(vg, scale);
 
     nvgSave(vg);
@@ -453,7 +454,7 @@ void PlayerButton::render(NVGcontext* vg, float scale)
     nvgTranslate(vg, this->_position.x, this->_position.y);
     nvgScale(vg, scale * this->_scale, scale * this->_scale);
 
-    if (Player::Manager()._selectedPlayer == this->player())
+    if (this->player()->manager()->_selectedPlayer == this->player())
     {
         nvgBeginPath(vg);
         nvgRoundedRect(vg, -(this->size().x / 2.0f), -(this->size().y / 2.0f), this->size().x, this->size().y, 4.0f);
@@ -115,6 +115,9 @@ public:
 
     virtual void render(NVGcontext* vg, float scale);
 
+    // Switches to the killed icon, called when the PlayerKilled event comes in
+    void showKilled();
+
     class Player* player();
 };
 
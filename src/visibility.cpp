@@ -0,0 +1,218 @@
+#include "visibility.h"
+#include <algorithm>
+
+PotentiallyVisibleSet::PotentiallyVisibleSet()
+    : _width(0), _height(0), _regionSize(PVS_REGION_SIZE), _regionsX(0), _regionsY(0), _wordsPerRow(0)
+{ }
+
+PotentiallyVisibleSet::~PotentiallyVisibleSet() { }
+
+void PotentiallyVisibleSet::clear()
+{
+    this->_regionsX = this->_regionsY = this->_wordsPerRow = 0;
+    this->_bits.clear();
+    this->_reaches.clear();
+    this->_transparent.clear();
+    this->_reached.clear();
+}
+
+void PotentiallyVisibleSet::build(int width, int height, std::function<bool (const tPosition&)> isTransparent)
+{
+    this->clear();
+    if (width <= 0 || height <= 0) return;
+
+    this->_width = width;
+    this->_height = height;
+
+    // Bigger levels get bigger regions to keep the number of region pairs in check
+    int largest = std::max(width, height);
+    this->_regionSize = std::max(PVS_REGION_SIZE, (largest + PVS_MAX_REGIONS_PER_AXIS - 1) / PVS_MAX_REGIONS_PER_AXIS);
+    this->_regionsX = (width + this->_regionSize - 1) / this->_regionSize;
+    this->_regionsY = (height + this->_regionSize - 1) / this->_regionSize;
+    this->_wordsPerRow = (this->regionCount() + 31) / 32;
+
+    this->rebuild(isTransparent);
+}
+
+void PotentiallyVisibleSet::update(std::function<bool (const tPosition&)> isTransparent, const tPosition& from, const tPosition& to)
+{
+    if (this->isEmpty()) return;
+
+    int width = this->_width, height = this->_height;
+    int left = std::max(0, std::min(from.x, to.x)), top = std::max(0, std::min(from.y, to.y));
+    int right = std::min(width - 1, std::max(from.x, to.x)), bottom = std::min(height - 1, std::max(from.y, to.y));
+    if (left > right || top > bottom) return;
+
+    for (int y = top; y <= bottom; y++)
+    {
+        for (int x = left; x <= right; x++)
+        {
+            tPosition position = { x, y };
+            this->_transparent[y * width + x] = isTransparent(position) ? 1 : 0;
+        }
+    }
+
+    // Where a flood first comes out different it reaches a changed tile it did not before, or the
+    // other way around. So it reached that tile or the tile it came from, which is at most one tile
+    // outside of the changed ones, or the tile is in the flooded region itself.
+    int fromRegionX = std::max(0, left - 1) / this->_regionSize, toRegionX = std::min(width - 1, right + 1) / this->_regionSize;
+    int fromRegionY = std::max(0, top - 1) / this->_regionSize, toRegionY = std::min(height - 1, bottom + 1) / this->_regionSize;
+    for (int r = 0; r < this->regionCount(); r++)
+    {
+        bool changed = false;
+        for (int y = fromRegionY; y <= toRegionY && !changed; y++)
+        {
+            for (int x = fromRegionX; x <= toRegionX && !changed; x++)
+            {
+                int toRegion = y * this->_regionsX + x;
+                changed = toRegion == r || this->reaches(r, toRegion);
+            }
+        }
+        if (!changed) continue;
+
+        std::fill(&this->_reaches[r * this->_wordsPerRow], &this->_reaches[r * this->_wordsPerRow] + this->_wordsPerRow, 0u);
+        this->floodRegion(r);
+    }
+
+    this->combine();
+}
+
+void PotentiallyVisibleSet::rebuild(std::function<bool (const tPosition&)>& isTransparent)
+{
+    int width = this->_width, height = this->_height;
+    this->_reaches.assign(this->regionCount() * this->_wordsPerRow, 0);
+    this->_transparent.resize(width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            tPosition position = { x, y };
+            this->_transparent[y * width + x] = isTransparent(position) ? 1 : 0;
+        }
+    }
+
+    for (int r = 0; r < this->regionCount(); r++) this->floodRegion(r);
+    this->combine();
+}
+
+// A pair is potentially visible when the flood out of either region reached the other
+void PotentiallyVisibleSet::combine()
+{
+    this->_bits.assign(this->regionCount() * this->_wordsPerRow, 0);
+    for (int a = 0; a < this->regionCount(); a++)
+    {
+        for (int b = 0; b < this->regionCount(); b++)
+        {
+            if (!this->reaches(a, b)) continue;
+
+            this->set(a, b, true);
+            this->set(b, a, true);
+        }
+    }
+
+    // Neighbouring regions that both have something to see are always potentially visible
+    for (int a = 0; a < this->regionCount(); a++)
+    {
+        if (!this->potentiallyVisible(a, a)) continue;
+
+        int ax = a % this->_regionsX, ay = a / this->_regionsX;
+        for (int by = std::max(0, ay - 1); by <= std::min(this->_regionsY - 1, ay + 1); by++)
+        {
+            for (int bx = std::max(0, ax - 1); bx <= std::min(this->_regionsX - 1, ax + 1); bx++)
+            {
+                int b = by * this->_regionsX + bx;
+                if (this->potentiallyVisible(b, b)) this->set(a, b, true);
+            }
+        }
+    }
+}
+
+// Every line of sight from a tile of the region walks through transparent tiles that only
+// ever step away from it along x and y, one step at a time or through a corner with an open
+// side. Flooding such paths from the whole region in each quadrant reaches every tile a line
+// of sight from the region can reach, and some more, so the set never rejects a visible pair.
+void PotentiallyVisibleSet::floodRegion(int region)
+{
+    int width = this->_width, height = this->_height;
+    int left = (region % this->_regionsX) * this->_regionSize, top = (region / this->_regionsX) * this->_regionSize;
+    int right = std::min(left + this->_regionSize, width), bottom = std::min(top + this->_regionSize, height);
+    this->_reached.resize(width * height);
+
+    for (int quadrant = 0; quadrant < 4; quadrant++)
+    {
+        int stepX = (quadrant & 1) ? -1 : 1, stepY = (quadrant & 2) ? -1 : 1;
+        int startX = stepX > 0 ? left : right - 1, endX = stepX > 0 ? width : -1;
+        int startY = stepY > 0 ? top : bottom - 1, endY = stepY > 0 ? height : -1;
+
+        for (int y = startY; y != endY; y += stepY)
+        {
+            int toRegionY = (y / this->_regionSize) * this->_regionsX;
+            for (int x = startX; x != endX; x += stepX)
+            {
+                int tile = y * width + x;
+                bool reached = false;
+                if (this->_transparent[tile])
+                {
+                    reached = (x >= left && x < right && y >= top && y < bottom) ||
+                            (x != startX && this->_reached[tile - stepX]) ||
+                            (y != startY && this->_reached[tile - stepY * width]);
+                }
+                this->_reached[tile] = reached ? 1 : 0;
+                if (!reached) continue;
+
+                int toRegion = toRegionY + x / this->_regionSize;
+                this->_reaches[region * this->_wordsPerRow + (toRegion >> 5)] |= (1u << (toRegion & 31));
+            }
+        }
+    }
+}
+
+bool PotentiallyVisibleSet::reaches(int fromRegion, int toRegion) const
+{
+    return (this->_reaches[fromRegion * this->_wordsPerRow + (toRegion >> 5)] & (1u << (toRegion & 31))) != 0;
+}
+
+void PotentiallyVisibleSet::set(int fromRegion, int toRegion, bool visible)
+{
+    auto& word = this->_bits[fromRegion * this->_wordsPerRow + (toRegion >> 5)];
+    if (visible) word |= (1u << (toRegion & 31));
+    else word &= ~(1u << (toRegion & 31));
+}
+
+bool PotentiallyVisibleSet::isEmpty() const
+{
+    return this->_bits.empty();
+}
+
+int PotentiallyVisibleSet::regionSize() const
+{
+    return this->_regionSize;
+}
+
+int PotentiallyVisibleSet::regionCount() const
+{
+    return this->_regionsX * this->_regionsY;
+}
+
+int PotentiallyVisibleSet::region(const tPosition& position) const
+{
+    if (position.x < 0 || position.x >= this->_width || position.y < 0 || position.y >= this->_height) return -1;
+
+    return (position.y / this->_regionSize) * this->_regionsX + (position.x / this->_regionSize);
+}
+
+bool PotentiallyVisibleSet::potentiallyVisible(int fromRegion, int toRegion) const
+{
+    // Without a set we cannot reject anything
+    if (this->isEmpty()) return true;
+    if (fromRegion < 0 || toRegion < 0) return false;
+
+    return (this->_bits[fromRegion * this->_wordsPerRow + (toRegion >> 5)] & (1u << (toRegion & 31))) != 0;
+}
+
+bool PotentiallyVisibleSet::potentiallyVisible(const tPosition& from, const tPosition& to) const
+{
+    if (this->isEmpty()) return true;
+
+    return this->potentiallyVisible(this->region(from), this->region(to));
+}
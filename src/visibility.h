@@ -0,0 +1,192 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include <functional>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include "astar.h"
+
+#define PVS_REGION_SIZE 16
+#define PVS_MAX_REGIONS_PER_AXIS 16
+
+// Walks the tiles crossed by a segment through the grid (Amanatides and Woo), from the tile it
+// starts in until it enters a blocking tile. The segment is measured in any unit from 0 to end,
+// tMax is where it crosses the next vertical and horizontal tile edge and tDelta how far apart
+// these edges are. An axis the segment does not move along has its tMax past the end. Returns
+// true when a blocking tile is entered and sets hit to where. When the segment passes exactly
+// through a corner, it is only blocked when both tiles next to that corner block it.
+template <class T, class TIsBlocking>
+bool obj_WalkTiles(tPosition tile, int stepX, int stepY, T tMaxX, T tMaxY, T tDeltaX, T tDeltaY, T end, TIsBlocking isBlocking, T& hit)
+{
+    while (tMaxX <= end || tMaxY <= end)
+    {
+        T t;
+        if (tMaxX < tMaxY)
+        {
+            t = tMaxX;
+            tile.x += stepX;
+            tMaxX += tDeltaX;
+        }
+        else if (tMaxY < tMaxX)
+        {
+            t = tMaxY;
+            tile.y += stepY;
+            tMaxY += tDeltaY;
+        }
+        else
+        {
+            // Exactly through a corner
+            t = tMaxX;
+            tPosition sideX = { tile.x + stepX, tile.y }, sideY = { tile.x, tile.y + stepY };
+            if (isBlocking(sideX) && isBlocking(sideY))
+            {
+                hit = t;
+                return true;
+            }
+            tile.x += stepX;
+            tile.y += stepY;
+            tMaxX += tDeltaX;
+            tMaxY += tDeltaY;
+        }
+
+        if (isBlocking(tile))
+        {
+            hit = t;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Walks all tiles on the line between the centers of the two given tiles and returns false as
+// soon as one of them is not transparent, see obj_WalkTiles
+template <class TIsTransparent>
+bool obj_HasLineOfSight(const tPosition& from, const tPosition& to, TIsTransparent isTransparent)
+{
+    if (!isTransparent(from)) return false;
+
+    // Measure the line in integers by scaling it with 2 * |dx| * |dy|, the edges are then crossed
+    // at (1 + 2i) * |dy| and (1 + 2j) * |dx|. Straight lines scale the other axis with 1 instead.
+    long long dx = std::abs(to.x - from.x), dy = std::abs(to.y - from.y);
+    long long scaleX = dx != 0 ? dx : 1, scaleY = dy != 0 ? dy : 1;
+    long long end = 2 * scaleX * scaleY;
+    long long tMaxX = dx != 0 ? scaleY : end + 1, tMaxY = dy != 0 ? scaleX : end + 1;
+
+    long long hit;
+    return !obj_WalkTiles(from, to.x > from.x ? 1 : -1, to.y > from.y ? 1 : -1, tMaxX, tMaxY, 2 * scaleY, 2 * scaleX, end,
+                          [&isTransparent] (const tPosition& position) { return !isTransparent(position); }, hit);
+}
+
+// One octant of obj_CastShadows, rows of tiles outwards from the origin between the two slopes.
+// The multipliers map the octant onto the level.
+template <class TIsTransparent, class TVisit>
+void obj_CastShadowsInOctant(const tPosition& origin, int radius, int row, float start, float end,
+                             int xx, int xy, int yx, int yy, TIsTransparent& isTransparent, TVisit& visit)
+{
+    if (start < end) return;
+
+    float nextStart = start;
+    for (int j = row; j <= radius; j++)
+    {
+        bool blocked = false;
+        for (int dx = -j, dy = -j; dx <= 0; dx++)
+        {
+            float leftSlope = (dx - 0.5f) / (dy + 0.5f), rightSlope = (dx + 0.5f) / (dy - 0.5f);
+            if (start < rightSlope) continue;
+            if (end > leftSlope) break;
+
+            tPosition position = { origin.x + dx * xx + dy * xy, origin.y + dx * yx + dy * yy };
+            if (dx * dx + dy * dy <= radius * radius) visit(position);
+
+            bool transparent = isTransparent(position);
+            if (blocked)
+            {
+                if (!transparent)
+                {
+                    nextStart = rightSlope;
+                    continue;
+                }
+                blocked = false;
+                start = nextStart;
+            }
+            else if (!transparent && j < radius)
+            {
+                blocked = true;
+                obj_CastShadowsInOctant(origin, radius, j + 1, start, leftSlope, xx, xy, yx, yy, isTransparent, visit);
+                nextStart = rightSlope;
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+// Calls visit for every tile within the radius that can be seen from the origin, including the
+// walls that block the view (recursive shadowcasting). Tiles on the borders of the octants are
+// visited more than once.
+template <class TIsTransparent, class TVisit>
+void obj_CastShadows(const tPosition& origin, int radius, TIsTransparent isTransparent, TVisit visit)
+{
+    static const int multipliers[4][8] = {
+        { 1, 0, 0, -1, -1, 0, 0, 1 },
+        { 0, 1, -1, 0, 0, -1, 1, 0 },
+        { 0, 1, 1, 0, 0, -1, -1, 0 },
+        { 1, 0, 0, 1, -1, 0, 0, -1 },
+    };
+
+    visit(origin);
+    for (int octant = 0; octant < 8; octant++)
+    {
+        obj_CastShadowsInOctant(origin, radius, 1, 1.0f, 0.0f, multipliers[0][octant], multipliers[1][octant],
+                                multipliers[2][octant], multipliers[3][octant], isTransparent, visit);
+    }
+}
+
+// Region to region potentially visible set. The level is divided in square regions and for every
+// pair of regions one bit tells if any tile in the one could possibly see a tile in the other.
+// The bits are conservative, every region is flooded with the paths lines of sight can take out
+// of it, and neighbouring regions are always potentially visible. A cleared bit allows rejecting a visibility
+// check without casting a ray, a set bit still needs the precise ray.
+class PotentiallyVisibleSet
+{
+public:
+    PotentiallyVisibleSet();
+    virtual ~PotentiallyVisibleSet();
+
+    void build(int width, int height, std::function<bool (const tPosition&)> isTransparent);
+
+    // Updates the set after changes in the tiles between from and to (inclusive). Only the regions
+    // whose flood reached the changed tiles, or the tiles next to them, are flooded again.
+    void update(std::function<bool (const tPosition&)> isTransparent, const tPosition& from, const tPosition& to);
+    void clear();
+
+    bool isEmpty() const;
+    int regionSize() const;
+    int regionCount() const;
+    int region(const tPosition& position) const;
+
+    bool potentiallyVisible(int fromRegion, int toRegion) const;
+    bool potentiallyVisible(const tPosition& from, const tPosition& to) const;
+
+private:
+    int _width, _height;
+    int _regionSize;
+    int _regionsX, _regionsY;
+    int _wordsPerRow;
+    std::vector<unsigned int> _bits;
+
+    // Regions the flood out of every region reached, the set has a bit for either direction
+    std::vector<unsigned int> _reaches;
+    std::vector<unsigned char> _transparent;
+    std::vector<unsigned char> _reached;
+
+    void rebuild(std::function<bool (const tPosition&)>& isTransparent);
+    void floodRegion(int region);
+    void combine();
+    bool reaches(int fromRegion, int toRegion) const;
+    void set(int fromRegion, int toRegion, bool visible);
+};
+
+#endif // VISIBILITY_H
@@ -0,0 +1,93 @@
+#include "world-scheduler.h"
+
+#include <algorithm>
+
+WorldScheduler::WorldScheduler(int threads)
+    : _generation(0), _activeWorkers(0), _running(true), _diff(0.0f), _next(0), _remaining(0)
+{
+    if (threads <= 0) threads = std::max(int(std::thread::hardware_concurrency()), 1);
+
+    // The calling thread is one of the threads doing the work
+    for (int i = 1; i < threads; i++) this->_workers.push_back(std::thread(&WorldScheduler::workerLoop, this));
+}
+
+WorldScheduler::~WorldScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_running = false;
+    }
+    this->_wakeWorkers.notify_all();
+    for (auto& worker : this->_workers) worker.join();
+}
+
+void WorldScheduler::add(World* world)
+{
+    if (std::find(this->_worlds.begin(), this->_worlds.end(), world) == this->_worlds.end()) this->_worlds.push_back(world);
+}
+
+void WorldScheduler::remove(World* world)
+{
+    this->_worlds.erase(std::remove(this->_worlds.begin(), this->_worlds.end(), world), this->_worlds.end());
+}
+
+const std::vector<World*>& WorldScheduler::worlds() const
+{
+    return this->_worlds;
+}
+
+int WorldScheduler::threadCount() const
+{
+    return int(this->_workers.size()) + 1;
+}
+
+void WorldScheduler::update(float diff)
+{
+    if (this->_worlds.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_diff = diff;
+        this->_next = 0;
+        this->_remaining = int(this->_worlds.size());
+        this->_activeWorkers = int(this->_workers.size());
+        this->_generation++;
+    }
+    this->_wakeWorkers.notify_all();
+
+    this->updateWorlds();
+
+    // Wait for the workers too, so none of them is still looking at the worlds when they change
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_done.wait(lock, [this] () { return this->_remaining == 0 && this->_activeWorkers == 0; });
+}
+
+void WorldScheduler::workerLoop()
+{
+    unsigned int generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_wakeWorkers.wait(lock, [this, generation] () { return !this->_running || this->_generation != generation; });
+            if (!this->_running) return;
+            generation = this->_generation;
+        }
+
+        this->updateWorlds();
+
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_activeWorkers--;
+        this->_done.notify_all();
+    }
+}
+
+void WorldScheduler::updateWorlds()
+{
+    int count = int(this->_worlds.size());
+    for (int i = this->_next++; i < count; i = this->_next++)
+    {
+        this->_worlds[i]->update(this->_diff);
+        this->_remaining--;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef WORLD_SCHEDULER_H
+#define WORLD_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "world.h"
+
+// Updates many worlds in parallel on a fixed set of worker threads. Worlds are handed
+// out one at a time, so a world is never updated by two threads at once and a slow world
+// does not hold up the others. The calling thread helps out until every world is done.
+class WorldScheduler
+{
+public:
+    // Zero threads uses one thread per core
+    WorldScheduler(int threads = 0);
+    virtual ~WorldScheduler();
+
+    void add(World* world);
+    void remove(World* world);
+    const std::vector<World*>& worlds() const;
+
+    int threadCount() const;
+
+    // Advances every world one tick of the given length and returns when all of them are done
+    void update(float diff);
+
+private:
+    std::vector<World*> _worlds;
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeWorkers;
+    std::condition_variable _done;
+    unsigned int _generation;
+    int _activeWorkers;
+    bool _running;
+    float _diff;
+    std::atomic<int> _next;
+    std::atomic<int> _remaining;
+
+    void workerLoop();
+    void updateWorlds();
+};
+
+#endif // WORLD_SCHEDULER_H
@@ -0,0 +1,49 @@
+#include "world-snapshot.h"
+
+WorldSnapshot::WorldSnapshot(size_t capacity) : _tick(0)
+{
+    this->_data.reserve(capacity);
+}
+
+WorldSnapshot::~WorldSnapshot() { }
+
+void WorldSnapshot::capture(const World& world)
+{
+    this->_data.clear();
+    StateWriter writer(this->_data);
+    world.writeState(writer);
+    this->_tick = world.tick();
+}
+
+bool WorldSnapshot::restore(World& world) const
+{
+    if (this->_data.empty()) return false;
+
+    StateReader reader(this->_data.data(), this->_data.size());
+    return world.readState(reader);
+}
+
+bool WorldSnapshot::isEmpty() const
+{
+    return this->_data.empty();
+}
+
+unsigned int WorldSnapshot::tick() const
+{
+    return this->_tick;
+}
+
+size_t WorldSnapshot::size() const
+{
+    return this->_data.size();
+}
+
+size_t WorldSnapshot::capacity() const
+{
+    return this->_data.capacity();
+}
+
+const std::vector<unsigned char>& WorldSnapshot::data() const
+{
+    return this->_data;
+}
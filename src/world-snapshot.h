@@ -0,0 +1,37 @@
+#ifndef WORLD_SNAPSHOT_H
+#define WORLD_SNAPSHOT_H
+
+#include <vector>
+
+#include "state-buffer.h"
+#include "world.h"
+
+// Room for about 64 players with long paths and a few hundred bullets, bigger worlds grow it once
+#define WORLD_SNAPSHOT_CAPACITY (64 * 1024)
+
+// The complete state of a world in one flat buffer, for rollback and for trying moves ahead.
+// The buffer is allocated once and reused, capturing and restoring are mostly memcpys of the
+// player and bullet arrays. Restoring into a world of the same size does not allocate either.
+class WorldSnapshot
+{
+public:
+    WorldSnapshot(size_t capacity = WORLD_SNAPSHOT_CAPACITY);
+    virtual ~WorldSnapshot();
+
+    void capture(const World& world);
+
+    // The world has to be on the level the snapshot was captured on
+    bool restore(World& world) const;
+
+    bool isEmpty() const;
+    unsigned int tick() const;
+    size_t size() const;
+    size_t capacity() const;
+    const std::vector<unsigned char>& data() const;
+
+private:
+    std::vector<unsigned char> _data;
+    unsigned int _tick;
+};
+
+#endif // WORLD_SNAPSHOT_H
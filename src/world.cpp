@@ -0,0 +1,206 @@
+#include "world.h"
+
+#include <cstring>
+
+World::World(unsigned int seed)
+    : _level(new Level()), _players(this), _random(seed), _scripts(this), _seed(seed), _tick(0), _jobSystem(nullptr)
+{ }
+
+World::~World()
+{
+    this->_scripts.clear();
+    this->_players.resetPlayers();
+    delete this->_level;
+}
+
+void World::changeLevel(Level* level)
+{
+    this->_scripts.clear();
+    this->_players.resetPlayers();
+    delete this->_level;
+    this->_level = level != nullptr ? level : new Level();
+    this->_players.spawnPlayers();
+}
+
+Level* World::level() const
+{
+    return this->_level;
+}
+
+PlayerManager& World::players()
+{
+    return this->_players;
+}
+
+const PlayerManager& World::players() const
+{
+    return this->_players;
+}
+
+Random& World::random()
+{
+    return this->_random;
+}
+
+ScriptScheduler& World::scripts()
+{
+    return this->_scripts;
+}
+
+GameEventQueue& World::events()
+{
+    return this->_events;
+}
+
+const GameEventQueue& World::events() const
+{
+    return this->_events;
+}
+
+unsigned int World::seed() const
+{
+    return this->_seed;
+}
+
+unsigned int World::tick() const
+{
+    return this->_tick;
+}
+
+void World::setJobSystem(JobSystem* jobs)
+{
+    this->_jobSystem = jobs;
+}
+
+JobSystem* World::jobs() const
+{
+    return this->_jobSystem;
+}
+
+void World::post(std::function<void (World&)> job)
+{
+    std::lock_guard<std::mutex> lock(this->_jobsMutex);
+    this->_jobs.push_back(job);
+}
+
+void World::runPostedJobs()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_jobsMutex);
+        this->_runningJobs.swap(this->_jobs);
+    }
+
+    // Jobs can post new jobs, those run before the next tick
+    for (auto& job : this->_runningJobs) job(*this);
+    this->_runningJobs.clear();
+}
+
+void World::update(float diff)
+{
+    this->runPostedJobs();
+    this->_scripts.update(diff);
+    this->_players.update(diff);
+    this->_tick++;
+}
+
+void World::execute(const Command& command)
+{
+    switch (command.type)
+    {
+    case CommandTypes::SelectPlayer:
+        this->_players.selectPlayer(this->_players.player(command.x));
+        break;
+    case CommandTypes::ClickAt:
+        this->_players.clickAt(command.x, command.y);
+        break;
+    case CommandTypes::Shoot:
+        this->_players.shoot();
+        break;
+    }
+}
+
+void World::writeState(StateWriter& writer) const
+{
+    writer.writeVarint(this->_tick);
+    writer.writeRaw(this->_random.state());
+    this->_players.writeState(writer);
+}
+
+bool World::readState(StateReader& reader)
+{
+    auto tick = (unsigned int)reader.readVarint();
+    auto random = reader.readRaw<uint64_t>();
+    if (!this->_players.readState(reader) || reader.failed()) return false;
+
+    this->_tick = tick;
+    this->_random.setState(random);
+    return true;
+}
+
+// FNV-1a, floats are hashed by their bits so the smallest difference shows
+class StateHasher
+{
+public:
+    StateHasher() : hash(14695981039346656037ULL) { }
+
+    uint64_t hash;
+
+    void add(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            this->hash ^= bytes[i];
+            this->hash *= 1099511628211ULL;
+        }
+    }
+
+    template <class T>
+    void add(const T& value)
+    {
+        this->add(&value, sizeof(T));
+    }
+
+    template <class T>
+    void add(const std::vector<T>& values)
+    {
+        this->add(values.size());
+        if (!values.empty()) this->add(values.data(), values.size() * sizeof(T));
+    }
+};
+
+uint64_t World::stateHash() const
+{
+    StateHasher hasher;
+    hasher.add(this->_tick);
+    hasher.add(this->_random.state());
+
+    auto& players = this->_players._storage;
+    hasher.add(players._posX);
+    hasher.add(players._posY);
+    hasher.add(players._walkToX);
+    hasher.add(players._walkToY);
+    hasher.add(players._dirX);
+    hasher.add(players._dirY);
+    hasher.add(players._health);
+    hasher.add(players._team);
+    hasher.add(players._handle);
+    for (auto path : players._path)
+    {
+        hasher.add(players._paths.isEmpty(path) ? -1 : players._paths.cursor(path));
+    }
+
+    auto& bullets = this->_players._bullets;
+    hasher.add(bullets.size());
+    for (auto& bullet : bullets)
+    {
+        hasher.add(bullet._gunner);
+        hasher.add(bullet._pos);
+        hasher.add(bullet._dir);
+        hasher.add(bullet._weight);
+    }
+
+    hasher.add(this->_players._kills.size());
+
+    return hasher.hash;
+}
@@ -0,0 +1,97 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "game-events.h"
+#include "job-system.h"
+#include "level.h"
+#include "players.h"
+#include "random.h"
+#include "scripts.h"
+
+#define WORLD_DEFAULT_SEED 1
+
+enum class CommandTypes
+{
+    SelectPlayer,
+    ClickAt,
+    Shoot
+};
+
+// Input of a user. Everything users do to a world goes through commands, so it can be recorded
+// and replayed. SelectPlayer takes the handle in x, ClickAt the world location in x and y.
+typedef struct sCommand
+{
+    CommandTypes type;
+    int x, y;
+} Command;
+
+// One match: the level, the players and bullets on it, the random numbers and the tick
+// counter. Nothing is shared between worlds, so one process can host many of them. A
+// world is only ever updated by one thread at a time, other threads hand it work with post().
+//
+// The simulation is deterministic: two worlds with the same seed, level, tick length and
+// posted jobs end up in bit for bit the same state, on any thread.
+class World
+{
+public:
+    World(unsigned int seed = WORLD_DEFAULT_SEED);
+    virtual ~World();
+
+    // Takes ownership of the level, the players are respawned on it and the scripts stopped
+    void changeLevel(Level* level);
+
+    Level* level() const;
+    PlayerManager& players();
+    const PlayerManager& players() const;
+    Random& random();
+    ScriptScheduler& scripts();
+
+    // Shots, hits, kills and finished paths, for everything that shows or counts what happens in the world
+    GameEventQueue& events();
+    const GameEventQueue& events() const;
+    unsigned int seed() const;
+    unsigned int tick() const;
+
+    // Lets the passes of a tick run on many threads, without one everything runs on the updating thread.
+    // The results are the same either way. The job system can be shared by many worlds.
+    void setJobSystem(JobSystem* jobs);
+    JobSystem* jobs() const;
+
+    // Queues a job that runs on the thread updating this world, right before its next tick
+    void post(std::function<void (World&)> job);
+
+    // Runs the posted jobs, resumes the scripts that are due and advances the simulation one tick of the given length
+    void update(float diff);
+
+    // Applies user input right away, on the thread updating this world
+    void execute(const Command& command);
+
+    // The tick, random numbers and players, the level and the scripts are not part of the state
+    void writeState(StateWriter& writer) const;
+    bool readState(StateReader& reader);
+
+    // Hash over all simulated state, equal hashes mean the worlds did not diverge
+    uint64_t stateHash() const;
+
+private:
+    Level* _level;
+    PlayerManager _players;
+    Random _random;
+    ScriptScheduler _scripts;
+    GameEventQueue _events;
+    unsigned int _seed;
+    unsigned int _tick;
+    JobSystem* _jobSystem;
+
+    std::mutex _jobsMutex;
+    std::vector<std::function<void (World&)> > _jobs;
+    std::vector<std::function<void (World&)> > _runningJobs;
+
+    void runPostedJobs();
+};
+
+#endif // WORLD_H
@@ -0,0 +1,91 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <avoidance.h>
+#include <world.h>
+
+#include <cmath>
+#include <cstdlib>
+
+// Two players walking at each other along the same line, returns how close they got on their way
+static float walkHeadOn(bool avoidance)
+{
+    World world;
+    world.changeLevel(openLevel(32, 16));
+    auto& players = world.players();
+    players._avoidance = avoidance;
+
+    auto left = players.addPlayer(4, 8, Teams::CounterTerrorist);
+    auto right = players.addPlayer(28, 8, Teams::Terrorist);
+    players._storage.setPath(left->slot(), { { 28, 8 } });
+    players._storage.setPath(right->slot(), { { 4, 8 } });
+
+    float closest = 1e9f;
+    for (int tick = 0; tick < 180; tick++)
+    {
+        world.update(1.0f / 30.0f);
+        closest = std::min(closest, glm::length(left->pos() - right->pos()));
+    }
+
+    // Both made it to the other side
+    REQUIRE(left->pos().x > right->pos().x);
+
+    return closest;
+}
+
+TEST_CASE("Avoiding nobody keeps the preferred velocity", "[avoidance]" )
+{
+    auto velocity = obj_AvoidCollisions(glm::vec2(0, 0), glm::vec2(0, 0), glm::vec2(10, 0), nullptr, nullptr, 0, 5.0f, 50.0f, 1.0f, 0.1f);
+    REQUIRE(velocity.x == 10.0f);
+    REQUIRE(velocity.y == 0.0f);
+}
+
+TEST_CASE("Avoiding a neighbour in the way turns aside", "[avoidance]" )
+{
+    glm::vec2 position(0, 0), preferred(20, 0);
+    glm::vec2 neighborPosition(20, 0), neighborVelocity(-20, 0);
+
+    auto velocity = obj_AvoidCollisions(position, preferred, preferred, &neighborPosition, &neighborVelocity, 1, 5.0f, 50.0f, 1.0f, 0.1f);
+
+    REQUIRE(velocity.x > 0.0f);
+    REQUIRE(std::abs(velocity.y) > 0.0f);
+    REQUIRE(glm::length(velocity) <= 50.0f + 0.001f);
+}
+
+TEST_CASE("Avoiding a neighbour walking away keeps going", "[avoidance]" )
+{
+    glm::vec2 position(0, 0), preferred(20, 0);
+    glm::vec2 neighborPosition(0, 40), neighborVelocity(0, 20);
+
+    auto velocity = obj_AvoidCollisions(position, preferred, preferred, &neighborPosition, &neighborVelocity, 1, 5.0f, 50.0f, 1.0f, 0.1f);
+
+    REQUIRE(velocity.x == Approx(20.0f));
+    REQUIRE(velocity.y == Approx(0.0f));
+}
+
+TEST_CASE("Players walking at each other pass without overlapping", "[avoidance]" )
+{
+    REQUIRE(walkHeadOn(false) < PLAYER_AVOIDANCE_RADIUS);
+    REQUIRE(walkHeadOn(true) > PLAYER_AVOIDANCE_RADIUS * 1.5f);
+}
+
+TEST_CASE("A crowd avoiding each other gets through a chokepoint", "[avoidance]" )
+{
+    World world;
+    addChokepointCrowd(world);
+    world.players()._avoidance = true;
+
+    // Pushed around in the gap nobody gets stuck on its waypoint, everybody makes it across
+    auto cursor = world.events().end();
+    std::vector<GameEvent> events;
+    int completed = 0;
+    for (int tick = 0; tick < 2400 && completed < 500; tick++)
+    {
+        world.update(1.0f / 30.0f);
+        events.clear();
+        REQUIRE(world.events().drain(cursor, events) == 0);
+        for (auto& event : events) if (event.type == GameEventTypes::PathCompleted) completed++;
+    }
+
+    REQUIRE(completed == 500);
+}
@@ -4,10 +4,3 @@
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-
-#ifdef _WIN32
-
-#define GLEXTL_IMPLEMENTATION
-#include <GL/glextl.h>
-
-#endif // _WIN32
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include <bot-scheduler.h>
+
+static std::vector<PlayerHandle> handles(int count)
+{
+    std::vector<PlayerHandle> result;
+    for (int i = 0; i < count; i++) result.push_back(i);
+    return result;
+}
+
+TEST_CASE("Bots think as often as their level of detail says", "[bot-scheduler]" )
+{
+    BotScheduler scheduler(1000);
+    auto bots = handles(3);
+    std::vector<int> thinks(3, 0);
+
+    std::vector<PlayerHandle> due;
+    for (unsigned int tick = 0; tick < 64; tick++)
+    {
+        scheduler.schedule(tick, bots, due);
+        for (auto bot : due)
+        {
+            thinks[bot]++;
+            scheduler.thought(bot, BotDetails(bot), tick);
+        }
+    }
+
+    REQUIRE(thinks[0] == 64);
+    REQUIRE(thinks[1] >= 64 / BOT_ALERT_INTERVAL - 1);
+    REQUIRE(thinks[1] <= 64 / BOT_ALERT_INTERVAL + 1);
+    REQUIRE(thinks[2] >= 64 / BOT_IDLE_INTERVAL - 1);
+    REQUIRE(thinks[2] <= 64 / BOT_IDLE_INTERVAL + 1);
+}
+
+TEST_CASE("Bots of the same level are spread over the ticks", "[bot-scheduler]" )
+{
+    BotScheduler scheduler(1000);
+    auto bots = handles(400);
+
+    std::vector<PlayerHandle> due;
+    for (unsigned int tick = 0; tick < 32; tick++)
+    {
+        scheduler.schedule(tick, bots, due);
+        for (auto bot : due) scheduler.thought(bot, BotDetails::Alert, tick);
+
+        REQUIRE(int(due.size()) == 400 / BOT_ALERT_INTERVAL);
+        REQUIRE(scheduler.lastTick().late == 0);
+    }
+}
+
+TEST_CASE("Bots over the budget think late, most overdue first", "[bot-scheduler]" )
+{
+    BotScheduler scheduler(10);
+    auto bots = handles(25);
+    for (auto bot : bots) scheduler.wake(bot, BotDetails::Combat, 0);
+
+    std::vector<PlayerHandle> due;
+    scheduler.schedule(0, bots, due);
+    REQUIRE(due.size() == 10);
+    REQUIRE(scheduler.lastTick().late == 15);
+    REQUIRE(scheduler.lastTick().skipped == 0);
+    for (auto bot : due) scheduler.thought(bot, BotDetails::Combat, 0);
+
+    // The ones left over are a tick late now and go before the ones that just thought
+    scheduler.schedule(1, bots, due);
+    REQUIRE(due.size() == 10);
+    REQUIRE(due.front() == 10);
+    REQUIRE(scheduler.lastTick().maxLateness == 1);
+    REQUIRE(scheduler.total().thinks == 20);
+    REQUIRE(scheduler.total().late == 30);
+}
+
+TEST_CASE("Waking a bot lets it think right away", "[bot-scheduler]" )
+{
+    BotScheduler scheduler;
+    std::vector<PlayerHandle> bots = { 0 }, due;
+
+    scheduler.thought(0, BotDetails::Idle, 0);
+    scheduler.schedule(1, bots, due);
+    REQUIRE(due.empty());
+    REQUIRE(scheduler.lastTick().skipped == 1);
+
+    scheduler.wake(0, BotDetails::Combat, 2);
+    scheduler.schedule(2, bots, due);
+    REQUIRE(due == bots);
+    REQUIRE(scheduler.details(0) == BotDetails::Combat);
+}
+
+TEST_CASE("The schedule survives writing and reading it", "[bot-scheduler]" )
+{
+    BotScheduler scheduler;
+    auto bots = handles(8);
+    for (auto bot : bots) scheduler.thought(bot, BotDetails(bot % 3), bot);
+
+    std::vector<unsigned char> data;
+    StateWriter writer(data);
+    scheduler.writeState(writer);
+
+    BotScheduler copy;
+    StateReader reader(data.data(), data.size());
+    REQUIRE(copy.readState(reader));
+
+    std::vector<PlayerHandle> due, copyDue;
+    for (unsigned int tick = 8; tick < 40; tick++)
+    {
+        scheduler.schedule(tick, bots, due);
+        copy.schedule(tick, bots, copyDue);
+        REQUIRE(due == copyDue);
+        for (auto bot : due)
+        {
+            scheduler.thought(bot, BotDetails::Idle, tick);
+            copy.thought(bot, BotDetails::Idle, tick);
+        }
+    }
+}
@@ -0,0 +1,229 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <bots.h>
+#include <world-snapshot.h>
+
+// Plays until one team is dead or for at most 3000 ticks, returns the ticks played
+static unsigned int playMatch(unsigned int seed, std::vector<PlayerKill>& kills, bool& roundOver)
+{
+    World world(seed);
+    world.changeLevel(openLevel(48, 48));
+    for (int i = 0; i < 4; i++)
+    {
+        world.players().addPlayer(4 + i * 4, 6, Teams::CounterTerrorist);
+        world.players().addPlayer(4 + i * 4, 40, Teams::Terrorist);
+    }
+
+    BotController bots(&world);
+    while (world.tick() < 3000 && !world.players().isRoundOver())
+    {
+        bots.update(0.05f);
+        world.update(0.05f);
+    }
+
+    kills = world.players()._kills;
+    roundOver = world.players().isRoundOver();
+    return world.tick();
+}
+
+TEST_CASE("Bots play a round until one team is dead", "[bots]" )
+{
+    std::vector<PlayerKill> kills;
+    bool roundOver = false;
+    auto ticks = playMatch(3, kills, roundOver);
+
+    REQUIRE(roundOver);
+    REQUIRE(ticks < 3000);
+    REQUIRE(kills.size() >= 4);
+    for (auto& kill : kills) REQUIRE(kill.killer != kill.victim);
+}
+
+TEST_CASE("Bots play the same round for the same seed", "[bots]" )
+{
+    std::vector<PlayerKill> a, b;
+    bool roundOverA = false, roundOverB = false;
+    auto ticksA = playMatch(7, a, roundOverA);
+    auto ticksB = playMatch(7, b, roundOverB);
+
+    REQUIRE(ticksA == ticksB);
+    REQUIRE(roundOverA == roundOverB);
+    REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        REQUIRE(a[i].victim == b[i].victim);
+        REQUIRE(a[i].pos.x == b[i].pos.x);
+        REQUIRE(a[i].pos.y == b[i].pos.y);
+    }
+}
+
+TEST_CASE("Bots play every player but the selected one", "[bots]" )
+{
+    World world;
+    world.changeLevel(openLevel(48, 48));
+    auto selected = world.players().addPlayer(4, 6, Teams::CounterTerrorist);
+    auto bot = world.players().addPlayer(8, 6, Teams::CounterTerrorist);
+    world.players().selectPlayer(selected);
+
+    BotController bots(&world);
+    world.players().setBots(&bots);
+    for (int tick = 0; tick < 2 * BOT_IDLE_INTERVAL; tick++) world.update(0.05f);
+
+    REQUIRE(!selected->hasPath());
+    REQUIRE(selected->pos() == PlayerManager::levelToWorldLocation(4, 6));
+    REQUIRE(bot->pos() != PlayerManager::levelToWorldLocation(8, 6));
+    REQUIRE(bots.scheduler().total().thinks > 0);
+    REQUIRE(bots.scheduler().total().skipped > 0);
+}
+
+TEST_CASE("Bots pick up where a snapshot left off", "[bots]" )
+{
+    World world(5), copy(5);
+    BotController bots(&world), copyBots(&copy);
+    world.players().setBots(&bots);
+    copy.players().setBots(&copyBots);
+
+    world.changeLevel(openLevel(48, 48));
+    copy.changeLevel(openLevel(48, 48));
+    for (int i = 0; i < 4; i++)
+    {
+        world.players().addPlayer(4 + i * 4, 6, Teams::CounterTerrorist);
+        world.players().addPlayer(4 + i * 4, 40, Teams::Terrorist);
+    }
+
+    for (int tick = 0; tick < 100; tick++) world.update(0.05f);
+
+    WorldSnapshot snapshot;
+    snapshot.capture(world);
+    REQUIRE(snapshot.restore(copy));
+
+    for (int tick = 0; tick < 200; tick++)
+    {
+        world.update(0.05f);
+        copy.update(0.05f);
+    }
+
+    REQUIRE(world.stateHash() == copy.stateHash());
+}
+
+TEST_CASE("Bots think right after they were hit", "[bots]" )
+{
+    World world;
+    world.changeLevel(openLevel(48, 48));
+    auto bot = world.players().addPlayer(8, 6, Teams::CounterTerrorist);
+
+    BotController bots(&world);
+    auto& stats = bots.scheduler().lastTick();
+    auto tick = [&] () {
+        bots.update(0.05f);
+        world.update(0.05f);
+        return stats.thinks;
+    };
+
+    // Alone on the level it thinks now and then, never in two ticks in a row
+    unsigned int thinks = 0;
+    for (int i = 0; i < 2 * BOT_IDLE_INTERVAL && thinks == 0; i++) thinks = tick();
+    REQUIRE(thinks == 1);
+    REQUIRE(tick() == 0);
+
+    world.events().publish(GameEventTypes::PlayerHit, world.tick(), INVALID_PLAYER_HANDLE, bot->handle(), bot->pos(), 10.0f);
+    REQUIRE(tick() == 1);
+    REQUIRE(tick() == 0);
+
+    // With events lost nobody knows who was hit, so every bot thinks
+    for (int i = 0; i <= world.events().capacity(); i++)
+    {
+        world.events().publish(GameEventTypes::BulletFired, world.tick(), bot->handle(), INVALID_PLAYER_HANDLE, bot->pos());
+    }
+    REQUIRE(tick() == 1);
+    REQUIRE(tick() == 0);
+}
+
+static float bestAction(BotPerception& perception, BotActions& best)
+{
+    float bestUtility = -1.0f;
+    for (int action = 0; action < BOT_ACTION_COUNT; action++)
+    {
+        float utility = BotController::utility(BotActions(action), perception, 0);
+        REQUIRE(utility >= 0.0f);
+        REQUIRE(utility <= 1.0f);
+        if (utility <= bestUtility) continue;
+
+        best = BotActions(action);
+        bestUtility = utility;
+    }
+
+    return bestUtility;
+}
+
+TEST_CASE("Bots want to do what fits what they perceive", "[bots]" )
+{
+    BotPerception perception;
+    perception.resize(1);
+    perception._health[0] = 1.0f;
+
+    BotActions best;
+    bestAction(perception, best);
+    REQUIRE(best == BotActions::MoveToSite);
+
+    perception._enemy[0] = 1;
+    perception._enemyDistance[0] = 8.0f;
+    perception._visibleEnemies[0] = 1;
+    perception._nearby[0] = 1;
+    bestAction(perception, best);
+    REQUIRE(best == BotActions::Engage);
+
+    perception._health[0] = 0.2f;
+    perception._cover[0] = { 2, 2 };
+    perception._coverDistance[0] = 2.0f;
+    bestAction(perception, best);
+    REQUIRE(best == BotActions::TakeCover);
+
+    perception._coverDistance[0] = -1.0f;
+    perception._visibleEnemies[0] = 3;
+    bestAction(perception, best);
+    REQUIRE(best == BotActions::Retreat);
+}
+
+TEST_CASE("Hurt bots take cover behind walls", "[bots]" )
+{
+    World world;
+    world.changeLevel(makeLevel(32, 32, [] (const tPosition& position) {
+        return position.x == 10 && position.y >= 8 && position.y <= 10;
+    }, true));
+
+    auto bot = world.players().addPlayer(8, 4, Teams::CounterTerrorist);
+    auto enemy = world.players().addPlayer(20, 9, Teams::Terrorist);
+    world.players()._storage._health[bot->slot()] = 0.2f;
+    world.players().selectPlayer(enemy);
+
+    BotController bots(&world);
+    world.players().setBots(&bots);
+    world.update(0.05f);
+
+    REQUIRE(bots.action(bot->handle()) == BotActions::TakeCover);
+    REQUIRE(bot->hasPath());
+    REQUIRE(world.players()._bullets.size() == 1);
+    REQUIRE(bots.costs().thinks == 1);
+    REQUIRE(bots.costs().walks == 1);
+
+    for (int tick = 0; tick < 60; tick++) world.update(0.05f);
+
+    auto pos = bot->pos();
+    tPosition at = { int(pos.x / LEVEL_TILE_WORLD_SIZE), int(pos.y / LEVEL_TILE_WORLD_SIZE) };
+    REQUIRE(!world.level()->canSee({ 20, 9 }, at));
+}
+
+TEST_CASE("Copied levels keep the tiles and derived data", "[bots]" )
+{
+    auto level = openLevel(16, 16);
+    auto copy = level->copy();
+
+    REQUIRE(copy != nullptr);
+    REQUIRE(copy->_tiles != level->_tiles);
+    REQUIRE(copy->width == 16);
+    REQUIRE(copy->isWalkable(8, 8));
+
+    delete copy;
+    delete level;
+}
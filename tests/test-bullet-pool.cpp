@@ -0,0 +1,49 @@
+#include "catch.hpp"
+
+#include <bullet-pool.h>
+
+TEST_CASE("Killed bullets are replaced by the last live bullet", "[bullet-pool]" )
+{
+    BulletPool pool(4);
+    pool.spawn(0, glm::vec3(1.0f), glm::vec3(0.0f));
+    pool.spawn(1, glm::vec3(2.0f), glm::vec3(0.0f));
+    pool.spawn(2, glm::vec3(3.0f), glm::vec3(0.0f));
+    REQUIRE(pool.size() == 3);
+
+    pool.kill(0);
+    REQUIRE(pool.size() == 2);
+    REQUIRE(pool[0]._gunner == 2);
+    REQUIRE(pool[1]._gunner == 1);
+
+    int live = 0;
+    for (auto& bullet : pool) live += (bullet._gunner != INVALID_PLAYER_HANDLE ? 1 : 0);
+    REQUIRE(live == 2);
+
+    pool.kill(5);
+    REQUIRE(pool.size() == 2);
+}
+
+TEST_CASE("Bullet pool grows and keeps its high water mark", "[bullet-pool]" )
+{
+    BulletPool pool(2);
+    REQUIRE(pool.capacity() == 2);
+
+    for (int i = 0; i < 5; i++) pool.spawn(i, glm::vec3(0.0f), glm::vec3(0.0f));
+    REQUIRE(pool.size() == 5);
+    REQUIRE(pool.capacity() == 8);
+    REQUIRE(pool.growCount() == 2);
+    REQUIRE(pool.highWaterMark() == 5);
+
+    pool.kill(0);
+    pool.kill(0);
+    pool.spawn(9, glm::vec3(0.0f), glm::vec3(0.0f));
+    REQUIRE(pool.highWaterMark() == 5);
+
+    pool.clear();
+    REQUIRE(pool.size() == 0);
+    REQUIRE(pool.capacity() == 8);
+
+    pool.resetStats();
+    REQUIRE(pool.highWaterMark() == 0);
+    REQUIRE(pool.growCount() == 0);
+}
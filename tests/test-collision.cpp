@@ -0,0 +1,85 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <collision.h>
+#include <players.h>
+#include <world.h>
+
+#include <cstring>
+
+TEST_CASE("Sweep stops at the first blocking tile", "[collision]" )
+{
+    auto wallAtFive = [] (const tPosition& position) { return position.x == 5; };
+
+    float hit = -1.0f;
+    REQUIRE(obj_SweepTiles(0.5f, 0.5f, 10.5f, 0.5f, wallAtFive, hit));
+    REQUIRE(hit == Approx(0.45f));
+
+    // Ending right before the wall does not hit it
+    REQUIRE_FALSE(obj_SweepTiles(0.5f, 0.5f, 4.9f, 3.2f, wallAtFive, hit));
+
+    // Going the other way hits the other side of the wall
+    REQUIRE(obj_SweepTiles(9.0f, 2.0f, 1.0f, 2.0f, wallAtFive, hit));
+    REQUIRE(hit == Approx(0.375f));
+}
+
+TEST_CASE("Sweep passes a corner unless both sides block", "[collision]" )
+{
+    auto single = [] (const tPosition& position) { return position.x == 1 && position.y == 0; };
+    auto both = [] (const tPosition& position) { return (position.x == 1 && position.y == 0) || (position.x == 0 && position.y == 1); };
+
+    float hit;
+    REQUIRE_FALSE(obj_SweepTiles(0.5f, 0.5f, 1.5f, 1.5f, single, hit));
+    REQUIRE(obj_SweepTiles(0.5f, 0.5f, 1.5f, 1.5f, both, hit));
+    REQUIRE(hit == Approx(0.5f));
+}
+
+TEST_CASE("Sweep against a circle finds the first contact", "[collision]" )
+{
+    float hit;
+    REQUIRE(obj_SweepCircle(0.0f, 0.0f, 100.0f, 0.0f, 50.0f, 5.0f, 8.0f, hit));
+    REQUIRE(hit == Approx((50.0f - std::sqrt(64.0f - 25.0f)) / 100.0f));
+
+    REQUIRE_FALSE(obj_SweepCircle(0.0f, 0.0f, 100.0f, 0.0f, 50.0f, 9.0f, 8.0f, hit));
+    REQUIRE_FALSE(obj_SweepCircle(0.0f, 0.0f, 30.0f, 0.0f, 50.0f, 0.0f, 8.0f, hit));
+    REQUIRE_FALSE(obj_SweepCircle(60.0f, 0.0f, 100.0f, 0.0f, 50.0f, 0.0f, 8.0f, hit));
+
+    // Starting inside the circle is an immediate hit
+    REQUIRE(obj_SweepCircle(49.0f, 0.0f, 100.0f, 0.0f, 50.0f, 0.0f, 8.0f, hit));
+    REQUIRE(hit == 0.0f);
+}
+
+// An open level with a wall from top to bottom in the column
+static Level* wallAt(int width, int height, int wallX)
+{
+    return makeLevel(width, height, [wallX] (const tPosition& position) { return position.x == wallX; });
+}
+
+TEST_CASE("Bullets do not tunnel through thin walls at a low tick rate", "[collision]" )
+{
+    World world;
+    world.changeLevel(wallAt(64, 8, 20));
+    auto gunner = world.players().addPlayer(10, 4, Teams::CounterTerrorist);
+    auto target = world.players().addPlayer(30, 4, Teams::Terrorist);
+
+    // Players look away from where they walk to, a bullet flies against its direction
+    world.players()._bullets.spawn(gunner->handle(), gunner->pos(), glm::vec3(-1.0f, 0.0f, 0.0f));
+    world.update(1.0f);
+    REQUIRE(world.players()._bullets.size() == 0);
+    REQUIRE(target->health() == 1.0f);
+}
+
+TEST_CASE("Bullets do not tunnel through players at a low tick rate", "[collision]" )
+{
+    World world;
+    world.changeLevel(wallAt(64, 8, 60));
+    auto gunner = world.players().addPlayer(10, 4, Teams::CounterTerrorist);
+    auto near = world.players().addPlayer(20, 4, Teams::Terrorist);
+    auto far = world.players().addPlayer(30, 4, Teams::Terrorist);
+
+    world.players()._bullets.spawn(gunner->handle(), gunner->pos(), glm::vec3(-1.0f, 0.0f, 0.0f));
+    world.update(1.0f);
+    REQUIRE(world.players()._bullets.size() == 0);
+    REQUIRE(near->health() < 1.0f);
+    REQUIRE(far->health() == 1.0f);
+}
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <distance-field.h>
+
+TEST_CASE("Without walls the distance is the distance to the border", "[distance-field]" )
+{
+    auto field = obj_GetDistanceField(9, 9, [] (const tPosition& position) { return false; });
+    REQUIRE(field.size() == 81);
+    REQUIRE(field[0] == 1 * DISTANCE_FIELD_UNITS);
+    REQUIRE(field[4 * 9 + 4] == 5 * DISTANCE_FIELD_UNITS);
+}
+
+TEST_CASE("Distance to a single wall is euclidean", "[distance-field]" )
+{
+    auto field = obj_GetDistanceField(21, 21, [] (const tPosition& position) {
+        return position.x == 10 && position.y == 10;
+    });
+    REQUIRE(field[10 * 21 + 10] == 0);
+    REQUIRE(field[10 * 21 + 13] == 3 * DISTANCE_FIELD_UNITS);
+    REQUIRE(field[13 * 21 + 14] == 5 * DISTANCE_FIELD_UNITS);
+    REQUIRE(field[11 * 21 + 11] == 11);
+}
+
+TEST_CASE("Distance to a wall line", "[distance-field]" )
+{
+    auto field = obj_GetDistanceField(32, 32, [] (const tPosition& position) { return position.x == 16; });
+    for (int y = 2; y < 30; y++)
+    {
+        REQUIRE(field[y * 32 + 16] == 0);
+        REQUIRE(field[y * 32 + 18] == 2 * DISTANCE_FIELD_UNITS);
+        REQUIRE(field[y * 32 + 13] == 3 * DISTANCE_FIELD_UNITS);
+    }
+}
+
+TEST_CASE("Updating a part of the field matches recalculating it", "[distance-field]" )
+{
+    bool moved = false;
+    auto isWall = [&moved] (const tPosition& position) {
+        if (position.x == 20 && position.y > 4 && position.y < 40) return true;
+        return moved ? (position.x == 40 && position.y == 30) : (position.x == 45 && position.y == 10);
+    };
+
+    auto field = obj_GetDistanceField(64, 48, isWall);
+    moved = true;
+    obj_UpdateDistanceField(field, 64, 48, isWall, { 40, 10 }, { 45, 30 });
+
+    REQUIRE(field == obj_GetDistanceField(64, 48, isWall));
+}
+
+TEST_CASE("Updating the field in open areas matches recalculating it", "[distance-field]" )
+{
+    // A few pillars in a large open area, walls come and go in small rectangles all over it
+    std::vector<char> walls(96 * 80, 0);
+    for (int i = 0; i < 12; i++) walls[((i * 37) % 80) * 96 + (i * 53) % 96] = 1;
+    auto isWall = [&walls] (const tPosition& position) { return walls[position.y * 96 + position.x] != 0; };
+
+    auto field = obj_GetDistanceField(96, 80, isWall);
+    unsigned int seed = 7;
+    for (int step = 0; step < 40; step++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int x = (seed >> 8) % 92, y = (seed >> 16) % 76, size = 1 + (seed >> 4) % 4;
+        for (int i = y; i < y + size; i++)
+        {
+            for (int j = x; j < x + size; j++) walls[i * 96 + j] = step % 3 == 2 ? 0 : 1;
+        }
+
+        obj_UpdateDistanceField(field, 96, 80, isWall, { x, y }, { x + size - 1, y + size - 1 });
+        REQUIRE(field == obj_GetDistanceField(96, 80, isWall));
+    }
+}
@@ -0,0 +1,53 @@
+#include "catch.hpp"
+
+#include <fixed-timestep.h>
+
+TEST_CASE("Frame time is turned into whole ticks", "[fixed-timestep]" )
+{
+    FixedTimestep timestep(50);
+    REQUIRE(timestep.tickLength() == Approx(0.02f));
+
+    REQUIRE(timestep.advance(0.01f) == 0);
+    REQUIRE(timestep.alpha() == Approx(0.5f));
+
+    // The left over time is carried over to the next frame
+    REQUIRE(timestep.advance(0.035f) == 2);
+    REQUIRE(timestep.alpha() == Approx(0.25f));
+
+    REQUIRE(timestep.advance(-1.0f) == 0);
+    REQUIRE(timestep.alpha() == Approx(0.25f));
+}
+
+TEST_CASE("Rendering faster than the tick rate", "[fixed-timestep]" )
+{
+    FixedTimestep timestep(30);
+
+    int ticks = 0;
+    for (int frame = 0; frame < 144; frame++) ticks += timestep.advance(1.0f / 144.0f);
+    REQUIRE(ticks >= 29);
+    REQUIRE(ticks <= 30);
+}
+
+TEST_CASE("Slow frames do not spiral into more and more ticks", "[fixed-timestep]" )
+{
+    FixedTimestep timestep(60, 4);
+
+    REQUIRE(timestep.advance(1.0f) == 4);
+    REQUIRE(timestep.droppedTicks() == 56);
+    REQUIRE(timestep.advance(1.0f / 60.0f) == 1);
+
+    timestep.reset();
+    REQUIRE(timestep.droppedTicks() == 0);
+    REQUIRE(timestep.alpha() == 0.0f);
+}
+
+TEST_CASE("Changing the tick rate keeps the fraction of a tick", "[fixed-timestep]" )
+{
+    FixedTimestep timestep(20);
+    timestep.advance(0.025f);
+    REQUIRE(timestep.alpha() == Approx(0.5f));
+
+    timestep.setTickRate(40);
+    REQUIRE(timestep.alpha() == Approx(0.5f));
+    REQUIRE(timestep.advance(0.0125f) == 1);
+}
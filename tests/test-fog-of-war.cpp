@@ -0,0 +1,124 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <fog-of-war.h>
+#include <visibility.h>
+#include <world.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+
+TEST_CASE("Shadowcasting in an open level sees everything in the radius", "[fog-of-war]" )
+{
+    std::set<std::pair<int, int> > seen;
+    obj_CastShadows({ 32, 32 }, 10, [] (const tPosition& position) { return true; }, [&seen] (const tPosition& position) {
+        seen.insert(std::make_pair(position.x, position.y));
+    });
+
+    for (int y = 16; y < 48; y++)
+    {
+        for (int x = 16; x < 48; x++)
+        {
+            int dx = x - 32, dy = y - 32;
+            REQUIRE(seen.count(std::make_pair(x, y)) == (dx * dx + dy * dy <= 100 ? 1u : 0u));
+        }
+    }
+}
+
+TEST_CASE("Shadowcasting sees the wall but not behind it", "[fog-of-war]" )
+{
+    auto wall = [] (const tPosition& position) { return !(position.x == 36 && position.y > 20 && position.y < 44); };
+    std::set<std::pair<int, int> > seen;
+    obj_CastShadows({ 32, 32 }, 16, wall, [&seen] (const tPosition& position) {
+        seen.insert(std::make_pair(position.x, position.y));
+    });
+
+    REQUIRE(seen.count(std::make_pair(34, 32)) == 1);
+    REQUIRE(seen.count(std::make_pair(36, 32)) == 1);
+    REQUIRE(seen.count(std::make_pair(40, 32)) == 0);
+    REQUIRE(seen.count(std::make_pair(44, 36)) == 0);
+    REQUIRE(seen.count(std::make_pair(28, 32)) == 1);
+
+    // Behind the wall only the tiles past its ends are seen
+    for (auto& tile : seen)
+    {
+        if (tile.first > 36) REQUIRE(std::abs(tile.second - 32) >= 10);
+    }
+}
+
+TEST_CASE("Every team sees only around its own players", "[fog-of-war]" )
+{
+    World world;
+    world.changeLevel(walledLevel(128, 64));
+    world.players().addPlayer(10, 10, Teams::CounterTerrorist);
+    world.players().addPlayer(100, 50, Teams::Terrorist);
+
+    FogOfWar fog;
+    fog.update(world.players()._storage, *world.level());
+    REQUIRE(fog.width() == 128);
+    REQUIRE(fog.lastCasts() == 2);
+    REQUIRE(fog.isVisible(Teams::CounterTerrorist, 10, 10));
+    REQUIRE(fog.isVisible(Teams::CounterTerrorist, 12, 12));
+    REQUIRE_FALSE(fog.isVisible(Teams::CounterTerrorist, 100, 50));
+    REQUIRE(fog.isVisible(Teams::Terrorist, 100, 50));
+    REQUIRE_FALSE(fog.isVisible(Teams::Terrorist, 10, 10));
+    REQUIRE_FALSE(fog.isVisible(Teams::Teamless, 10, 10));
+
+    // The first update changes the whole mask, then nothing changes until a player moves
+    auto dirty = fog.takeDirty(Teams::CounterTerrorist);
+    REQUIRE(dirty.minX == 0);
+    REQUIRE(dirty.maxX == 127);
+    REQUIRE(dirty.maxY == 63);
+    fog.takeDirty(Teams::Terrorist);
+
+    fog.update(world.players()._storage, *world.level());
+    REQUIRE(fog.lastCasts() == 0);
+    dirty = fog.takeDirty(Teams::CounterTerrorist);
+    REQUIRE(dirty.maxX < dirty.minX);
+
+    // Dead players see nothing
+    world.players()._storage._health[1] = 0.0f;
+    fog.update(world.players()._storage, *world.level());
+    REQUIRE_FALSE(fog.isVisible(Teams::Terrorist, 100, 50));
+    dirty = fog.takeDirty(Teams::Terrorist);
+    REQUIRE(dirty.minX >= 100 - FOG_OF_WAR_RADIUS);
+    REQUIRE(dirty.maxX <= 100 + FOG_OF_WAR_RADIUS);
+    REQUIRE(fog.takeDirty(Teams::CounterTerrorist).maxX < 0);
+}
+
+TEST_CASE("Casting only the players that moved uncovers the same tiles as casting all of them", "[fog-of-war]" )
+{
+    World world;
+    world.changeLevel(walledLevel(96, 96));
+    for (int i = 0; i < 40; i++)
+    {
+        world.players().addPlayer(world.random().range(0, 95), world.random().range(0, 95), i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+    }
+
+    auto& players = world.players()._storage;
+    FogOfWar fog;
+    fog.update(players, *world.level());
+    for (int step = 0; step < 30; step++)
+    {
+        for (int i = 0; i < 5; i++)
+        {
+            int slot = world.random().range(0, players.size() - 1);
+            players._posX[slot] = std::min(std::max(players._posX[slot] + (world.random().unit() - 0.5f) * 8.0f * LEVEL_TILE_WORLD_SIZE, 0.0f), 95.0f * LEVEL_TILE_WORLD_SIZE);
+            players._posY[slot] = std::min(std::max(players._posY[slot] + (world.random().unit() - 0.5f) * 8.0f * LEVEL_TILE_WORLD_SIZE, 0.0f), 95.0f * LEVEL_TILE_WORLD_SIZE);
+            if (world.random().range(0, 10) == 0) players._health[slot] = 0.0f;
+        }
+        fog.update(players, *world.level());
+        REQUIRE(fog.lastCasts() <= 5);
+
+        FogOfWar expected;
+        expected.update(players, *world.level());
+        REQUIRE(fog.mask(Teams::CounterTerrorist) == expected.mask(Teams::CounterTerrorist));
+        REQUIRE(fog.mask(Teams::Terrorist) == expected.mask(Teams::Terrorist));
+    }
+
+    // A new player in the slots casts everybody again
+    world.players().addPlayer(1, 1, Teams::Terrorist);
+    fog.update(players, *world.level());
+    REQUIRE(fog.isVisible(Teams::Terrorist, 1, 1));
+}
@@ -0,0 +1,124 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <world.h>
+
+TEST_CASE("Readers drain the events published since they last read", "[game-events]" )
+{
+    GameEventQueue queue(6);
+    REQUIRE(queue.capacity() == 8);
+
+    GameEventCursor first = queue.end(), second = queue.end();
+    for (int i = 0; i < 5; i++) queue.publish(GameEventTypes::BulletFired, i, i, INVALID_PLAYER_HANDLE, glm::vec3(0.0f));
+
+    std::vector<GameEvent> events;
+    REQUIRE(queue.drain(first, events) == 0);
+    REQUIRE(events.size() == 5);
+    REQUIRE(events[4].player == 4);
+    REQUIRE(first == queue.end());
+
+    // Wraps around the end of the buffer
+    for (int i = 5; i < 10; i++) queue.publish(GameEventTypes::PlayerHit, i, i, 0, glm::vec3(0.0f), 0.2f);
+    events.clear();
+    REQUIRE(queue.drain(first, events) == 0);
+    REQUIRE(events.size() == 5);
+    for (int i = 0; i < 5; i++) REQUIRE(events[i].tick == unsigned(i + 5));
+
+    // The second reader fell behind and lost the oldest events
+    events.clear();
+    REQUIRE(queue.drain(second, events) == 2);
+    REQUIRE(events.size() == 8);
+    REQUIRE(events.front().tick == 2);
+    REQUIRE(events.back().tick == 9);
+
+    events.clear();
+    REQUIRE(queue.drain(second, events) == 0);
+    REQUIRE(events.empty());
+}
+
+TEST_CASE("Shots, hits and kills are published in the tick they happen", "[game-events]" )
+{
+    World world;
+    world.changeLevel(openLevel(32, 32));
+    auto gunner = world.players().addPlayer(4, 4, Teams::CounterTerrorist);
+    auto victim = world.players().addPlayer(8, 4, Teams::Terrorist);
+
+    GameEventCursor cursor = world.events().end();
+    std::vector<GameEvent> events;
+    int fired = 0, hits = 0, kills = 0;
+    for (int tick = 0; tick < 300 && victim->health() > 0.0f; tick++)
+    {
+        if (tick % 5 == 0) world.players().shootAt(gunner, victim->pos());
+        world.update(1.0f / 30.0f);
+
+        events.clear();
+        world.events().drain(cursor, events);
+        for (auto& event : events)
+        {
+            REQUIRE(event.player == gunner->handle());
+            if (event.type == GameEventTypes::BulletFired) fired++;
+            if (event.type == GameEventTypes::PlayerHit)
+            {
+                REQUIRE(event.other == victim->handle());
+                REQUIRE(event.value > 0.0f);
+                hits++;
+            }
+            if (event.type == GameEventTypes::PlayerKilled)
+            {
+                REQUIRE(event.other == victim->handle());
+                REQUIRE(event.tick == world.tick() - 1);
+                kills++;
+            }
+        }
+    }
+
+    REQUIRE(victim->health() <= 0.0f);
+    REQUIRE(kills == 1);
+    REQUIRE(hits >= 5);
+    REQUIRE(fired >= hits);
+}
+
+static std::vector<GameEvent> walkPlayers(JobSystem* jobs)
+{
+    World world;
+    world.setJobSystem(jobs);
+    world.changeLevel(openLevel(64, 64));
+    for (int i = 0; i < 2000; i++)
+    {
+        auto player = world.players().addPlayer(i % 64, (i / 64) % 64, Teams::CounterTerrorist);
+        std::vector<tPosition> path = { { (i * 7) % 64, (i * 13) % 64 } };
+        world.players().walkAlong(player, path);
+    }
+
+    GameEventCursor cursor = world.events().end();
+    std::vector<GameEvent> events;
+    for (int tick = 0; tick < 900; tick++)
+    {
+        world.update(1.0f / 30.0f);
+        world.events().drain(cursor, events);
+    }
+
+    return events;
+}
+
+TEST_CASE("Players report finishing their path once, in the same order on any thread", "[game-events]" )
+{
+    auto events = walkPlayers(nullptr);
+
+    std::vector<int> completed(2000, 0);
+    for (auto& event : events)
+    {
+        REQUIRE(event.type == GameEventTypes::PathCompleted);
+        completed[event.player]++;
+    }
+    for (int i = 0; i < 2000; i++) REQUIRE(completed[i] == 1);
+
+    JobSystem jobs(4);
+    auto parallel = walkPlayers(&jobs);
+    REQUIRE(parallel.size() == events.size());
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        REQUIRE(parallel[i].player == events[i].player);
+        REQUIRE(parallel[i].tick == events[i].tick);
+    }
+}
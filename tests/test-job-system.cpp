@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <bots.h>
+#include <job-system.h>
+#include <world.h>
+
+#include <mutex>
+
+TEST_CASE("Parallel for visits every index exactly once", "[jobs]" )
+{
+    JobSystem jobs(4);
+    REQUIRE(jobs.threadCount() == 4);
+
+    std::vector<std::atomic<int> > visits(10000);
+    for (auto& visit : visits) visit = 0;
+
+    jobs.parallelFor(0, 10000, 64, [&visits] (int from, int to) {
+        for (int i = from; i < to; i++) visits[i]++;
+    });
+
+    for (auto& visit : visits) REQUIRE(visit == 1);
+
+    int serial = 0;
+    obj_ParallelFor(nullptr, 5, 10, 1, [&serial] (int from, int to) { serial += to - from; });
+    REQUIRE(serial == 5);
+}
+
+TEST_CASE("Jobs can wait for jobs they started", "[jobs]" )
+{
+    JobSystem jobs(3);
+    std::atomic<int> leaves(0);
+
+    JobCounter counter;
+    for (int i = 0; i < 8; i++)
+    {
+        jobs.run([&jobs, &leaves] () {
+            jobs.parallelFor(0, 100, 10, [&leaves] (int from, int to) { leaves += to - from; });
+        }, counter);
+    }
+    jobs.wait(counter);
+
+    REQUIRE(counter.isDone());
+    REQUIRE(leaves == 800);
+}
+
+TEST_CASE("Frame graph passes run after their dependencies", "[jobs]" )
+{
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto log = [&mutex, &order] (const std::string& name) {
+        return [&mutex, &order, name] () {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+        };
+    };
+
+    FrameGraph graph;
+    auto a = graph.add("a", log("a"));
+    auto b = graph.add("b", log("b"));
+    auto c = graph.add("c", log("c"), { a });
+    auto d = graph.add("d", log("d"), { b, c });
+    REQUIRE(graph.passCount() == 4);
+    REQUIRE(graph.name(d) == "d");
+    REQUIRE(graph.dependencies(d).size() == 2);
+
+    graph.run(nullptr);
+    REQUIRE(order == std::vector<std::string>({ "a", "b", "c", "d" }));
+
+    JobSystem jobs(4);
+    for (int run = 0; run < 50; run++)
+    {
+        order.clear();
+        graph.run(&jobs);
+
+        REQUIRE(order.size() == 4);
+        auto at = [&order] (const std::string& name) { return std::find(order.begin(), order.end(), name) - order.begin(); };
+        REQUIRE(at("a") < at("c"));
+        REQUIRE(at("b") < at("d"));
+        REQUIRE(at("c") < at("d"));
+    }
+}
+
+static std::vector<uint64_t> playMatch(JobSystem* jobs)
+{
+    World world(9);
+    world.setJobSystem(jobs);
+    world.changeLevel(openLevel(64, 64));
+    for (int i = 0; i < 40; i++) world.players().addPlayer(2 + (i % 10) * 6, 4 + (i / 10) * 16, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+
+    BotController bots(&world);
+    std::vector<uint64_t> hashes;
+    for (int tick = 0; tick < 400; tick++)
+    {
+        bots.update(1.0f / 30.0f);
+        world.update(1.0f / 30.0f);
+        hashes.push_back(world.stateHash());
+    }
+
+    return hashes;
+}
+
+TEST_CASE("Worlds end up the same with and without a job system", "[jobs]" )
+{
+    JobSystem jobs(4);
+    REQUIRE(playMatch(&jobs) == playMatch(nullptr));
+}
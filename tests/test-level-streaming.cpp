@@ -0,0 +1,119 @@
+#include "catch.hpp"
+
+#include <level-streaming.h>
+#include <stb_image.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Streamed level description is read", "[level-streaming]" )
+{
+    LevelStreamer streamer;
+    REQUIRE(streamer.open(TESTS_DATA_DIR "/streamed"));
+
+    REQUIRE(streamer.width == 1024);
+    REQUIRE(streamer.height == 1024);
+    REQUIRE(streamer.chunkSize == 32);
+    REQUIRE(streamer.spawns.size() == 2);
+    REQUIRE(streamer.spawns[0].type == LevelTileTypes::CounterTerroristSpawn);
+    REQUIRE(streamer.spawns[1].position.x == 1000);
+}
+
+TEST_CASE("Missing streamed level is not opened", "[level-streaming]" )
+{
+    LevelStreamer streamer;
+    REQUIRE_FALSE(streamer.open(TESTS_DATA_DIR "/does-not-exist"));
+}
+
+TEST_CASE("Querying a tile faults its chunk in", "[level-streaming]" )
+{
+    LevelStreamer streamer;
+    REQUIRE(streamer.open(TESTS_DATA_DIR "/streamed"));
+    REQUIRE(streamer.residentCount() == 0);
+
+    // The chunk images are missing, so the tiles are empty
+    auto tile = streamer.tileAt(100, 100);
+    REQUIRE(tile.rgba[3] == 0);
+    REQUIRE(streamer.residentCount() == 1);
+}
+
+TEST_CASE("Resident chunks stay bounded", "[level-streaming]" )
+{
+    LevelStreamer streamer(8);
+    REQUIRE(streamer.open(TESTS_DATA_DIR "/streamed"));
+
+    for (int y = 0; y < 1024; y += 32)
+    {
+        for (int x = 0; x < 1024; x += 32)
+        {
+            streamer.tileAt(x, y);
+            REQUIRE(streamer.residentCount() <= 8);
+        }
+    }
+}
+
+static bool sameTile(const Tile& a, const unsigned char* b)
+{
+    return a.rgba[0] == b[0] && a.rgba[1] == b[1] && a.rgba[2] == b[2] && a.rgba[3] == b[3];
+}
+
+TEST_CASE("Streamed tiles are the tiles of the source image", "[level-streaming]" )
+{
+    // The level is the source image cut in chunks, the ones on the right and bottom edge are smaller
+    int width = 0, height = 0, comp = 0;
+    auto source = stbi_load(TESTS_DATA_DIR "/streamed-tiles/walkable.png", &width, &height, &comp, 4);
+    REQUIRE(source != nullptr);
+
+    // Two resident chunks at most, so chunks are evicted and loaded again on the way
+    LevelStreamer streamer(2);
+    REQUIRE(streamer.open(TESTS_DATA_DIR "/streamed-tiles"));
+    REQUIRE(streamer.width == width);
+    REQUIRE(streamer.height == height);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                REQUIRE(sameTile(streamer.tileAt(x, y), &source[(y * width + x) * 4]));
+            }
+        }
+    }
+
+    // Outside of the level the tiles are empty
+    REQUIRE(streamer.tileAt(width + 1, height - 1).rgba[3] == 0);
+
+    stbi_image_free(source);
+}
+
+TEST_CASE("Threads faulting chunks in at the same time all get their tiles", "[level-streaming]" )
+{
+    int width = 0, height = 0, comp = 0;
+    auto source = stbi_load(TESTS_DATA_DIR "/streamed-tiles/walkable.png", &width, &height, &comp, 4);
+    REQUIRE(source != nullptr);
+
+    // One resident chunk for four threads, every load evicts the chunk another thread waited for
+    LevelStreamer streamer(1);
+    REQUIRE(streamer.open(TESTS_DATA_DIR "/streamed-tiles"));
+
+    std::atomic<int> wrong(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back(std::thread([&streamer, &wrong, source, width, height, t] () {
+            for (int i = 0; i < 2000; i++)
+            {
+                int x = (i * 7 + t * 32) % width, y = (i * 13 + t * 32) % height;
+                if (!sameTile(streamer.tileAt(x, y), &source[(y * width + x) * 4])) wrong++;
+            }
+        }));
+    }
+    for (auto& thread : threads) thread.join();
+
+    REQUIRE(wrong == 0);
+    REQUIRE(streamer.residentCount() <= 4);
+
+    stbi_image_free(source);
+}
@@ -0,0 +1,43 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <world.h>
+
+TEST_CASE("Reloading changed walkable tiles updates a level in play", "[level]" )
+{
+    WorkingDirectory directory(TESTS_DATA_DIR "/reload");
+
+    // The same level after a gap was cut in the wall and a block was put in front of the spawn
+    Level expected;
+    REQUIRE(expected.prepare("after"));
+
+    auto level = new Level();
+    REQUIRE(level->prepare("before"));
+    World world;
+    world.changeLevel(level);
+    auto player = world.players().addPlayer(10, 12, Teams::CounterTerrorist);
+    auto pos = player->pos();
+    auto count = world.players()._players.size();
+    REQUIRE_FALSE(level->canSee({ 10, 12 }, { 30, 12 }));
+    REQUIRE(level->isWalkable(31, 6));
+
+    level->_name = "after";
+    REQUIRE(level->reload());
+    REQUIRE_FALSE(level->reload());
+
+    for (int y = 0; y < level->height; y++)
+    {
+        for (int x = 0; x < level->width; x++)
+        {
+            REQUIRE(level->tile(x, y) == expected.tile(x, y));
+            REQUIRE(level->wallDistance(x, y) == expected.wallDistance(x, y));
+        }
+    }
+    REQUIRE(level->canSee({ 10, 12 }, { 30, 12 }));
+    REQUIRE_FALSE(level->isWalkable(31, 6));
+
+    // The spawns are the ones the level was prepared with and nobody is moved
+    REQUIRE(level->_spawns.size() == 2);
+    REQUIRE(world.players()._players.size() == count);
+    REQUIRE(player->pos() == pos);
+}
@@ -0,0 +1,95 @@
+#ifndef TEST_LEVELS_H
+#define TEST_LEVELS_H
+
+#include <cstdlib>
+#include <filesystem>
+
+#include "distance-field.h"
+#include "level.h"
+#include "world.h"
+
+// Levels made up in memory for the tests and benchmarks. A tile is a wall wherever isWall returns
+// true, everything else can be walked on and seen through. The distance field and the visible set
+// of a level prepared from disk are only built when asked for.
+template <class TIsWall>
+Level* makeLevel(int width, int height, TIsWall isWall, bool derivedData = false)
+{
+    auto level = new Level();
+    level->width = width;
+    level->height = height;
+
+    // Allocated the way stb_image does, the level frees its tiles with stbi_image_free
+    level->_tiles = (Tile*)std::malloc(width * height * sizeof(Tile));
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            tPosition position = { x, y };
+            Tile tile = { { 255, 255, 255, (unsigned char)(isWall(position) ? 0 : 255) } };
+            level->_tiles[y * width + x] = tile;
+        }
+    }
+
+    if (derivedData)
+    {
+        level->_distance = obj_GetDistanceField(width, height, [level] (const tPosition& position) {
+            return !level->isWalkable(position.x, position.y);
+        });
+        level->_pvs.build(width, height, [level] (const tPosition& position) {
+            return level->isTransparent(position.x, position.y);
+        });
+    }
+
+    return level;
+}
+
+inline Level* openLevel(int width, int height)
+{
+    return makeLevel(width, height, [] (const tPosition& position) { return false; });
+}
+
+// Walls every few tiles across the level, each with a gap, and a few pillars in between
+inline Level* walledLevel(int width, int height)
+{
+    return makeLevel(width, height, [] (const tPosition& position) {
+        return (position.x % 16 == 8 && position.y % 24 > 3) || (position.x * 7 + position.y * 13) % 29 == 0;
+    }, true);
+}
+
+// Two teams of 250 crossing each other through an eight tile gap in a wall, each player to the spot
+// across from where it started. They start and stop two tiles apart, players that made it across
+// would otherwise stand as a fence in front of the ones still coming.
+inline void addChokepointCrowd(World& world)
+{
+    world.changeLevel(makeLevel(128, 64, [] (const tPosition& position) {
+        return position.x == 64 && (position.y < 28 || position.y >= 36);
+    }));
+
+    for (int i = 0; i < 500; i++)
+    {
+        bool left = i % 2 == 0;
+        int x = (left ? 8 : 76) + ((i / 2) % 22) * 2, y = 4 + ((i / 2) / 22) * 5;
+        auto player = world.players().addPlayer(x, y, left ? Teams::CounterTerrorist : Teams::Terrorist);
+        world.players()._storage.setPath(player->slot(), { { 64, 32 }, { left ? x + 68 : x - 68, y } });
+    }
+}
+
+// Levels are loaded from the radars directory next to the working directory
+class WorkingDirectory
+{
+public:
+    WorkingDirectory(const std::filesystem::path& path) : _previous(std::filesystem::current_path())
+    {
+        std::filesystem::current_path(path);
+    }
+
+    ~WorkingDirectory()
+    {
+        std::filesystem::current_path(this->_previous);
+    }
+
+private:
+    std::filesystem::path _previous;
+};
+
+#endif // TEST_LEVELS_H
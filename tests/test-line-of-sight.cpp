@@ -0,0 +1,191 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <visibility.h>
+#include <world.h>
+
+#include <algorithm>
+
+static void addPlayers(World& world, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int x = world.random().range(0, world.level()->width - 1), y = world.random().range(0, world.level()->height - 1);
+        world.players().addPlayer(x, y, Teams(i % 3));
+    }
+}
+
+static tPosition tileOf(const PlayerStorage& players, int slot)
+{
+    tPosition position = { int(players._posX[slot] / LEVEL_TILE_WORLD_SIZE), int(players._posY[slot] / LEVEL_TILE_WORLD_SIZE) };
+    return position;
+}
+
+// Checks every pair of players against the level
+static void requireMatchesLevel(World& world, const LineOfSightMatrix& matrix)
+{
+    auto& players = world.players()._storage;
+    REQUIRE(matrix.size() == players.size());
+
+    // Straight from the tiles, the visible set of the level is not what is being checked against
+    auto level = world.level();
+    auto isTransparent = [level] (const tPosition& position) { return level->isTransparent(position.x, position.y); };
+
+    for (int slot = 0; slot < players.size(); slot++)
+    {
+        bool seenBy[3] = { false, false, false };
+        for (int other = 0; other < players.size(); other++)
+        {
+            auto from = tileOf(players, slot), to = tileOf(players, other);
+            int dx = to.x - from.x, dy = to.y - from.y;
+            bool visible = other != slot && players._team[other] != players._team[slot] &&
+                    players._health[slot] > 0.0f && players._health[other] > 0.0f &&
+                    dx * dx + dy * dy <= LINE_OF_SIGHT_DISTANCE * LINE_OF_SIGHT_DISTANCE && obj_HasLineOfSight(from, to, isTransparent);
+            REQUIRE(matrix.canSee(slot, other) == visible);
+            if (visible) seenBy[int(players._team[other])] = true;
+        }
+        for (int team = 0; team < 3; team++) REQUIRE(matrix.seenByTeam(Teams(team), slot) == seenBy[team]);
+    }
+}
+
+// Where the player is for the matrix, dead players are on no tile
+static tPosition sightTileOf(const PlayerStorage& players, int slot)
+{
+    tPosition none = { -1, -1 };
+    return players._health[slot] > 0.0f ? tileOf(players, slot) : none;
+}
+
+// Moves some players a little and some far and kills a few, returns how many entered another tile or died
+static int movePlayers(World& world, int count)
+{
+    auto& players = world.players()._storage;
+    auto& random = world.random();
+    std::vector<tPosition> before;
+    for (int slot = 0; slot < players.size(); slot++) before.push_back(sightTileOf(players, slot));
+
+    float maxX = (world.level()->width - 1) * LEVEL_TILE_WORLD_SIZE, maxY = (world.level()->height - 1) * LEVEL_TILE_WORLD_SIZE;
+    for (int i = 0; i < count; i++)
+    {
+        int slot = random.range(0, players.size() - 1);
+        float step = (random.range(0, 3) == 0 ? 40.0f : 1.0f) * LEVEL_TILE_WORLD_SIZE;
+        players._posX[slot] = std::min(std::max(players._posX[slot] + (random.unit() - 0.5f) * step, 0.0f), maxX);
+        players._posY[slot] = std::min(std::max(players._posY[slot] + (random.unit() - 0.5f) * step, 0.0f), maxY);
+        if (random.range(0, 20) == 0) players._health[slot] = 0.0f;
+    }
+    world.players()._playerGridValid = false;
+
+    int moved = 0;
+    for (int slot = 0; slot < players.size(); slot++)
+    {
+        auto after = sightTileOf(players, slot);
+        if (after.x != before[slot].x || after.y != before[slot].y) moved++;
+    }
+
+    return moved;
+}
+
+TEST_CASE("Only players that entered another tile or died are checked again", "[line-of-sight]" )
+{
+    World world;
+    world.changeLevel(walledLevel(128, 96));
+    addPlayers(world, 400);
+
+    auto& matrix = world.players().lineOfSight();
+    REQUIRE(matrix.isValid());
+    REQUIRE(matrix.lastUpdate().moved == 400);
+    REQUIRE(matrix.lastUpdate().culled > 0);
+    requireMatchesLevel(world, matrix);
+
+    world.players().lineOfSight();
+    REQUIRE(matrix.lastUpdate().moved == 0);
+    REQUIRE(matrix.lastUpdate().rays == 0);
+
+    for (int step = 0; step < 20; step++)
+    {
+        int moved = movePlayers(world, 30);
+        world.players().lineOfSight();
+        REQUIRE(matrix.lastUpdate().moved == unsigned(moved));
+        requireMatchesLevel(world, matrix);
+    }
+}
+
+TEST_CASE("Adding and removing players checks every pair again", "[line-of-sight]" )
+{
+    World world;
+    world.changeLevel(walledLevel(96, 96));
+    addPlayers(world, 200);
+    world.players().lineOfSight();
+
+    world.players().removePlayer(world.players()._players[17]);
+    auto& matrix = world.players().lineOfSight();
+    REQUIRE(matrix.lastUpdate().moved == 199);
+    requireMatchesLevel(world, matrix);
+
+    addPlayers(world, 1);
+    world.players().lineOfSight();
+    REQUIRE(matrix.lastUpdate().moved == 200);
+    requireMatchesLevel(world, matrix);
+
+    // The handle and the slot are reused by a player of another team on the same tile
+    auto last = world.players()._players.back();
+    auto pos = last->pos();
+    auto team = last->team() == Teams::Terrorist ? Teams::CounterTerrorist : Teams::Terrorist;
+    auto handle = last->handle();
+    world.players().removePlayer(last);
+    auto replaced = world.players().addPlayer(int(pos.x / LEVEL_TILE_WORLD_SIZE), int(pos.y / LEVEL_TILE_WORLD_SIZE), team);
+    REQUIRE(replaced->handle() == handle);
+    world.players().lineOfSight();
+    REQUIRE(matrix.lastUpdate().moved == 200);
+    requireMatchesLevel(world, matrix);
+
+    world.players()._lineOfSight.invalidate();
+    world.players().lineOfSight();
+    REQUIRE(matrix.lastUpdate().moved == 200);
+}
+
+TEST_CASE("The matrix is the same on any thread", "[line-of-sight]" )
+{
+    JobSystem jobs(4);
+    World serial, parallel;
+    parallel.setJobSystem(&jobs);
+    serial.changeLevel(walledLevel(128, 128));
+    parallel.changeLevel(walledLevel(128, 128));
+    addPlayers(serial, 700);
+    addPlayers(parallel, 700);
+
+    for (int step = 0; step < 10; step++)
+    {
+        movePlayers(serial, 100);
+        movePlayers(parallel, 100);
+
+        auto& expected = serial.players().lineOfSight();
+        auto& matrix = parallel.players().lineOfSight();
+        REQUIRE(matrix.lastUpdate().rays == expected.lastUpdate().rays);
+        for (int slot = 0; slot < matrix.size(); slot++)
+        {
+            for (int w = 0; w < matrix.wordsPerRow(); w++) REQUIRE(matrix.row(slot)[w] == expected.row(slot)[w]);
+        }
+    }
+    requireMatchesLevel(parallel, parallel.players().lineOfSight());
+}
+
+TEST_CASE("The matrix follows the players through the ticks", "[line-of-sight]" )
+{
+    World world;
+    world.changeLevel(walledLevel(64, 64));
+    addPlayers(world, 120);
+    for (int i = 0; i < 120; i++)
+    {
+        std::vector<tPosition> path = { { (i * 7) % 64, (i * 13) % 64 } };
+        world.players().walkAlong(world.players()._players[i], path);
+    }
+
+    // Asked for every few ticks, the matrix catches up with everybody who moved in between
+    for (int tick = 0; tick < 60; tick++)
+    {
+        world.update(1.0f / 30.0f);
+        if (tick % 5 == 0) requireMatchesLevel(world, world.players().lineOfSight());
+    }
+    REQUIRE(world.players().lineOfSight().lastUpdate().moved > 0);
+    REQUIRE(world.players().lineOfSight().lastUpdate().moved == 0);
+}
@@ -0,0 +1,68 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <map-rotation.h>
+
+#include <memory>
+
+TEST_CASE("A map that cannot be prepared at the start of the rotation is skipped", "[map-rotation]" )
+{
+    WorkingDirectory directory(TESTS_DATA_DIR "/reload");
+
+    MapRotation rotation;
+    rotation.setMaps({ "missing", "before", "after" });
+
+    std::vector<std::string> skipped;
+    std::unique_ptr<Level> level(rotation.prepareCurrent(skipped));
+
+    REQUIRE(level != nullptr);
+    REQUIRE(skipped == std::vector<std::string>({ "missing" }));
+    REQUIRE(rotation.current() == "before");
+    REQUIRE(rotation.next() == "after");
+}
+
+TEST_CASE("Preparing a rotation without a map that can be played fails", "[map-rotation]" )
+{
+    WorkingDirectory directory(TESTS_DATA_DIR "/reload");
+
+    MapRotation rotation;
+    rotation.setMaps({ "missing", "gone" });
+
+    std::vector<std::string> skipped;
+    REQUIRE(rotation.prepareCurrent(skipped) == nullptr);
+    REQUIRE(skipped == std::vector<std::string>({ "missing", "gone" }));
+
+    MapRotation empty;
+    REQUIRE(empty.prepareCurrent(skipped) == nullptr);
+}
+
+TEST_CASE("A level without spawns for both teams cannot be played", "[map-rotation]" )
+{
+    std::unique_ptr<Level> level(openLevel(16, 16));
+    REQUIRE_FALSE(MapRotation::isPlayable(*level));
+
+    level->_spawns.push_back({ { 2, 2 }, LevelTileTypes::CounterTerroristSpawn });
+    REQUIRE_FALSE(MapRotation::isPlayable(*level));
+
+    level->_spawns.push_back({ { 12, 12 }, LevelTileTypes::TerroristSpawn });
+    REQUIRE(MapRotation::isPlayable(*level));
+}
+
+TEST_CASE("Skipping every next map exhausts the rotation until a map is played", "[map-rotation]" )
+{
+    MapRotation rotation;
+    rotation.setMaps({ "a", "b", "c" });
+
+    rotation.skipNext();
+    REQUIRE(rotation.next() == "c");
+    REQUIRE_FALSE(rotation.isExhausted());
+
+    rotation.advance();
+    REQUIRE(rotation.current() == "c");
+    REQUIRE(rotation.next() == "a");
+
+    rotation.skipNext();
+    rotation.skipNext();
+    rotation.skipNext();
+    REQUIRE(rotation.isExhausted());
+}
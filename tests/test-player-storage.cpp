@@ -0,0 +1,61 @@
+#include "catch.hpp"
+
+#include <player-storage.h>
+
+TEST_CASE("Handles stay valid when other players are removed", "[player-storage]" )
+{
+    PlayerStorage storage;
+    auto a = storage.add(1.0f, 1.0f, Teams::CounterTerrorist, "a");
+    auto b = storage.add(2.0f, 2.0f, Teams::Terrorist, "b");
+    auto c = storage.add(3.0f, 3.0f, Teams::Terrorist, "c");
+    REQUIRE(storage.size() == 3);
+
+    storage.remove(a);
+    REQUIRE(storage.size() == 2);
+    REQUIRE_FALSE(storage.isValid(a));
+
+    // The last player moved into the free slot
+    REQUIRE(storage.slot(c) == 0);
+    REQUIRE(storage._posX[storage.slot(c)] == 3.0f);
+    REQUIRE(storage._name[storage.slot(c)] == "c");
+    REQUIRE(storage._posX[storage.slot(b)] == 2.0f);
+    REQUIRE(storage._team[storage.slot(b)] == Teams::Terrorist);
+}
+
+TEST_CASE("Handles of removed players are reused", "[player-storage]" )
+{
+    PlayerStorage storage;
+    auto a = storage.add(1.0f, 1.0f, Teams::CounterTerrorist, "a");
+    storage.add(2.0f, 2.0f, Teams::Terrorist, "b");
+
+    storage.remove(a);
+    auto c = storage.add(3.0f, 3.0f, Teams::Terrorist, "c");
+    REQUIRE(c == a);
+    REQUIRE(storage.slot(c) == 1);
+    REQUIRE(storage._health[storage.slot(c)] == 1.0f);
+
+    storage.remove(INVALID_PLAYER_HANDLE);
+    REQUIRE(storage.size() == 2);
+}
+
+TEST_CASE("Paths are walked from the pool", "[player-storage]" )
+{
+    PlayerStorage storage;
+    auto a = storage.add(0.0f, 0.0f, Teams::CounterTerrorist, "a");
+    REQUIRE(storage._paths.isEmpty(storage._path[storage.slot(a)]));
+
+    storage.setPath(storage.slot(a), { { 1, 2 }, { 3, 4 } });
+
+    tPosition waypoint;
+    REQUIRE(storage._paths.next(storage._path[storage.slot(a)], waypoint));
+    REQUIRE(waypoint.x == 1);
+    REQUIRE(storage._paths.next(storage._path[storage.slot(a)], waypoint));
+    REQUIRE(waypoint.y == 4);
+    REQUIRE_FALSE(storage._paths.next(storage._path[storage.slot(a)], waypoint));
+
+    // A new path reuses the released one
+    auto path = storage._path[storage.slot(a)];
+    storage.setPath(storage.slot(a), { { 5, 6 } });
+    REQUIRE(storage._path[storage.slot(a)] == path);
+    REQUIRE(storage._paths.cursor(path) == 0);
+}
@@ -1,38 +1,43 @@
 #include "catch.hpp"
 #include "players.h"
+#include "world.h"
+
+#include <cmath>
 
 TEST_CASE("Select one player", "[players]" )
 {
-    Player::Manager().resetPlayers();
-    REQUIRE(Player::Manager()._selectedPlayer == nullptr);
+    World world;
+    auto& players = world.players();
+    REQUIRE(players._selectedPlayer == nullptr);
 
-    auto a = Player::Manager().addPlayer(0, 0, Teams::CounterTerrorist);
+    auto a = players.addPlayer(0, 0, Teams::CounterTerrorist);
 
     // Clicking far away from the player, will not select it
-    Player::Manager().clickAt(0, 100);
-    REQUIRE(Player::Manager()._selectedPlayer == nullptr);
+    players.clickAt(0, 100);
+    REQUIRE(players._selectedPlayer == nullptr);
 
     // Clicking nearby the player will select it
-    Player::Manager().clickAt(0, 1);
-    REQUIRE(Player::Manager()._selectedPlayer == a);
+    players.clickAt(0, 1);
+    REQUIRE(players._selectedPlayer == a);
 }
 
 TEST_CASE("Circle select two players", "[players]" )
 {
-    Player::Manager().resetPlayers();
-    REQUIRE(Player::Manager()._selectedPlayer == nullptr);
+    World world;
+    auto& players = world.players();
+    REQUIRE(players._selectedPlayer == nullptr);
 
-    auto a = Player::Manager().addPlayer(0, 0, Teams::CounterTerrorist);
-    auto b = Player::Manager().addPlayer(0, 1, Teams::CounterTerrorist);
+    auto a = players.addPlayer(0, 0, Teams::CounterTerrorist);
+    auto b = players.addPlayer(0, 1, Teams::CounterTerrorist);
 
-    Player::Manager().clickAt(0, 1);
-    auto selection1 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection1 = players._selectedPlayer;
 
-    Player::Manager().clickAt(0, 1);
-    auto selection2 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection2 = players._selectedPlayer;
 
-    Player::Manager().clickAt(0, 1);
-    auto selection3 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection3 = players._selectedPlayer;
 
     REQUIRE(selection1 != selection2);
     REQUIRE(selection2 != selection3);
@@ -41,35 +46,144 @@ TEST_CASE("Circle select two players", "[players]" )
 
 TEST_CASE("Circle select three players", "[players]" )
 {
-    Player::Manager().resetPlayers();
-    REQUIRE(Player::Manager()._selectedPlayer == nullptr);
+    World world;
+    auto& players = world.players();
+    REQUIRE(players._selectedPlayer == nullptr);
 
-    auto a = Player::Manager().addPlayer(0, 0, Teams::CounterTerrorist);
-    auto b = Player::Manager().addPlayer(0, 1, Teams::CounterTerrorist);
-    auto c = Player::Manager().addPlayer(0, 1, Teams::CounterTerrorist);
+    auto a = players.addPlayer(0, 0, Teams::CounterTerrorist);
+    auto b = players.addPlayer(0, 1, Teams::CounterTerrorist);
+    auto c = players.addPlayer(0, 1, Teams::CounterTerrorist);
 
-    Player::Manager().clickAt(0, 1);
-    auto selection1 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection1 = players._selectedPlayer;
 
-    Player::Manager().clickAt(0, 1);
-    auto selection2 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection2 = players._selectedPlayer;
 
     REQUIRE(selection1 != selection2);
 
-    Player::Manager().clickAt(0, 1);
-    auto selection3 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection3 = players._selectedPlayer;
 
     REQUIRE(selection2 != selection3);
 
-    Player::Manager().clickAt(0, 1);
-    auto selection4 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection4 = players._selectedPlayer;
 
     REQUIRE(selection3 != selection4);
     REQUIRE(selection1 == selection4);
 
-    Player::Manager().clickAt(0, 1);
-    auto selection5 = Player::Manager()._selectedPlayer;
+    players.clickAt(0, 1);
+    auto selection5 = players._selectedPlayer;
 
     REQUIRE(selection4 != selection5);
     REQUIRE(selection2 == selection5);
 }
+
+TEST_CASE("Removing a player keeps the other players", "[players]" )
+{
+    World world;
+    auto& players = world.players();
+
+    auto a = players.addPlayer(0, 0, Teams::CounterTerrorist);
+    auto b = players.addPlayer(10, 0, Teams::Terrorist);
+    auto c = players.addPlayer(20, 0, Teams::Terrorist);
+
+    players.clickAt(160, 0);
+    REQUIRE(players._selectedPlayer == c);
+
+    auto handle = a->handle();
+    players.removePlayer(a);
+    REQUIRE(players.player(handle) == nullptr);
+    REQUIRE(players._players.size() == 2);
+
+    // Views keep pointing at the same player after the storage moved it
+    REQUIRE(players._selectedPlayer == c);
+    REQUIRE(c->pos().x == 160.0f);
+    REQUIRE(b->team() == Teams::Terrorist);
+    REQUIRE(players._players[c->slot()] == c);
+}
+
+TEST_CASE("Players are drawn between the last two ticks", "[players]" )
+{
+    World world;
+    auto& players = world.players();
+    auto player = players.addPlayer(0, 0, Teams::CounterTerrorist);
+    players._storage.setPath(player->slot(), { { 10, 0 } });
+
+    // The first tick only takes the first waypoint
+    world.update(1.0f / 30.0f);
+    world.update(1.0f / 30.0f);
+    auto before = players._storage._prevPosX[player->slot()];
+    REQUIRE(player->pos().x > before);
+    REQUIRE(player->pos(0.0f).x == before);
+    REQUIRE(player->pos(1.0f).x == player->pos().x);
+    REQUIRE(player->pos(0.5f).x == Approx((before + player->pos().x) / 2.0f));
+}
+
+TEST_CASE("Players move the same in lanes as one by one", "[players]" )
+{
+    World world;
+    auto& players = world.players();
+    auto& storage = players._storage;
+
+    // Not a multiple of the lane width, with dead players and players without a path mixed in
+    const int count = 103;
+    for (int i = 0; i < count; i++)
+    {
+        auto player = players.addPlayer(i % 13, i % 7, Teams::CounterTerrorist);
+        if (i % 5 != 0) storage.setPath(player->slot(), { { (i * 3) % 17, (i * 5) % 11 }, { 2, 2 }, { i % 9, 12 } });
+        if (i % 11 == 0) storage._health[player->slot()] = 0.0f;
+    }
+
+    for (int tick = 0; tick < 120; tick++)
+    {
+        auto posX = storage._posX, posY = storage._posY, walkToX = storage._walkToX, walkToY = storage._walkToY;
+        auto dirX = storage._dirX, dirY = storage._dirY;
+
+        // The loop as it was before it was vectorized
+        float distance = 50.0f * (1.0f / 30.0f);
+        std::vector<int> cursors;
+        for (int i = 0; i < count; i++) cursors.push_back(storage._paths.isEmpty(storage._path[i]) ? -1 : storage._paths.cursor(storage._path[i]));
+        for (int i = 0; i < count; i++)
+        {
+            if (storage._health[i] <= 0.0f) continue;
+
+            float todoX = walkToX[i] - posX[i], todoY = walkToY[i] - posY[i];
+            float todo = std::sqrt(todoX * todoX + todoY * todoY);
+            if (todo < distance)
+            {
+                posX[i] = walkToX[i];
+                posY[i] = walkToY[i];
+                if (cursors[i] >= 0)
+                {
+                    auto& waypoints = storage._paths.waypoints(storage._path[i]);
+                    walkToX[i] = waypoints[cursors[i]].x * LEVEL_TILE_WORLD_SIZE;
+                    walkToY[i] = waypoints[cursors[i]].y * LEVEL_TILE_WORLD_SIZE;
+                }
+            }
+            else if (todo > 0.001f)
+            {
+                posX[i] += (todoX / todo) * distance;
+                posY[i] += (todoY / todo) * distance;
+            }
+
+            float x = posX[i] - walkToX[i], y = posY[i] - walkToY[i];
+            float length = std::sqrt(x * x + y * y);
+            if (length > 0.001f)
+            {
+                dirX[i] = x / length;
+                dirY[i] = y / length;
+            }
+        }
+
+        world.update(1.0f / 30.0f);
+
+        REQUIRE(storage._posX == posX);
+        REQUIRE(storage._posY == posY);
+        REQUIRE(storage._walkToX == walkToX);
+        REQUIRE(storage._walkToY == walkToY);
+        REQUIRE(storage._dirX == dirX);
+        REQUIRE(storage._dirY == dirY);
+    }
+}
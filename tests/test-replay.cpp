@@ -0,0 +1,236 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <replay.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static void setUpMatch(World& world)
+{
+    auto level = openLevel(64, 64);
+    level->_name = "open";
+    world.changeLevel(level);
+    for (int i = 0; i < 6; i++)
+    {
+        world.players().addPlayer(4 + i * 8, 10, Teams::CounterTerrorist);
+        world.players().addPlayer(4 + i * 8, 50, Teams::Terrorist);
+    }
+}
+
+// Plays the same input a user could give, and remembers the state hash after every tick
+static std::vector<uint64_t> playInput(World& world, ReplayRecorder* recorder)
+{
+    std::vector<uint64_t> hashes;
+    for (int tick = 0; tick < 700; tick++)
+    {
+        std::vector<Command> commands;
+        if (tick % 90 == 5) commands.push_back({ CommandTypes::SelectPlayer, (tick / 90) % 12, 0 });
+        if (tick % 90 == 6) commands.push_back({ CommandTypes::ClickAt, 8 * (10 + (tick % 40)), 8 * (20 + (tick % 23)) });
+        if (tick % 30 == 12) commands.push_back({ CommandTypes::Shoot, 0, 0 });
+
+        for (auto& command : commands)
+        {
+            if (recorder != nullptr) recorder->record(world, command);
+            world.execute(command);
+        }
+
+        world.update(1.0f / 30.0f);
+        if (recorder != nullptr) recorder->update(world);
+        hashes.push_back(world.stateHash());
+    }
+
+    return hashes;
+}
+
+TEST_CASE("State buffers round trip varints and arrays", "[replay]" )
+{
+    std::vector<unsigned char> data;
+    StateWriter writer(data);
+    writer.writeVarint(0);
+    writer.writeVarint(127);
+    writer.writeVarint(128);
+    writer.writeVarint(0xffffffffffffffffULL);
+    writer.writeSigned(-1);
+    writer.writeSigned(-300);
+    writer.writeString("de_dust");
+    writer.writeArray(std::vector<float>({ 1.5f, -2.0f }));
+
+    // Small values take a single byte
+    REQUIRE(data.size() == 1 + 1 + 2 + 10 + 1 + 2 + 8 + 9);
+
+    StateReader reader(data.data(), data.size());
+    REQUIRE(reader.readVarint() == 0);
+    REQUIRE(reader.readVarint() == 127);
+    REQUIRE(reader.readVarint() == 128);
+    REQUIRE(reader.readVarint() == 0xffffffffffffffffULL);
+    REQUIRE(reader.readSigned() == -1);
+    REQUIRE(reader.readSigned() == -300);
+    REQUIRE(reader.readString() == "de_dust");
+    std::vector<float> values;
+    REQUIRE(reader.readArray(values));
+    REQUIRE(values == std::vector<float>({ 1.5f, -2.0f }));
+    REQUIRE(reader.isAtEnd());
+    REQUIRE_FALSE(reader.failed());
+
+    REQUIRE(reader.readVarint() == 0);
+    REQUIRE(reader.failed());
+}
+
+TEST_CASE("Restoring a world state continues the same simulation", "[replay]" )
+{
+    World world(5);
+    setUpMatch(world);
+    playInput(world, nullptr);
+
+    std::vector<unsigned char> state;
+    StateWriter writer(state);
+    world.writeState(writer);
+    auto hash = world.stateHash();
+
+    World copy(99);
+    copy.changeLevel(openLevel(64, 64));
+    StateReader reader(state.data(), state.size());
+    REQUIRE(copy.readState(reader));
+    REQUIRE(copy.stateHash() == hash);
+
+    for (int i = 0; i < 100; i++)
+    {
+        world.update(1.0f / 30.0f);
+        copy.update(1.0f / 30.0f);
+    }
+    REQUIRE(copy.stateHash() == world.stateHash());
+
+    StateReader truncated(state.data(), state.size() / 2);
+    REQUIRE_FALSE(copy.readState(truncated));
+}
+
+TEST_CASE("Replays play back the recorded match", "[replay]" )
+{
+    const char* filename = "test-replay.rsrp";
+
+    World world(11);
+    setUpMatch(world);
+    auto startHash = world.stateHash();
+
+    ReplayRecorder recorder(100);
+    REQUIRE(recorder.start(filename, world, 1.0f / 30.0f));
+    auto hashes = playInput(world, &recorder);
+    recorder.stop(world);
+    REQUIRE_FALSE(recorder.isRecording());
+
+    ReplayPlayer player;
+    REQUIRE(player.open(filename));
+    REQUIRE(player.seed() == 11);
+    REQUIRE(player.levelName() == "open");
+    REQUIRE(player.tickLength() == 1.0f / 30.0f);
+    REQUIRE(player.firstTick() == 0);
+    REQUIRE(player.lastTick() == 700);
+    REQUIRE(player.keyframes().size() == 8);
+    REQUIRE(player.commands().size() == 8 + 8 + 23);
+
+    World playback(11);
+    playback.changeLevel(openLevel(64, 64));
+    REQUIRE(player.seek(playback, 0));
+    REQUIRE(playback.stateHash() == startHash);
+
+    for (size_t tick = 0; tick < hashes.size(); tick++)
+    {
+        INFO("tick " << tick);
+        REQUIRE(player.step(playback));
+        REQUIRE(playback.stateHash() == hashes[tick]);
+    }
+    REQUIRE_FALSE(player.step(playback));
+
+    // Seeking backwards and in between keyframes gives the same state as playing up to there
+    REQUIRE(player.seek(playback, 450));
+    REQUIRE(playback.tick() == 450);
+    REQUIRE(playback.stateHash() == hashes[449]);
+    REQUIRE(player.seek(playback, 100));
+    REQUIRE(playback.stateHash() == hashes[99]);
+
+    std::remove(filename);
+}
+
+// Writes the replay with one int of the first keyframe replaced, and seeks to that keyframe
+static bool seekCorrupted(const std::vector<unsigned char>& data, size_t at, int32_t value, World& world)
+{
+    const char* filename = "test-replay-corrupted.rsrp";
+
+    auto corrupted = data;
+    std::memcpy(corrupted.data() + at, &value, sizeof(value));
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(corrupted.data()), corrupted.size());
+    }
+
+    ReplayPlayer player;
+    bool valid = player.open(filename) && player.seek(world, 0);
+    std::remove(filename);
+
+    return valid;
+}
+
+TEST_CASE("Replays with corrupted keyframes fail to seek", "[replay]" )
+{
+    const char* filename = "test-replay.rsrp";
+
+    World world(11);
+    setUpMatch(world);
+    ReplayRecorder recorder(100);
+    REQUIRE(recorder.start(filename, world, 1.0f / 30.0f));
+    playInput(world, &recorder);
+    recorder.stop(world);
+
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    ReplayPlayer player;
+    REQUIRE(player.open(filename));
+    auto keyframe = player.keyframes()[0];
+    std::remove(filename);
+
+    // The handles of the twelve players, stored after their count. The slots that follow hold the same values.
+    std::vector<unsigned char> handles = { 12 };
+    for (int32_t handle = 0; handle < 12; handle++)
+    {
+        auto bytes = reinterpret_cast<const unsigned char*>(&handle);
+        handles.insert(handles.end(), bytes, bytes + sizeof(handle));
+    }
+    auto begin = data.begin() + keyframe.offset;
+    auto found = std::search(begin, begin + keyframe.size, handles.begin(), handles.end());
+    REQUIRE(found != begin + keyframe.size);
+    size_t at = size_t(found - data.begin()) + 1;
+
+    World playback(11);
+    playback.changeLevel(openLevel(64, 64));
+    REQUIRE(seekCorrupted(data, at, 0, playback));
+    REQUIRE(playback.players()._players.size() == 12);
+
+    // A handle that is negative, out of the slots or taken by another player
+    for (int32_t handle : { -5, 1 << 30, 3 })
+    {
+        INFO("handle " << handle);
+        REQUIRE_FALSE(seekCorrupted(data, at, handle, playback));
+        REQUIRE(playback.players()._players.empty());
+    }
+
+    // Whatever is stored, seeking either restores a consistent world or fails
+    for (size_t i = keyframe.offset; i + sizeof(int32_t) <= keyframe.offset + keyframe.size; i++)
+    {
+        for (int32_t value : { -1, 0x7fffffff })
+        {
+            if (!seekCorrupted(data, i, value, playback)) continue;
+
+            auto& players = playback.players();
+            for (size_t slot = 0; slot < players._players.size(); slot++)
+            {
+                INFO("corrupted at " << i - keyframe.offset);
+                REQUIRE(players._players[slot]->slot() == int(slot));
+            }
+        }
+    }
+}
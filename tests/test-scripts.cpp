@@ -0,0 +1,178 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <world.h>
+#include <world-snapshot.h>
+
+#include <cmath>
+#include <cstdlib>
+
+static Script waitTicksAndSeconds(World& world, std::vector<unsigned int>& resumed)
+{
+    resumed.push_back(world.tick());
+    co_await world.scripts().nextTick();
+    resumed.push_back(world.tick());
+    co_await world.scripts().ticks(5);
+    resumed.push_back(world.tick());
+    co_await world.scripts().seconds(1.0f);
+    resumed.push_back(world.tick());
+    co_await world.scripts().ticks(0);
+    resumed.push_back(world.tick());
+    co_await world.scripts().ticks(SCRIPT_TICK_WHEEL_SIZE + 20);
+    resumed.push_back(world.tick());
+}
+
+TEST_CASE("Scripts wait for ticks and seconds", "[scripts]" )
+{
+    World world;
+    std::vector<unsigned int> resumed;
+    world.scripts().start(waitTicksAndSeconds(world, resumed));
+    REQUIRE(world.scripts().count() == 1);
+    REQUIRE(resumed.empty());
+
+    for (int tick = 0; tick < 128; tick++) world.update(0.1f);
+
+    std::vector<unsigned int> expected = { 0, 1, 6, 16, 16, 16 + SCRIPT_TICK_WHEEL_SIZE + 20 };
+    REQUIRE(resumed == expected);
+    REQUIRE(world.scripts().count() == 0);
+}
+
+TEST_CASE("Sleeping scripts wake on time when the world goes back", "[scripts]" )
+{
+    World world;
+    std::vector<unsigned int> resumed;
+    world.scripts().start(waitTicksAndSeconds(world, resumed));
+    world.update(0.1f);
+    world.update(0.1f);
+
+    WorldSnapshot snapshot;
+    snapshot.capture(world);
+    for (int tick = 0; tick < 3; tick++) world.update(0.1f);
+    REQUIRE(snapshot.restore(world));
+
+    // Back at tick 2, the script still waits for tick 6
+    for (int tick = 0; tick < 5; tick++) world.update(0.1f);
+
+    std::vector<unsigned int> expected = { 0, 1, 6 };
+    REQUIRE(resumed == expected);
+}
+
+static Script walkAndWait(World& world, PlayerHandle player, const tPosition& to, unsigned int& arrived)
+{
+    world.players().walkTo(world.players().player(player), to);
+    co_await world.scripts().arrival(player);
+    arrived = world.tick();
+}
+
+TEST_CASE("Scripts wait for players to arrive", "[scripts]" )
+{
+    World world;
+    world.changeLevel(openLevel(32, 32));
+    auto player = world.players().addPlayer(4, 4, Teams::CounterTerrorist);
+
+    unsigned int arrived = 0;
+    world.scripts().start(walkAndWait(world, player->handle(), { 12, 4 }, arrived));
+
+    world.update(0.05f);
+    REQUIRE(player->hasPath());
+    for (int tick = 0; tick < 200 && world.scripts().count() > 0; tick++) world.update(0.05f);
+
+    REQUIRE(world.scripts().count() == 0);
+    REQUIRE(arrived > 1);
+    REQUIRE(!player->hasPath());
+    REQUIRE(std::abs(player->pos().x - 12 * LEVEL_TILE_WORLD_SIZE) <= LEVEL_TILE_WORLD_SIZE);
+}
+
+static Script waitForEvent(World& world, int event, std::vector<int>& order, int id)
+{
+    co_await world.scripts().event(event);
+    order.push_back(id);
+}
+
+TEST_CASE("Scripts wait for events and wake in the order they slept", "[scripts]" )
+{
+    World world;
+    std::vector<int> order;
+    for (int i = 0; i < 4; i++) world.scripts().start(waitForEvent(world, i % 2, order, i));
+
+    world.update(0.05f);
+    world.scripts().fire(7);
+    world.update(0.05f);
+    REQUIRE(order.empty());
+
+    world.scripts().fire(1);
+    world.scripts().fire(0);
+    world.update(0.05f);
+
+    std::vector<int> expected = { 0, 1, 2, 3 };
+    REQUIRE(order == expected);
+    REQUIRE(world.scripts().count() == 0);
+}
+
+// Walk to A, wait two seconds, shoot until the target is dead
+static Script ambush(World& world, PlayerHandle gunner, PlayerHandle target, const tPosition& at)
+{
+    auto& players = world.players();
+    players.walkTo(players.player(gunner), at);
+    co_await world.scripts().arrival(gunner);
+    co_await world.scripts().seconds(2.0f);
+
+    while (players.player(target)->health() > 0.0f)
+    {
+        players.shootAt(players.player(gunner), players.player(target)->pos());
+        co_await world.scripts().ticks(5);
+    }
+}
+
+TEST_CASE("Scripts play scenarios of many steps", "[scripts]" )
+{
+    World world;
+    world.changeLevel(openLevel(32, 32));
+    auto gunner = world.players().addPlayer(4, 4, Teams::CounterTerrorist);
+    auto target = world.players().addPlayer(20, 10, Teams::Terrorist);
+
+    world.scripts().start(ambush(world, gunner->handle(), target->handle(), { 10, 10 }));
+    for (int tick = 0; tick < 600 && world.scripts().count() > 0; tick++) world.update(1.0f / 30.0f);
+
+    REQUIRE(world.scripts().count() == 0);
+    REQUIRE(target->health() <= 0.0f);
+    REQUIRE(world.players()._kills.size() == 1);
+    REQUIRE(world.players()._kills[0].killer == gunner->handle());
+}
+
+static Script idle(World& world, unsigned int ticks)
+{
+    co_await world.scripts().ticks(ticks);
+}
+
+TEST_CASE("Script frames are reused from the pool of the world", "[scripts]" )
+{
+    World world;
+    for (int i = 0; i < 1000; i++) world.scripts().start(idle(world, 1 + i % 8));
+
+    auto& pool = world.scripts().pool();
+    REQUIRE(pool.liveFrames() == 1000);
+    int pages = pool.pageCount();
+    REQUIRE(pages > 0);
+
+    for (int tick = 0; tick < 10; tick++) world.update(0.05f);
+    REQUIRE(world.scripts().count() == 0);
+    REQUIRE(pool.liveFrames() == 0);
+
+    for (int i = 0; i < 1000; i++) world.scripts().start(idle(world, 1));
+    REQUIRE(pool.pageCount() == pages);
+}
+
+TEST_CASE("Changing the level stops the scripts", "[scripts]" )
+{
+    World world;
+    for (int i = 0; i < 10; i++) world.scripts().start(idle(world, 100));
+    {
+        Script unstarted = idle(world, 1);
+    }
+    world.update(0.05f);
+
+    world.changeLevel(openLevel(8, 8));
+    REQUIRE(world.scripts().count() == 0);
+    REQUIRE(world.scripts().pool().liveFrames() == 0);
+}
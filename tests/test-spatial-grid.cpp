@@ -0,0 +1,63 @@
+#include "catch.hpp"
+
+#include <spatial-grid.h>
+
+TEST_CASE("Spatial grid query matches a brute force search", "[spatial-grid]" )
+{
+    std::vector<float> x, y;
+    for (int i = 0; i < 500; i++)
+    {
+        x.push_back(float((i * 37) % 311));
+        y.push_back(float((i * 91) % 197));
+    }
+
+    SpatialGrid grid(16.0f);
+    grid.build(x, y);
+    REQUIRE(grid.size() == 500);
+
+    for (float radius : { 1.0f, 8.0f, 40.0f })
+    {
+        for (int q = 0; q < 20; q++)
+        {
+            float px = float(q * 17), py = float(q * 11);
+            std::vector<int> expected;
+            for (int i = 0; i < 500; i++)
+            {
+                float dx = x[i] - px, dy = y[i] - py;
+                if (dx * dx + dy * dy < radius * radius) expected.push_back(i);
+            }
+            REQUIRE(grid.query(x, y, px, py, radius) == expected);
+        }
+    }
+}
+
+TEST_CASE("Spatial grid only visits neighbouring cells", "[spatial-grid]" )
+{
+    std::vector<float> x = { 0.0f, 5.0f, 100.0f, 200.0f }, y = { 0.0f, 5.0f, 100.0f, 200.0f };
+
+    SpatialGrid grid(16.0f);
+    grid.build(x, y);
+
+    int visited = 0;
+    grid.visit(2.0f, 2.0f, 8.0f, [&] (int i) { visited++; return true; });
+    REQUIRE(visited == 2);
+
+    // Returning false stops the visit
+    visited = 0;
+    grid.visit(2.0f, 2.0f, 8.0f, [&] (int i) { visited++; return false; });
+    REQUIRE(visited == 1);
+}
+
+TEST_CASE("Spread out points grow the cells instead of the grid", "[spatial-grid]" )
+{
+    std::vector<float> x = { 0.0f, 1.0e7f }, y = { 0.0f, 1.0e7f };
+
+    SpatialGrid grid(1.0f);
+    grid.build(x, y);
+    REQUIRE(grid.cellCount() <= SPATIAL_GRID_MAX_CELLS);
+    REQUIRE(grid.query(x, y, 1.0e7f, 1.0e7f, 1.0f) == std::vector<int>({ 1 }));
+
+    grid.clear();
+    REQUIRE(grid.cellSize() == 1.0f);
+    REQUIRE(grid.query(x, y, 0.0f, 0.0f, 1.0f).empty());
+}
@@ -0,0 +1,153 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <visibility.h>
+
+#include <memory>
+
+TEST_CASE("Line of sight in an open level", "[visibility]" )
+{
+    auto open = [] (const tPosition& position) { return true; };
+    REQUIRE(obj_HasLineOfSight({ 0, 0 }, { 10, 3 }, open));
+    REQUIRE(obj_HasLineOfSight({ 10, 3 }, { 0, 0 }, open));
+    REQUIRE(obj_HasLineOfSight({ 5, 5 }, { 5, 5 }, open));
+}
+
+TEST_CASE("Line of sight is blocked by a wall", "[visibility]" )
+{
+    auto wall = [] (const tPosition& position) { return position.x != 5; };
+    REQUIRE_FALSE(obj_HasLineOfSight({ 0, 0 }, { 10, 3 }, wall));
+    REQUIRE_FALSE(obj_HasLineOfSight({ 10, 3 }, { 0, 0 }, wall));
+    REQUIRE(obj_HasLineOfSight({ 0, 0 }, { 4, 9 }, wall));
+}
+
+TEST_CASE("Line of sight passes a corner with one open side", "[visibility]" )
+{
+    auto corner = [] (const tPosition& position) { return !(position.x == 1 && position.y == 0); };
+    REQUIRE(obj_HasLineOfSight({ 0, 0 }, { 2, 2 }, corner));
+
+    auto closed = [] (const tPosition& position) {
+        return !(position.x == 1 && position.y == 0) && !(position.x == 0 && position.y == 1);
+    };
+    REQUIRE_FALSE(obj_HasLineOfSight({ 0, 0 }, { 2, 2 }, closed));
+}
+
+TEST_CASE("Regions on both sides of a wall are not potentially visible", "[visibility]" )
+{
+    PotentiallyVisibleSet pvs;
+    pvs.build(64, 64, [] (const tPosition& position) { return position.x != 32; });
+
+    REQUIRE(pvs.potentiallyVisible({ 1, 1 }, { 30, 60 }));
+    REQUIRE(pvs.potentiallyVisible({ 40, 1 }, { 60, 60 }));
+    REQUIRE_FALSE(pvs.potentiallyVisible({ 1, 1 }, { 60, 60 }));
+    REQUIRE_FALSE(pvs.potentiallyVisible({ 60, 60 }, { 1, 1 }));
+}
+
+TEST_CASE("Neighbouring regions are potentially visible", "[visibility]" )
+{
+    PotentiallyVisibleSet pvs;
+    pvs.build(64, 64, [] (const tPosition& position) { return position.x != 32; });
+
+    REQUIRE(pvs.potentiallyVisible({ 31, 1 }, { 33, 1 }));
+}
+
+TEST_CASE("An empty visible set does not reject anything", "[visibility]" )
+{
+    PotentiallyVisibleSet pvs;
+    REQUIRE(pvs.potentiallyVisible({ 1, 1 }, { 60, 60 }));
+}
+
+TEST_CASE("Updating the visible set after opening a wall", "[visibility]" )
+{
+    bool open = false;
+    auto isTransparent = [&open] (const tPosition& position) {
+        return position.x != 32 || (open && position.y > 20 && position.y < 28);
+    };
+
+    PotentiallyVisibleSet pvs;
+    pvs.build(64, 64, isTransparent);
+    REQUIRE_FALSE(pvs.potentiallyVisible({ 1, 24 }, { 60, 24 }));
+
+    open = true;
+    pvs.update(isTransparent, { 32, 21 }, { 32, 27 });
+    REQUIRE(pvs.potentiallyVisible({ 1, 24 }, { 60, 24 }));
+}
+
+TEST_CASE("Updating the visible set matches building it again", "[visibility]" )
+{
+    // Walls with gaps every few tiles, cut open and closed again in small rectangles all over the level
+    std::vector<char> walls(96 * 96, 0);
+    for (int y = 0; y < 96; y++)
+    {
+        for (int x = 0; x < 96; x++) walls[y * 96 + x] = (x % 20 == 10 && y % 30 > 3) || (y % 24 == 12 && x % 40 > 5);
+    }
+    auto isTransparent = [&walls] (const tPosition& position) { return walls[position.y * 96 + position.x] == 0; };
+
+    PotentiallyVisibleSet pvs;
+    pvs.build(96, 96, isTransparent);
+    unsigned int seed = 3;
+    for (int step = 0; step < 30; step++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int x = (seed >> 8) % 90, y = (seed >> 16) % 90, size = 1 + (seed >> 4) % 6;
+        for (int i = y; i < y + size; i++)
+        {
+            for (int j = x; j < x + size; j++) walls[i * 96 + j] = step % 2;
+        }
+        pvs.update(isTransparent, { x, y }, { x + size - 1, y + size - 1 });
+
+        PotentiallyVisibleSet expected;
+        expected.build(96, 96, isTransparent);
+        for (int a = 0; a < pvs.regionCount(); a++)
+        {
+            for (int b = 0; b < pvs.regionCount(); b++) REQUIRE(pvs.potentiallyVisible(a, b) == expected.potentiallyVisible(a, b));
+        }
+    }
+}
+
+// Compares the level with the plain ray from every tile of the area to every tile of the level
+template <class TIsTransparent>
+static void requireSameAsRays(const Level& level, TIsTransparent isTransparent, int fromX, int fromY, int fromWidth, int fromHeight)
+{
+    int missed = 0;
+    for (int ay = fromY; ay < fromY + fromHeight; ay++)
+    {
+        for (int ax = fromX; ax < fromX + fromWidth; ax++)
+        {
+            tPosition from = { ax, ay };
+            for (int by = 0; by < level.height; by++)
+            {
+                for (int bx = 0; bx < level.width; bx++)
+                {
+                    tPosition to = { bx, by };
+                    if (level.canSee(from, to) != obj_HasLineOfSight(from, to, isTransparent)) missed++;
+                }
+            }
+        }
+    }
+    REQUIRE(missed == 0);
+}
+
+TEST_CASE("The visible set keeps a line of sight through a gap in a wall", "[visibility]" )
+{
+    auto wall = [] (const tPosition& position) { return position.x != 24 || position.y == 1; };
+    std::unique_ptr<Level> level(makeLevel(64, 64, [&wall] (const tPosition& position) { return !wall(position); }, true));
+
+    REQUIRE(obj_HasLineOfSight({ 3, 5 }, { 32, 0 }, wall));
+    REQUIRE(level->canSee({ 3, 5 }, { 32, 0 }));
+    requireSameAsRays(*level, wall, 0, 0, 24, 64);
+}
+
+TEST_CASE("The visible set keeps every line of sight in walled levels", "[visibility]" )
+{
+    for (int seed = 0; seed < 3; seed++)
+    {
+        auto walls = [seed] (const tPosition& position) {
+            bool wall = (position.x % 12 == 5 + seed && (position.y + seed * 7) % 20 > 2) ||
+                    (position.y % 15 == 9 && position.x % 9 != seed) || (position.x * 7 + position.y * 13 + seed) % 23 == 0;
+            return !wall;
+        };
+        std::unique_ptr<Level> level(makeLevel(40, 40, [&walls] (const tPosition& position) { return !walls(position); }, true));
+        requireSameAsRays(*level, walls, 0, 0, 40, 40);
+    }
+}
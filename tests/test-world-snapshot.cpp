@@ -0,0 +1,78 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <world-snapshot.h>
+
+static void setUpMatch(World& world)
+{
+    world.changeLevel(openLevel(64, 64));
+    for (int i = 0; i < 32; i++)
+    {
+        auto player = world.players().addPlayer(2 + (i % 8) * 7, 2 + (i / 8) * 14, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+        world.players()._storage.setPath(player->slot(), { { 60 - (i % 8) * 7, 60 - (i / 8) * 14 }, { 32, 32 } });
+    }
+}
+
+TEST_CASE("Restoring a snapshot rolls the world back", "[snapshot]" )
+{
+    World world;
+    setUpMatch(world);
+    for (int i = 0; i < 20; i++) world.update(1.0f / 30.0f);
+
+    WorldSnapshot snapshot;
+    REQUIRE(snapshot.isEmpty());
+    snapshot.capture(world);
+    REQUIRE(snapshot.tick() == 20);
+    auto hash = world.stateHash();
+
+    // Try something that changes the outcome, then roll back and do something else
+    world.execute({ CommandTypes::SelectPlayer, 3, 0 });
+    for (int i = 0; i < 10; i++)
+    {
+        world.execute({ CommandTypes::Shoot, 0, 0 });
+        world.update(1.0f / 30.0f);
+    }
+    auto triedHash = world.stateHash();
+    REQUIRE(triedHash != hash);
+
+    REQUIRE(snapshot.restore(world));
+    REQUIRE(world.tick() == 20);
+    REQUIRE(world.stateHash() == hash);
+    REQUIRE(world.players()._selectedPlayer == nullptr);
+
+    world.execute({ CommandTypes::SelectPlayer, 3, 0 });
+    for (int i = 0; i < 10; i++)
+    {
+        world.execute({ CommandTypes::Shoot, 0, 0 });
+        world.update(1.0f / 30.0f);
+    }
+    REQUIRE(world.stateHash() == triedHash);
+}
+
+TEST_CASE("Snapshots keep their buffer and player views", "[snapshot]" )
+{
+    World world;
+    setUpMatch(world);
+
+    WorldSnapshot snapshot;
+    auto capacity = snapshot.capacity();
+    auto view = world.players()._players[5];
+    auto handle = view->handle();
+
+    for (int i = 0; i < 50; i++)
+    {
+        snapshot.capture(world);
+        world.update(1.0f / 30.0f);
+        REQUIRE(snapshot.restore(world));
+    }
+
+    REQUIRE(snapshot.capacity() == capacity);
+    REQUIRE(world.players()._players[5] == view);
+    REQUIRE(view->handle() == handle);
+
+    // Players removed after the snapshot come back, on the same view
+    world.players().removePlayer(view);
+    REQUIRE(world.players().player(handle) == nullptr);
+    REQUIRE(snapshot.restore(world));
+    REQUIRE(world.players().player(handle) == view);
+}
@@ -0,0 +1,127 @@
+#include "catch.hpp"
+#include "test-levels.h"
+
+#include <bots.h>
+#include <world.h>
+#include <world-scheduler.h>
+
+#include <thread>
+
+static void setUpMatch(World& world)
+{
+    world.changeLevel(openLevel(64, 64));
+    for (int i = 0; i < 8; i++)
+    {
+        auto player = world.players().addPlayer(4 + i * 6, 4 + i * 2, i % 2 == 0 ? Teams::CounterTerrorist : Teams::Terrorist);
+        world.players()._storage.setPath(player->slot(), { { 60 - i * 6, 60 - i * 3 }, { 30, 30 } });
+    }
+}
+
+TEST_CASE("Worlds do not share state", "[world]" )
+{
+    World a, b;
+    a.players().addPlayer(1, 1, Teams::CounterTerrorist);
+    REQUIRE(a.players()._storage.size() == 1);
+    REQUIRE(b.players()._storage.size() == 0);
+    REQUIRE(a.players().world() == &a);
+    REQUIRE(b.players().level() == b.level());
+
+    a.update(0.1f);
+    a.update(0.1f);
+    REQUIRE(a.tick() == 2);
+    REQUIRE(b.tick() == 0);
+}
+
+TEST_CASE("Posted jobs run right before the next tick", "[world]" )
+{
+    World world;
+    int ranAtTick = -1;
+    world.post([&ranAtTick] (World& w) {
+        ranAtTick = int(w.tick());
+        w.players().addPlayer(2, 2, Teams::Terrorist);
+    });
+    REQUIRE(world.players()._storage.size() == 0);
+
+    world.update(0.1f);
+    REQUIRE(ranAtTick == 0);
+    REQUIRE(world.players()._storage.size() == 1);
+
+    world.update(0.1f);
+    REQUIRE(ranAtTick == 0);
+}
+
+TEST_CASE("Scheduled worlds end up where serially updated worlds do", "[world]" )
+{
+    const int count = 16;
+    std::vector<World*> serial, parallel;
+    WorldScheduler scheduler(4);
+    REQUIRE(scheduler.threadCount() == 4);
+
+    for (int i = 0; i < count; i++)
+    {
+        serial.push_back(new World(i));
+        parallel.push_back(new World(i));
+        setUpMatch(*serial.back());
+        setUpMatch(*parallel.back());
+        scheduler.add(parallel.back());
+    }
+    scheduler.add(parallel.front());
+    REQUIRE(scheduler.worlds().size() == count);
+
+    for (int tick = 0; tick < 100; tick++)
+    {
+        for (auto world : serial) world->update(1.0f / 30.0f);
+        scheduler.update(1.0f / 30.0f);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        REQUIRE(parallel[i]->tick() == 100);
+        REQUIRE(parallel[i]->players()._storage._posX == serial[i]->players()._storage._posX);
+        REQUIRE(parallel[i]->players()._storage._posY == serial[i]->players()._storage._posY);
+        REQUIRE(parallel[i]->players()._storage._name == serial[i]->players()._storage._name);
+    }
+
+    scheduler.remove(parallel.front());
+    REQUIRE(scheduler.worlds().size() == count - 1);
+
+    for (auto world : serial) delete world;
+    for (auto world : parallel) delete world;
+}
+
+static std::vector<uint64_t> hashEveryTick(unsigned int seed, int ticks)
+{
+    World world(seed);
+    setUpMatch(world);
+    BotController bots(&world);
+
+    std::vector<uint64_t> hashes;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        bots.update(1.0f / 30.0f);
+        world.update(1.0f / 30.0f);
+        hashes.push_back(world.stateHash());
+    }
+
+    return hashes;
+}
+
+TEST_CASE("Worlds with the same seed do not diverge on different threads", "[world]" )
+{
+    std::vector<uint64_t> a, b, c;
+    std::thread first([&a] () { a = hashEveryTick(42, 600); });
+    std::thread second([&b] () { b = hashEveryTick(42, 600); });
+    std::thread third([&c] () { c = hashEveryTick(43, 600); });
+    first.join();
+    second.join();
+    third.join();
+
+    REQUIRE(a.size() == 600);
+    for (size_t tick = 0; tick < a.size(); tick++)
+    {
+        INFO("tick " << tick);
+        REQUIRE(a[tick] == b[tick]);
+    }
+
+    REQUIRE(a != c);
+}